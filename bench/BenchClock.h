@@ -0,0 +1,25 @@
+#ifndef _BENCH_CLOCK_H_
+#define _BENCH_CLOCK_H_
+
+#include <StandardDefines.h>
+#include <cstdint>
+
+#ifdef ARDUINO
+    #include <Arduino.h>
+#else
+    #include <chrono>
+#endif
+
+// Monotonic clock shared by the desktop and on-device benchmarks (micros() resolution on Arduino)
+class BenchClock {
+    Public Static uint64_t Nanos() {
+        #ifdef ARDUINO
+            return static_cast<uint64_t>(micros()) * 1000;
+        #else
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        #endif
+    }
+};
+
+#endif // _BENCH_CLOCK_H_
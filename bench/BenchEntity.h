@@ -0,0 +1,111 @@
+#ifndef _BENCH_ENTITY_H_
+#define _BENCH_ENTITY_H_
+
+#include <StandardDefines.h>
+#include "BenchClock.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+// Sample entity for the benchmarks, in the shape the pre-build scripts generate for an entity with
+// an /* @Id */ field. It carries no annotations, so the scripts leave it alone. Serialize() and
+// Deserialize() write a flat JSON object by hand, which keeps the benchmark independent of the
+// serialization library; the time spent decoding is summed up so benchmarks can report it
+// separately from storage I/O.
+class BenchUser {
+    Public optional<int> id;
+    Public optional<StdString> name;
+    Public optional<StdString> email;
+    Public optional<int> age;
+    Public optional<int> score;
+
+    // Sample entity with fields derived from the ID
+    Public Static BenchUser Make(int key) {
+        BenchUser user;
+        user.id = key;
+        user.name = "user" + std::to_string(key);
+        user.email = "user" + std::to_string(key) + "@example.com";
+        user.age = 18 + key % 60;
+        user.score = key * 7 % 1000;
+        return user;
+    }
+
+    Public StdString Serialize() const {
+        StdString json;
+        json.reserve(96);
+        json += "{\"id\":";
+        json += std::to_string(id.value_or(0));
+        json += ",\"name\":\"";
+        json += name.value_or("");
+        json += "\",\"email\":\"";
+        json += email.value_or("");
+        json += "\",\"age\":";
+        json += std::to_string(age.value_or(0));
+        json += ",\"score\":";
+        json += std::to_string(score.value_or(0));
+        json += "}";
+        return json;
+    }
+
+    Public Static BenchUser Deserialize(CStdString& json) {
+        uint64_t start = BenchClock::Nanos();
+        BenchUser user;
+        std::string_view view(json);
+        user.id = ParseInt(view, "\"id\":");
+        user.name = ParseString(view, "\"name\":\"");
+        user.email = ParseString(view, "\"email\":\"");
+        user.age = ParseInt(view, "\"age\":");
+        user.score = ParseInt(view, "\"score\":");
+        DecodeNanos() += BenchClock::Nanos() - start;
+        return user;
+    }
+
+    // Nanoseconds spent in Deserialize() since the last reset (desktop FindAll decodes on several threads)
+    Public Static std::atomic<uint64_t>& DecodeNanos() {
+        static std::atomic<uint64_t> nanos{0};
+        return nanos;
+    }
+
+    Private Static int ParseInt(std::string_view json, std::string_view key) {
+        size_t position = json.find(key);
+        if (position == std::string_view::npos) {
+            return 0;
+        }
+        return std::atoi(json.data() + position + key.length());
+    }
+
+    Private Static StdString ParseString(std::string_view json, std::string_view key) {
+        size_t position = json.find(key);
+        if (position == std::string_view::npos) {
+            return StdString();
+        }
+        size_t start = position + key.length();
+        size_t end = json.find('"', start);
+        return StdString(json.substr(start, end - start));
+    }
+
+    Public inline optional<int> GetPrimaryKey() const {
+        return id;
+    }
+
+    Public inline Static StdString GetPrimaryKeyName() {
+        return "id";
+    }
+
+    Public inline Static StdString GetTableName() {
+        return "BenchUser";
+    }
+
+    // Every record key is this prefix followed by the ID
+    Public inline Static constexpr std::string_view GetStorageKeyPrefix() {
+        return "BenchUser_id_";
+    }
+
+    Public inline Static constexpr std::string_view GetIdsFileKey() {
+        return "BenchUser_IDs";
+    }
+};
+
+#endif // _BENCH_ENTITY_H_
@@ -0,0 +1,115 @@
+#ifndef _TIMED_FILE_MANAGER_H_
+#define _TIMED_FILE_MANAGER_H_
+
+#include "IFileManager.h"
+#include "BenchClock.h"
+#include <atomic>
+#include <cstdint>
+
+// File manager decorator that sums the time spent in every call of the wrapped manager,
+// so benchmarks can report storage I/O apart from decoding and repository bookkeeping
+template<typename Inner>
+class TimedFileManager final : public IFileManager {
+    Private Inner inner;
+
+    // Nanoseconds spent in file manager calls since the last reset
+    Public Static std::atomic<uint64_t>& IoNanos() {
+        static std::atomic<uint64_t> nanos{0};
+        return nanos;
+    }
+
+    // Adds the duration of one file manager call to IoNanos()
+    Private class Timer {
+        Private uint64_t start = BenchClock::Nanos();
+
+        Public ~Timer() {
+            IoNanos() += BenchClock::Nanos() - start;
+        }
+    };
+
+    Public Bool Create(CStdString& filename, CStdString& contents) override {
+        Timer timer;
+        return inner.Create(filename, contents);
+    }
+
+    Public StdString Read(CStdString& filename) override {
+        Timer timer;
+        return inner.Read(filename);
+    }
+
+    Public Bool Read(CStdString& filename, StdString& contents) override {
+        Timer timer;
+        return inner.Read(filename, contents);
+    }
+
+    Public Bool Read(const char* filename, StdString& contents) override {
+        Timer timer;
+        return inner.Read(filename, contents);
+    }
+
+    Public Bool Update(CStdString& filename, CStdString& contents) override {
+        Timer timer;
+        return inner.Update(filename, contents);
+    }
+
+    Public Bool Delete(CStdString& filename) override {
+        Timer timer;
+        return inner.Delete(filename);
+    }
+
+    Public Bool Append(CStdString& filename, CStdString& contents) override {
+        Timer timer;
+        return inner.Append(filename, contents);
+    }
+
+    Public StdString ReadRange(CStdString& filename, size_t offset, size_t length) override {
+        Timer timer;
+        return inner.ReadRange(filename, offset, length);
+    }
+
+    Public Bool WriteRange(CStdString& filename, size_t offset, std::string_view contents) override {
+        Timer timer;
+        return inner.WriteRange(filename, offset, contents);
+    }
+
+    Public Bool Exists(CStdString& filename) override {
+        Timer timer;
+        return inner.Exists(filename);
+    }
+
+    Public size_t Size(CStdString& filename) override {
+        Timer timer;
+        return inner.Size(filename);
+    }
+
+    Public Bool Write(const char* filename, std::string_view contents) override {
+        Timer timer;
+        return inner.Write(filename, contents);
+    }
+
+    Public Bool Append(const char* filename, std::string_view contents) override {
+        Timer timer;
+        return inner.Append(filename, contents);
+    }
+
+    // Sessions reach the wrapped manager, so its batching (e.g. CPA_DURABILITY_BATCH) is measured too
+    Public Void BeginSession() override {
+        Timer timer;
+        inner.BeginSession();
+    }
+
+    Public Void EndSession() override {
+        Timer timer;
+        inner.EndSession();
+    }
+
+    Public FileManagerStats GetStats() override {
+        return inner.GetStats();
+    }
+
+    Public Void ResetStats() override {
+        inner.ResetStats();
+    }
+};
+
+#endif // _TIMED_FILE_MANAGER_H_
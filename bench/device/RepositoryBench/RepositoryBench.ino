@@ -0,0 +1,94 @@
+// On-device repository benchmark
+// Runs the desktop benchmark's cases against both storage engines on the board's file manager and
+// prints, per case, micros() per operation, ops/sec and the part of it spent in storage I/O and in
+// Entity::Deserialize. Tables are kept small (NVS holds a few hundred records at most).
+
+#include <Arduino.h>
+#include <StandardDefines.h>
+#include "IFileManager.h"
+#include "ArduinoFileManager.h"
+#include "repository/CpaRepositoryImpl.h"
+#include "repository/LogCpaRepositoryImpl.h"
+#include "BenchEntity.h"
+#include "TimedFileManager.h"
+
+#ifndef BENCH_DEVICE_MAX_ENTITIES
+#define BENCH_DEVICE_MAX_ENTITIES 100
+#endif
+
+#ifndef BENCH_DEVICE_ITERATIONS
+#define BENCH_DEVICE_ITERATIONS 50
+#endif
+
+using BenchFileManager = TimedFileManager<ArduinoFileManager>;
+
+// Runs operation(i) for every iteration and prints one result line
+template<typename Operation>
+Void Measure(const char* name, const char* engine, int size, int iterations, Operation operation) {
+    uint64_t ioStart = BenchFileManager::IoNanos();
+    uint64_t parseStart = BenchUser::DecodeNanos();
+    unsigned long start = micros();
+    for (int i = 0; i < iterations; i++) {
+        operation(i);
+    }
+    unsigned long elapsed = micros() - start;
+    uint64_t io = (BenchFileManager::IoNanos() - ioStart) / 1000;
+    uint64_t parse = (BenchUser::DecodeNanos() - parseStart) / 1000;
+
+    double perOp = static_cast<double>(elapsed) / iterations;
+    Serial.printf("%-14s %-5s %5d  %10.1f us/op  %9.1f ops/s  io %8.1f us/op  parse %8.1f us/op\n",
+        name, engine, size, perOp, perOp > 0 ? 1000000.0 / perOp : 0.0,
+        static_cast<double>(io) / iterations, static_cast<double>(parse) / iterations);
+}
+
+template<typename Repository>
+Void RunEngine(const char* engine, IFileManagerPtr fileManager) {
+    for (int size = 10; size <= BENCH_DEVICE_MAX_ENTITIES; size *= 10) {
+        Repository repository;
+        repository.fileManager = fileManager;
+
+        Vector<BenchUser> users;
+        Vector<int> ids;
+        for (int i = 0; i < size; i++) {
+            users.push_back(BenchUser::Make(i));
+            ids.push_back(i);
+        }
+        repository.DeleteAllById(ids);
+        repository.SaveAll(users);
+
+        int iterations = BENCH_DEVICE_ITERATIONS;
+        Measure("Save", engine, size, iterations, [&](int i) {
+            BenchUser user = BenchUser::Make(i * 7 % size);
+            repository.Save(user);
+        });
+        Measure("FindById", engine, size, iterations, [&](int i) {
+            repository.FindById(i * 7 % size);
+        });
+        Measure("FindAll", engine, size, 5, [&](int) {
+            repository.FindAll();
+        });
+        Measure("FindAllPage20", engine, size, 5, [&](int) {
+            repository.FindAll(static_cast<size_t>(size / 2), 20);
+        });
+        Measure("DeleteById", engine, size, std::min(iterations, size), [&](int i) {
+            repository.DeleteById(i);
+        });
+
+        repository.DeleteAllById(ids);
+    }
+}
+
+Void setup() {
+    Serial.begin(115200);
+    delay(2000);
+
+    IFileManagerPtr fileManager = std::make_shared<BenchFileManager>();
+    Serial.println("case           engine size");
+    RunEngine<CpaRepositoryImpl<BenchUser, int>>("file", fileManager);
+    RunEngine<LogCpaRepositoryImpl<BenchUser, int>>("log", fileManager);
+    Serial.println("done");
+}
+
+Void loop() {
+    delay(1000);
+}
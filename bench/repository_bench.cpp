@@ -0,0 +1,368 @@
+// Repository benchmarks (desktop, Google Benchmark)
+// Every case runs against both storage engines the generated repositories delegate to
+// (CpaRepositoryImpl and LogCpaRepositoryImpl) for table sizes from 10 to BENCH_MAX_ENTITIES.
+// Besides ops/sec (wall clock, I/O included) each case reports, per operation:
+//   io_ns     - time spent inside the file manager
+//   parse_ns  - time spent in Entity::Deserialize (summed over threads for parallel FindAll)
+//   allocs    - heap allocations
+//   bytes     - heap bytes allocated
+// Build with -DSPRINGBOOTPLUSPLUS_DATA_BUILD_BENCH=ON and run springbootplusplus-data_bench.
+
+#include "BenchEntity.h"
+#include "TimedFileManager.h"
+#include "DesktopFileManager.h"
+#include "repository/CpaRepositoryImpl.h"
+#include "repository/LogCpaRepositoryImpl.h"
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+
+#ifndef BENCH_MAX_ENTITIES
+#define BENCH_MAX_ENTITIES 100000
+#endif
+
+// ---- Heap allocation counting ----
+
+static std::atomic<uint64_t> allocationCount{0};
+static std::atomic<uint64_t> allocationBytes{0};
+
+// Every replaceable form of operator new/delete is routed here, so all of them are counted and each
+// delete frees memory its matching new allocated
+
+// Counted allocation, nullptr when the heap is exhausted
+static void* CountedAllocate(size_t size, size_t alignment) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+    if (size == 0) {
+        size = 1;
+    }
+    if (alignment <= alignof(std::max_align_t)) {
+        return std::malloc(size);
+    }
+    // aligned_alloc wants a size that is a multiple of the alignment
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+static void* CountedAllocateOrThrow(size_t size, size_t alignment) {
+    if (void* memory = CountedAllocate(size, alignment)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size) {
+    return CountedAllocateOrThrow(size, alignof(std::max_align_t));
+}
+
+void* operator new[](size_t size) {
+    return CountedAllocateOrThrow(size, alignof(std::max_align_t));
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    return CountedAllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return CountedAllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return CountedAllocate(size, alignof(std::max_align_t));
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return CountedAllocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return CountedAllocate(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return CountedAllocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+// Every benchmark stores through the desktop file manager, timed
+using BenchFileManager = TimedFileManager<DesktopFileManager>;
+
+// ---- Per-operation counters ----
+
+// Sums I/O time, parse time and allocations over the measured part of a benchmark
+// Pause()/Resume() wrap setup work inside the loop so it is left out of both the timing and the counters
+class Measurement {
+    Private benchmark::State& state;
+    Private uint64_t ioNanos = 0;
+    Private uint64_t parseNanos = 0;
+    Private uint64_t allocations = 0;
+    Private uint64_t bytes = 0;
+    Private uint64_t ioStart = 0;
+    Private uint64_t parseStart = 0;
+    Private uint64_t allocationsStart = 0;
+    Private uint64_t bytesStart = 0;
+
+    Public explicit Measurement(benchmark::State& benchmarkState) : state(benchmarkState) {
+        Snapshot();
+    }
+
+    Public Void Pause() {
+        Accumulate();
+        state.PauseTiming();
+    }
+
+    Public Void Resume() {
+        state.ResumeTiming();
+        Snapshot();
+    }
+
+    Public Void Report() {
+        Accumulate();
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+        state.counters["io_ns"] = benchmark::Counter(static_cast<double>(ioNanos), benchmark::Counter::kAvgIterations);
+        state.counters["parse_ns"] = benchmark::Counter(static_cast<double>(parseNanos), benchmark::Counter::kAvgIterations);
+        state.counters["allocs"] = benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+        state.counters["bytes"] = benchmark::Counter(static_cast<double>(bytes), benchmark::Counter::kAvgIterations);
+    }
+
+    Private Void Snapshot() {
+        ioStart = BenchFileManager::IoNanos();
+        parseStart = BenchUser::DecodeNanos();
+        allocationsStart = allocationCount;
+        bytesStart = allocationBytes;
+    }
+
+    Private Void Accumulate() {
+        ioNanos += BenchFileManager::IoNanos() - ioStart;
+        parseNanos += BenchUser::DecodeNanos() - parseStart;
+        allocations += allocationCount - allocationsStart;
+        bytes += allocationBytes - bytesStart;
+        Snapshot();
+    }
+};
+
+// ---- Tables ----
+
+// Table currently on disk ("engine/size"); both engines share DATABASE_PATH
+static StdString currentTable;
+
+// Repository of the engine under test, filled with IDs 0..size-1
+// Each (engine, size) pair is populated once; every case registered for it reuses the table
+template<typename Repository>
+Repository& PrepareTable(const char* engine, int size) {
+    static std::unique_ptr<Repository> repository;
+
+    StdString key = StdString(engine) + "/" + std::to_string(size);
+    if (repository && currentTable == key) {
+        return *repository;
+    }
+
+    repository.reset();
+    std::filesystem::remove_all(DATABASE_PATH);
+    std::filesystem::create_directories(DATABASE_PATH);
+    currentTable = key;
+
+    repository = std::make_unique<Repository>();
+    repository->fileManager = std::make_shared<BenchFileManager>();
+
+    Vector<BenchUser> users;
+    users.reserve(static_cast<size_t>(size));
+    for (int i = 0; i < size; i++) {
+        users.push_back(BenchUser::Make(i));
+    }
+    repository->SaveAll(users);
+    return *repository;
+}
+
+// ---- Repository cases ----
+
+template<typename Repository>
+Void BenchSave(benchmark::State& state, const char* engine) {
+    int size = static_cast<int>(state.range(0));
+    Repository& repository = PrepareTable<Repository>(engine, size);
+    std::mt19937 random(42);
+    Measurement measurement(state);
+    for (auto _ : state) {
+        BenchUser user = BenchUser::Make(static_cast<int>(random() % size));
+        benchmark::DoNotOptimize(repository.Save(user));
+    }
+    measurement.Report();
+}
+
+template<typename Repository>
+Void BenchFindById(benchmark::State& state, const char* engine) {
+    int size = static_cast<int>(state.range(0));
+    Repository& repository = PrepareTable<Repository>(engine, size);
+    std::mt19937 random(42);
+    Measurement measurement(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(repository.FindById(static_cast<int>(random() % size)));
+    }
+    measurement.Report();
+}
+
+template<typename Repository>
+Void BenchFindAll(benchmark::State& state, const char* engine) {
+    int size = static_cast<int>(state.range(0));
+    Repository& repository = PrepareTable<Repository>(engine, size);
+    Measurement measurement(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(repository.FindAll());
+    }
+    measurement.Report();
+}
+
+template<typename Repository>
+Void BenchFindAllPage(benchmark::State& state, const char* engine) {
+    int size = static_cast<int>(state.range(0));
+    Repository& repository = PrepareTable<Repository>(engine, size);
+    Measurement measurement(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(repository.FindAll(static_cast<size_t>(size / 2), 20));
+    }
+    measurement.Report();
+}
+
+template<typename Repository>
+Void BenchDeleteById(benchmark::State& state, const char* engine) {
+    int size = static_cast<int>(state.range(0));
+    Repository& repository = PrepareTable<Repository>(engine, size);
+    std::mt19937 random(42);
+    Measurement measurement(state);
+    for (auto _ : state) {
+        int id = static_cast<int>(random() % size);
+        repository.DeleteById(id);
+
+        // Put the row back so the table keeps its size
+        measurement.Pause();
+        BenchUser user = BenchUser::Make(id);
+        repository.Save(user);
+        measurement.Resume();
+    }
+    measurement.Report();
+}
+
+template<typename Repository>
+Void RegisterEngine(const char* engine) {
+    for (int size = 10; size <= BENCH_MAX_ENTITIES; size *= 10) {
+        StdString suffix = StdString("/") + engine;
+        benchmark::RegisterBenchmark(("Save" + suffix).c_str(), BenchSave<Repository>, engine)->Arg(size)->UseRealTime();
+        benchmark::RegisterBenchmark(("FindById" + suffix).c_str(), BenchFindById<Repository>, engine)->Arg(size)->UseRealTime();
+        benchmark::RegisterBenchmark(("FindAll" + suffix).c_str(), BenchFindAll<Repository>, engine)->Arg(size)->UseRealTime();
+        benchmark::RegisterBenchmark(("FindAllPage20" + suffix).c_str(), BenchFindAllPage<Repository>, engine)->Arg(size)->UseRealTime();
+        benchmark::RegisterBenchmark(("DeleteById" + suffix).c_str(), BenchDeleteById<Repository>, engine)->Arg(size)->UseRealTime();
+    }
+}
+
+// ---- File manager cases (raw storage cost per record size) ----
+
+Void BenchFileWrite(benchmark::State& state) {
+    std::filesystem::create_directories(DATABASE_PATH);
+    StdString path = StdString(DATABASE_PATH) + "bench_file";
+    StdString contents(static_cast<size_t>(state.range(0)), 'x');
+    BenchFileManager fileManager;
+    Measurement measurement(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fileManager.Write(path.c_str(), std::string_view(contents)));
+    }
+    measurement.Report();
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+Void BenchFileRead(benchmark::State& state) {
+    std::filesystem::create_directories(DATABASE_PATH);
+    StdString path = StdString(DATABASE_PATH) + "bench_file";
+    BenchFileManager fileManager;
+    fileManager.Write(path.c_str(), StdString(static_cast<size_t>(state.range(0)), 'x'));
+    StdString contents;
+    Measurement measurement(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fileManager.Read(path.c_str(), contents));
+    }
+    measurement.Report();
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+Void BenchFileAppend(benchmark::State& state) {
+    std::filesystem::create_directories(DATABASE_PATH);
+    StdString path = StdString(DATABASE_PATH) + "bench_append";
+    std::filesystem::remove(path.c_str());
+    StdString contents(static_cast<size_t>(state.range(0)), 'x');
+    BenchFileManager fileManager;
+    Measurement measurement(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fileManager.Append(path.c_str(), std::string_view(contents)));
+    }
+    measurement.Report();
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+int main(int argc, char** argv) {
+    benchmark::RegisterBenchmark("FileWrite", BenchFileWrite)->RangeMultiplier(8)->Range(64, 64 << 10)->UseRealTime();
+    benchmark::RegisterBenchmark("FileRead", BenchFileRead)->RangeMultiplier(8)->Range(64, 64 << 10)->UseRealTime();
+    benchmark::RegisterBenchmark("FileAppend", BenchFileAppend)->RangeMultiplier(8)->Range(64, 64 << 10)->UseRealTime();
+    RegisterEngine<CpaRepositoryImpl<BenchUser, int>>("file");
+    RegisterEngine<LogCpaRepositoryImpl<BenchUser, int>>("log");
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    std::filesystem::remove_all(DATABASE_PATH);
+    return 0;
+}
@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+"""
+Content-hash cache of the pre-build pipeline.
+
+The pre-build scans every header of the client project and its libraries on each build. Files whose
+contents haven't changed since they were last processed (and whose generated outputs are still in
+place) are skipped, so an incremental build only pays for the headers that were edited.
+
+Entries are keyed on (stage, file path), a stage being one pass of the pipeline ("repository",
+"serialization"). An entry holds the SHA-256 of the file as the pass left it (passes rewrite their
+annotations), its size and mtime for a quick check before hashing, and the SHA-256 of every output
+generated for it. The whole cache is dropped when any pipeline script changes.
+
+The cache file is SPRINGBOOTPLUSPLUS_DATA_CACHE_FILE when set (CMake points it into the build tree),
+otherwise .springbootplusplus-data_cache.json in the library directory.
+"""
+
+import hashlib
+import json
+import os
+from pathlib import Path
+from typing import Dict, Iterable, Optional
+
+
+CACHE_FILE_ENV = "SPRINGBOOTPLUSPLUS_DATA_CACHE_FILE"
+DEFAULT_CACHE_FILE_NAME = ".springbootplusplus-data_cache.json"
+CACHE_VERSION = 1
+
+
+def hash_file(file_path: str) -> Optional[str]:
+    """
+    SHA-256 of a file's contents.
+
+    Returns:
+        Hex digest, or None if the file can't be read
+    """
+    digest = hashlib.sha256()
+    try:
+        with open(file_path, 'rb') as f:
+            for block in iter(lambda: f.read(65536), b''):
+                digest.update(block)
+    except OSError:
+        return None
+    return digest.hexdigest()
+
+
+def scripts_fingerprint(scripts_dir: str) -> str:
+    """
+    Hash of every pipeline script, so a library update regenerates everything.
+
+    Args:
+        scripts_dir: Path to the springbootplusplus-data_scripts directory
+    """
+    digest = hashlib.sha256()
+    for script in sorted(Path(scripts_dir).rglob('*.py')):
+        digest.update(str(script.relative_to(scripts_dir)).encode('utf-8'))
+        digest.update((hash_file(str(script)) or '').encode('utf-8'))
+    return digest.hexdigest()
+
+
+def default_cache_path(library_dir: str) -> Path:
+    """Cache file location: $SPRINGBOOTPLUSPLUS_DATA_CACHE_FILE, or next to the generated outputs in the library."""
+    override = os.environ.get(CACHE_FILE_ENV)
+    if override:
+        return Path(override)
+    return Path(library_dir) / DEFAULT_CACHE_FILE_NAME
+
+
+class BuildCache:
+    """Per-file record of what the pre-build already processed (see module docstring)."""
+
+    def __init__(self, cache_path: Path, fingerprint: str):
+        self.cache_path = Path(cache_path)
+        self.fingerprint = fingerprint
+        self.entries: Dict[str, dict] = {}
+        self.dirty = False
+        self.load()
+
+    @classmethod
+    def for_library(cls, library_dir: str, scripts_dir: str) -> 'BuildCache':
+        """Open the cache of a library, invalidated by any change to its scripts."""
+        return cls(default_cache_path(library_dir), scripts_fingerprint(scripts_dir))
+
+    def load(self) -> None:
+        """Read the cache file; a missing, unreadable or outdated cache starts empty."""
+        try:
+            with open(self.cache_path, 'r', encoding='utf-8') as f:
+                data = json.load(f)
+        except (OSError, ValueError):
+            return
+        if data.get('version') != CACHE_VERSION or data.get('fingerprint') != self.fingerprint:
+            self.dirty = True
+            return
+        entries = data.get('entries')
+        if isinstance(entries, dict):
+            self.entries = entries
+
+    def save(self) -> None:
+        """Write the cache if anything changed (written to a temporary file and renamed into place)."""
+        if not self.dirty:
+            return
+        data = {'version': CACHE_VERSION, 'fingerprint': self.fingerprint, 'entries': self.entries}
+        temporary_path = self.cache_path.with_name(self.cache_path.name + '.tmp')
+        try:
+            self.cache_path.parent.mkdir(parents=True, exist_ok=True)
+            with open(temporary_path, 'w', encoding='utf-8') as f:
+                json.dump(data, f, indent=1, sort_keys=True)
+            os.replace(temporary_path, self.cache_path)
+            self.dirty = False
+        except OSError:
+            pass
+
+    @staticmethod
+    def key(stage: str, file_path: str) -> str:
+        return f"{stage}:{Path(file_path).resolve()}"
+
+    def is_unchanged(self, stage: str, file_path: str) -> bool:
+        """
+        Check if a file can be skipped by a stage.
+
+        True when the file has the contents recorded after it was last processed and every output
+        generated for it still exists unchanged. Size and mtime are compared first; the file is only
+        hashed when they differ (e.g. after a checkout that didn't change the contents).
+        """
+        entry = self.entries.get(self.key(stage, file_path))
+        if entry is None:
+            return False
+        try:
+            stat = os.stat(file_path)
+        except OSError:
+            return False
+        if stat.st_size != entry.get('size') or stat.st_mtime_ns != entry.get('mtime_ns'):
+            if stat.st_size != entry.get('size') or hash_file(file_path) != entry.get('sha256'):
+                return False
+            entry['mtime_ns'] = stat.st_mtime_ns
+            self.dirty = True
+        for output_path, output_hash in entry.get('outputs', {}).items():
+            if hash_file(output_path) != output_hash:
+                return False
+        return True
+
+    def recorded_outputs(self, stage: str, file_path: str) -> Iterable[str]:
+        """Outputs recorded for a file the last time a stage processed it."""
+        entry = self.entries.get(self.key(stage, file_path))
+        return list(entry.get('outputs', {}).keys()) if entry else []
+
+    def record(self, stage: str, file_path: str, outputs: Iterable[str] = ()) -> None:
+        """Record a file as processed by a stage, with the outputs generated for it (hashed as they are now)."""
+        try:
+            stat = os.stat(file_path)
+        except OSError:
+            self.forget(stage, file_path)
+            return
+        recorded_outputs = {}
+        for output_path in outputs:
+            output_hash = hash_file(str(output_path))
+            if output_hash is not None:
+                recorded_outputs[str(Path(output_path).resolve())] = output_hash
+        self.entries[self.key(stage, file_path)] = {
+            'size': stat.st_size,
+            'mtime_ns': stat.st_mtime_ns,
+            'sha256': hash_file(file_path),
+            'outputs': recorded_outputs,
+        }
+        self.dirty = True
+
+    def forget(self, stage: str, file_path: str) -> None:
+        """Drop the entry of a file, so the next build processes it again."""
+        if self.entries.pop(self.key(stage, file_path), None) is not None:
+            self.dirty = True
+
+
+# Export functions for other scripts to import
+__all__ = [
+    'BuildCache',
+    'hash_file',
+    'scripts_fingerprint',
+    'default_cache_path',
+    'CACHE_FILE_ENV',
+]
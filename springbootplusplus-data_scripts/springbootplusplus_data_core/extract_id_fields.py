@@ -144,6 +144,39 @@ def extract_id_fields(file_path: str, class_name: str, validation_macros: Dict[s
         class_name: Name of the class
         validation_macros: Optional dictionary of validation macros to recognize
         
+    Returns:
+        List of dictionaries with 'type', 'name', and optional 'validation_macros' keys
+        Example: [{'type': 'int', 'name': 'rollNo'}, {'type': 'StdString', 'name': 'name', 'validation_macros': ['NotNull']}]
+    """
+    return extract_annotated_fields(file_path, class_name, "Id", validation_macros)
+
+
+def extract_indexed_fields(file_path: str, class_name: str, validation_macros: Dict[str, str] = None) -> List[Dict[str, str]]:
+    """
+    Extract all fields marked with @Indexed annotation (secondary indexes kept by the repository).
+    
+    Args:
+        file_path: Path to the C++ file
+        class_name: Name of the class
+        validation_macros: Optional dictionary of validation macros to recognize
+        
+    Returns:
+        List of dictionaries with 'type', 'name', and optional 'validation_macros' keys
+    """
+    return extract_annotated_fields(file_path, class_name, "Indexed", validation_macros)
+
+
+def extract_annotated_fields(file_path: str, class_name: str, annotation: str,
+                             validation_macros: Dict[str, str] = None) -> List[Dict[str, str]]:
+    """
+    Extract all fields marked with the given field annotation (e.g. "Id" for /* @Id */).
+    
+    Args:
+        file_path: Path to the C++ file
+        class_name: Name of the class
+        annotation: Annotation name without the @ (e.g. "Id", "Indexed")
+        validation_macros: Optional dictionary of validation macros to recognize
+        
     Returns:
         List of dictionaries with 'type', 'name', and optional 'validation_macros' keys
         Example: [{'type': 'int', 'name': 'rollNo'}, {'type': 'StdString', 'name': 'name', 'validation_macros': ['NotNull']}]
@@ -213,8 +246,8 @@ def extract_id_fields(file_path: str, class_name: str, validation_macros: Dict[s
     
     # Pattern for /* @Id */ or /*@Id*/ annotation (ignoring whitespace)
     # Also check for already processed /*--@Id--*/ pattern
-    id_annotation_pattern = r'/\*\s*@Id\s*\*/'
-    id_processed_pattern = r'/\*--\s*@Id\s*--\*/'
+    id_annotation_pattern = rf'/\*\s*@{re.escape(annotation)}\s*\*/'
+    id_processed_pattern = rf'/\*--\s*@{re.escape(annotation)}\s*--\*/'
     
     # Pattern for field declaration
     # Matches: "int rollNo;", "StdString name;", "const long digit;", etc.
@@ -409,6 +442,8 @@ def main():
 __all__ = [
     'check_has_serializable_macro',
     'extract_id_fields',
+    'extract_indexed_fields',
+    'extract_annotated_fields',
     'extract_id_fields_from_file',
     'main'
 ]
@@ -81,7 +81,7 @@ def find_class_boundaries(file_path: str, class_name: str) -> Optional[tuple]:
 
 def generate_primary_key_methods(field_type: str, field_name: str, class_name: str) -> str:
     """
-    Generate GetPrimaryKey(), GetPrimaryKeyName(), and GetTableName() methods.
+    Generate GetPrimaryKey(), GetPrimaryKeyName(), GetTableName() and the constexpr storage key methods.
     
     Args:
         field_type: Type of the primary key field
@@ -94,7 +94,7 @@ def generate_primary_key_methods(field_type: str, field_name: str, class_name: s
     methods = []
     
     # GetPrimaryKey() method
-    methods.append(f"    inline {field_type} GetPrimaryKey() {{")
+    methods.append(f"    inline {field_type} GetPrimaryKey() const {{")
     methods.append(f"        return {field_name};")
     methods.append(f"    }}")
     methods.append("")
@@ -109,6 +109,18 @@ def generate_primary_key_methods(field_type: str, field_name: str, class_name: s
     methods.append(f"    inline Static StdString GetTableName() {{")
     methods.append(f'        return "{class_name}";')
     methods.append(f"    }}")
+    methods.append("")
+    
+    # Storage keys fixed at build time, so the repository doesn't rebuild them on every call
+    methods.append(f"    // Every record key is this prefix followed by the ID")
+    methods.append(f"    inline Static constexpr std::string_view GetStorageKeyPrefix() {{")
+    methods.append(f'        return "{class_name}_{field_name}_";')
+    methods.append(f"    }}")
+    methods.append("")
+    
+    methods.append(f"    inline Static constexpr std::string_view GetIdsFileKey() {{")
+    methods.append(f'        return "{class_name}_IDs";')
+    methods.append(f"    }}")
     
     return "\n".join(methods)
 
@@ -92,6 +92,80 @@ def is_class_templated(content: str, class_name: str) -> bool:
     return bool(re.search(pattern, content_no_comments))
 
 
+def detect_storage_engine(file_path: str) -> str:
+    """
+    Determine which storage engine base class the repository implementation should use.
+    
+    /// @LogStructured (or the processed /* @LogStructured */ form) selects the append-only
+    log-structured engine; everything else uses the default file-per-entity engine.
+    
+    Returns: "LogCpaRepositoryImpl" or "CpaRepositoryImpl"
+    """
+    try:
+        with open(file_path, 'r', encoding='utf-8') as f:
+            content = f.read()
+    except Exception as e:
+        return "CpaRepositoryImpl"
+    
+    if re.search(r'(///\s*@LogStructured\b|/\*\s*@LogStructured\s*\*/)', content):
+        return "LogCpaRepositoryImpl"
+    return "CpaRepositoryImpl"
+
+
+# Entity cache capacity used when /// @Cacheable is given without one
+DEFAULT_CACHE_CAPACITY = 16
+
+
+def detect_cache_capacity(file_path: str) -> Optional[int]:
+    """
+    Determine the entity cache capacity requested for a repository.
+    
+    /// @Cacheable(capacity) (or the processed /* @Cacheable(capacity) */ form) enables the LRU
+    entity cache with that many entries; a bare /// @Cacheable uses DEFAULT_CACHE_CAPACITY.
+    
+    Returns: The capacity, or None if the repository keeps the CPA_REPOSITORY_CACHE_CAPACITY default
+    """
+    try:
+        with open(file_path, 'r', encoding='utf-8') as f:
+            content = f.read()
+    except Exception as e:
+        return None
+    
+    match = re.search(r'(?:///|/\*)\s*@Cacheable\b(?:\s*\(\s*(\d+)\s*\))?', content)
+    if not match:
+        return None
+    if match.group(1) is None:
+        return DEFAULT_CACHE_CAPACITY
+    return int(match.group(1))
+
+
+# Write-behind queue depth used when /// @WriteBehind is given without one
+DEFAULT_WRITE_BEHIND_DEPTH = 32
+
+
+def detect_write_behind_depth(file_path: str) -> Optional[int]:
+    """
+    Determine the write-behind queue depth requested for a repository.
+    
+    /// @WriteBehind(depth) (or the processed /* @WriteBehind(depth) */ form) queues writes and flushes
+    them in the background with at most depth pending; a bare /// @WriteBehind uses DEFAULT_WRITE_BEHIND_DEPTH.
+    
+    Returns: The depth, or None if the repository writes synchronously
+    """
+    try:
+        with open(file_path, 'r', encoding='utf-8') as f:
+            content = f.read()
+    except Exception as e:
+        return None
+    
+    match = re.search(r'(?:///|/\*)\s*@WriteBehind\b(?:\s*\(\s*(\d+)\s*\))?', content)
+    if not match:
+        return None
+    if match.group(1) is None:
+        return DEFAULT_WRITE_BEHIND_DEPTH
+    return int(match.group(1))
+
+
 def detect_repository(file_path: str) -> Optional[Tuple[str, str, str, bool]]:
     """
     Detect @Repository annotation and extract class information.
@@ -90,6 +90,47 @@ def extract_entity_type(repository_file: str) -> Optional[str]:
         return entity_type
 
 
+def extract_id_type(repository_file: str) -> Optional[str]:
+    """
+    Extract ID type from a repository file (second CpaRepository<Entity, ID> template parameter).
+    
+    Args:
+        repository_file: Path to the repository file
+        
+    Returns:
+        ID type name (e.g., "int", "StdString", or "ID" for templated repositories), or None if not found
+    """
+    try:
+        with open(repository_file, 'r', encoding='utf-8') as f:
+            content = f.read()
+    except Exception as e:
+        print(f"Error reading file {repository_file}: {e}", file=sys.stderr)
+        return None
+    
+    content_no_comments = remove_comments(content)
+    
+    class_name_match = re.search(r'DefineStandardPointers\s*\(\s*(\w+)\s*\)', content_no_comments)
+    if not class_name_match:
+        return None
+    
+    class_name = class_name_match.group(1)
+    
+    is_templated = bool(re.search(rf'template\s*<\s*[^>]+\s*>\s*class\s+{re.escape(class_name)}', content_no_comments))
+    
+    pattern = rf'class\s+{re.escape(class_name)}\s+(?:final\s+)?:\s*public\s+(?:virtual\s+)?CpaRepository\s*<\s*([^,<>]+)\s*,\s*([^,<>]+)\s*>'
+    
+    match = re.search(pattern, content_no_comments)
+    if not match:
+        return None
+    
+    id_type = match.group(2).strip()
+    
+    # Generated implementations of templated repositories always name the parameter ID
+    if is_templated and id_type in ['ID', 'K', 'Key']:
+        return "ID"
+    return id_type
+
+
 def main():
     """Main function to handle command line arguments."""
     if len(sys.argv) < 2:
@@ -110,6 +151,7 @@ def main():
 # Export function for other scripts to import
 __all__ = [
     'extract_entity_type',
+    'extract_id_type',
     'main'
 ]
 
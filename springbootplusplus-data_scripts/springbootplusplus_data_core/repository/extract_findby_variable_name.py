@@ -1,6 +1,6 @@
 #!/usr/bin/env python3
 """
-Script to extract variable name from a FindBy method name or method declaration.
+Script to extract variable name from a FindBy/CountBy/ExistsBy/DeleteBy method name or method declaration.
 
 This script takes either:
 1. A method name like "FindByLastName" 
@@ -16,6 +16,10 @@ Examples:
     FindByName -> name
     FindByAddress -> address
     FindByFirstName -> firstName
+    CountByStatus -> status
+    ExistsByEmail -> email
+    DeleteByOwnerId -> ownerId
+    FindTop10ByStatus -> status
 
 Usage:
     python extract_findby_variable_name.py <method_name_or_declaration>
@@ -108,15 +112,15 @@ def extract_findby_variable_name(method_input: str) -> Optional[str]:
     if not method_name:
         method_name = method_input.strip()
     
-    # Pattern to match FindBy methods (case-insensitive)
-    # Matches: FindBy, FindByLastName, FindByName, etc.
-    pattern = r'^FindBy(.+)$'
+    # Pattern to match FindBy/CountBy/ExistsBy/DeleteBy methods (case-insensitive)
+    # Matches: FindByLastName, FindByName, CountByStatus, DeleteByOwnerId, FindTop10ByStatus, FindFirstByEmail, etc.
+    pattern = r'^(?:Find(?:(?:First|Top)\d*)?|Count|Exists|Delete)By(.+)$'
     match = re.match(pattern, method_name, re.IGNORECASE)
     
     if not match:
         return None
     
-    # Extract the part after "FindBy"
+    # Extract the part after "FindBy" (or the other action prefixes)
     pascal_case_part = match.group(1)
     
     # Convert to camelCase
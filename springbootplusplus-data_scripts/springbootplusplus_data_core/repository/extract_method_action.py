@@ -13,8 +13,13 @@ The action list follows JpaRepository conventions:
 - Exists (ExistsBy, ExistsById)
 - Count (CountBy, CountAll)
 
+Limited finds (FindFirstBy, FindTopBy, FindTop<N>By, FindFirst<N>By) are Find actions as well;
+extract_method_limit() returns how many entities they return.
+
 Examples:
     FindByFirstName -> Find
+    FindTop10ByStatus -> Find (limit 10)
+    FindFirstByEmail -> Find (limit 1)
     DeleteByLastName -> Delete
     ExistsById -> Exists
     CountByStatus -> Count
@@ -43,6 +48,9 @@ STANDARD_ACTIONS = [
     'Count',
 ]
 
+# FindFirstBy / FindTopBy / FindTop10By / FindFirst3By ...
+LIMITED_FIND_PATTERN = r'^Find(?:First|Top)(\d*)By'
+
 
 def extract_method_action(method_name: str) -> Optional[str]:
     """
@@ -68,6 +76,10 @@ def extract_method_action(method_name: str) -> Optional[str]:
         if action in STANDARD_ACTIONS:
             return action
     
+    # Limited finds (FindTop10ByStatus, FindFirstByEmail)
+    if re.match(LIMITED_FIND_PATTERN, method_name):
+        return 'Find'
+    
     # Check for methods without "By" (e.g., Save, Update, FindAll, DeleteAll, CountAll)
     # These are standalone action methods
     for action in STANDARD_ACTIONS:
@@ -86,6 +98,27 @@ def extract_method_action(method_name: str) -> Optional[str]:
     return None
 
 
+def extract_method_limit(method_name: str) -> Optional[int]:
+    """
+    Extract the result limit of a FindFirstBy/FindTopBy method name.
+    
+    Args:
+        method_name: Method name like "FindTop10ByStatus" or "FindFirstByEmail"
+        
+    Returns:
+        The maximum number of entities the method returns (1 without a number), or None if unlimited
+    """
+    if not method_name:
+        return None
+    
+    match = re.match(LIMITED_FIND_PATTERN, method_name)
+    if not match:
+        return None
+    
+    limit = match.group(1)
+    return int(limit) if limit else 1
+
+
 def main():
     """Main function to handle command line arguments."""
     if len(sys.argv) < 2:
@@ -106,6 +139,7 @@ def main():
 # Export function for other scripts to import
 __all__ = [
     'extract_method_action',
+    'extract_method_limit',
     'STANDARD_ACTIONS',
     'main'
 ]
@@ -7,6 +7,16 @@ as input and generates the implementation code.
 
 Currently supports:
 - Find action: generates code that finds entity by field value
+  (FindTop<N>By/FindFirstBy methods stop after N matches)
+- Count action: counts the entities whose field equals the value
+- Exists action: checks whether any entity has the field value (stops at the first match)
+- Delete action: deletes the entities whose field equals the value (one batch delete)
+
+All actions stream entities with ForEachMatching, so the table is never loaded as a whole:
+an /* @Indexed */ field is answered from its secondary index, any other field with a scan that
+tests the predicate on a projection (only the field and the primary key are parsed, see
+DeserializeFields). Find decodes matching entities in full; Count, Exists and Delete only need
+the projection.
 
 Examples:
     Action: Find
@@ -16,13 +26,14 @@ Examples:
     
     Generates:
         Public Virtual optional<Entity> FindByLastName(CStdString& someVariableName) override {
-            vector<Entity> entities = FindAll();
-            for (const auto& entity : entities) {
-                if (entity.lastName == someVariableName) {
-                    return entity;
-                }
-            }
-            return std::nullopt;
+            optional<Entity> found = std::nullopt;
+            this->ForEachMatching("lastName", IndexKeyOf(someVariableName), [&](const Entity& entity) {
+                return entity.lastName == someVariableName;
+            }, [&](const Entity& entity) {
+                found = entity;
+                return false;
+            });
+            return found;
         }
 
 Usage:
@@ -36,6 +47,8 @@ import re
 import sys
 from typing import Optional, Tuple
 
+from extract_method_action import extract_method_limit
+
 
 def parse_function_signature(signature: str) -> Tuple[Optional[str], Optional[str], Optional[str], Optional[str]]:
     """
@@ -94,7 +107,7 @@ def parse_function_signature(signature: str) -> Tuple[Optional[str], Optional[st
 
 def generate_find_implementation(access_modifier: str, return_type: str, method_name: str, 
                                  parameter_declaration: str, variable_name: str, parameter_name: str, 
-                                 entity_type: str = "Entity") -> str:
+                                 entity_type: str = "Entity", limit: Optional[int] = None) -> str:
     """
     Generate implementation code for Find action.
     
@@ -105,6 +118,7 @@ def generate_find_implementation(access_modifier: str, return_type: str, method_
         parameter_declaration: Parameter declaration like "CStdString& lastName"
         variable_name: Variable name in camelCase like "lastName"
         parameter_name: Parameter name like "someVariableName"
+        limit: Maximum number of matches a vector result holds (FindTop10By...), None for all
         
     Returns:
         Generated C++ method implementation code
@@ -117,55 +131,151 @@ def generate_find_implementation(access_modifier: str, return_type: str, method_
     method_signature = f"    {access_modifier} {return_type} {method_name}({parameter_declaration}) override {{"
     
     # Generate implementation based on return type
+    # Entities are streamed with ForEachMatching (index lookup or projected scan); single results stop early
+    matches = f"""this->ForEachMatching("{variable_name}", IndexKeyOf({parameter_name}), [&](const {entity_type}& entity) {{
+            return entity.{variable_name} == {parameter_name};
+        }}, [&](const {entity_type}& entity) {{"""
+    
     if is_optional:
         # Return optional<EntityType> - find first match
         code = f"""{method_signature}
-        vector<{entity_type}> entities = FindAll();
-        for (const auto& entity : entities) {{
-            if (entity.{variable_name} == {parameter_name}) {{
-                return entity;
-            }}
-        }}
-        return std::nullopt;
+        optional<{entity_type}> found = std::nullopt;
+        {matches}
+            found = entity;
+            return false;
+        }});
+        return found;
+    }}"""
+    elif is_vector and limit is not None:
+        # Return vector<EntityType> - the first limit matches, the scan stops once they are found
+        code = f"""{method_signature}
+        vector<{entity_type}> result;
+        {matches}
+            result.push_back(entity);
+            return result.size() < {limit};
+        }});
+        return result;
     }}"""
     elif is_vector:
         # Return vector<EntityType> - find all matches
         code = f"""{method_signature}
-        vector<{entity_type}> entities = FindAll();
         vector<{entity_type}> result;
-        for (const auto& entity : entities) {{
-            if (entity.{variable_name} == {parameter_name}) {{
-                result.push_back(entity);
-            }}
-        }}
+        {matches}
+            result.push_back(entity);
+            return true;
+        }});
         return result;
     }}"""
     else:
         # Return single EntityType - find first match (may need to handle not found case)
         code = f"""{method_signature}
-        vector<{entity_type}> entities = FindAll();
-        for (const auto& entity : entities) {{
-            if (entity.{variable_name} == {parameter_name}) {{
-                return entity;
-            }}
-        }}
         // TODO: Handle case when entity not found
-        return {entity_type}();
+        {entity_type} found = {entity_type}();
+        {matches}
+            found = entity;
+            return false;
+        }});
+        return found;
     }}"""
     
     return code
 
 
+def generate_count_implementation(access_modifier: str, return_type: str, method_name: str, 
+                                  parameter_declaration: str, variable_name: str, parameter_name: str, 
+                                  entity_type: str = "Entity") -> str:
+    """
+    Generate implementation code for Count action.
+    
+    Returns:
+        Generated C++ method implementation code (the count uses the declared return type, e.g. Int or size_t)
+    """
+    method_signature = f"    {access_modifier} {return_type} {method_name}({parameter_declaration}) override {{"
+    
+    return f"""{method_signature}
+        {return_type} count = 0;
+        this->ForEachMatching("{variable_name}", IndexKeyOf({parameter_name}), [&](const {entity_type}& entity) {{
+            return entity.{variable_name} == {parameter_name};
+        }}, [&](const {entity_type}&) {{
+            count++;
+            return true;
+        }}, false);
+        return count;
+    }}"""
+
+
+def generate_exists_implementation(access_modifier: str, return_type: str, method_name: str, 
+                                   parameter_declaration: str, variable_name: str, parameter_name: str, 
+                                   entity_type: str = "Entity") -> str:
+    """
+    Generate implementation code for Exists action.
+    
+    Returns:
+        Generated C++ method implementation code that stops at the first match
+    """
+    method_signature = f"    {access_modifier} {return_type} {method_name}({parameter_declaration}) override {{"
+    
+    return f"""{method_signature}
+        Bool exists = false;
+        this->ForEachMatching("{variable_name}", IndexKeyOf({parameter_name}), [&](const {entity_type}& entity) {{
+            return entity.{variable_name} == {parameter_name};
+        }}, [&](const {entity_type}&) {{
+            exists = true;
+            return false;
+        }}, false);
+        return exists;
+    }}"""
+
+
+def generate_delete_implementation(access_modifier: str, return_type: str, method_name: str, 
+                                   parameter_declaration: str, variable_name: str, parameter_name: str, 
+                                   entity_type: str = "Entity", id_type: str = "ID") -> str:
+    """
+    Generate implementation code for Delete action.
+    
+    Only the primary keys of matching entities are collected during the scan (deleting while
+    it runs would change the storage under it), then they are removed with one DeleteAllById.
+    The projection carries the primary key, so no entity is decoded in full.
+    
+    Returns:
+        Generated C++ method implementation code; a non-void return type receives the number of deleted entities
+    """
+    method_signature = f"    {access_modifier} {return_type} {method_name}({parameter_declaration}) override {{"
+    returns_count = return_type.strip() not in ('Void', 'void')
+    
+    code = f"""{method_signature}
+        vector<{id_type}> matchingIds;
+        this->ForEachMatching("{variable_name}", IndexKeyOf({parameter_name}), [&](const {entity_type}& entity) {{
+            return entity.{variable_name} == {parameter_name};
+        }}, [&](const {entity_type}& entity) {{
+            optional<{id_type}> primaryKey = this->PrimaryKeyOf(entity);
+            if (primaryKey.has_value()) {{
+                matchingIds.push_back(primaryKey.value());
+            }}
+            return true;
+        }}, false);
+        DeleteAllById(matchingIds);"""
+    if returns_count:
+        code += f"""
+        return static_cast<{return_type}>(matchingIds.size());"""
+    code += """
+    }"""
+    return code
+
+
 def generate_method_implementation(action: str, variable_name: str, parameter_name: str, 
-                                  function_signature: str, entity_type: str = "Entity") -> Optional[str]:
+                                  function_signature: str, entity_type: str = "Entity",
+                                  id_type: str = "ID") -> Optional[str]:
     """
     Generate C++ method implementation code.
     
     Args:
-        action: Action like "Find", "Delete", etc. (currently only "Find" is supported)
+        action: Action like "Find", "Count", "Exists" or "Delete"
         variable_name: Variable name in camelCase like "lastName"
         parameter_name: Parameter name like "someVariableName"
         function_signature: Full function signature like "Public Virtual optional<Entity> FindByLastName(CStdString& lastName) override {"
+        entity_type: Entity type ("Entity" for templated repositories)
+        id_type: ID type ("ID" for templated repositories), used by the Delete action
         
     Returns:
         Generated C++ method implementation code, or None if action is not supported
@@ -190,7 +300,20 @@ def generate_method_implementation(action: str, variable_name: str, parameter_na
     if action.lower() == "find":
         return generate_find_implementation(access_modifier or "Public Virtual", return_type, 
                                            method_name, parameter_declaration or "", 
-                                           variable_name, parameter_name, entity_type)
+                                           variable_name, parameter_name, entity_type,
+                                           extract_method_limit(method_name))
+    elif action.lower() == "count":
+        return generate_count_implementation(access_modifier or "Public Virtual", return_type, 
+                                            method_name, parameter_declaration or "", 
+                                            variable_name, parameter_name, entity_type)
+    elif action.lower() == "exists":
+        return generate_exists_implementation(access_modifier or "Public Virtual", return_type, 
+                                             method_name, parameter_declaration or "", 
+                                             variable_name, parameter_name, entity_type)
+    elif action.lower() == "delete":
+        return generate_delete_implementation(access_modifier or "Public Virtual", return_type, 
+                                             method_name, parameter_declaration or "", 
+                                             variable_name, parameter_name, entity_type, id_type)
     else:
         # Other actions not yet implemented
         return None
@@ -226,6 +349,9 @@ def main():
 __all__ = [
     'generate_method_implementation',
     'generate_find_implementation',
+    'generate_count_implementation',
+    'generate_exists_implementation',
+    'generate_delete_implementation',
     'parse_function_signature',
     'main'
 ]
@@ -33,7 +33,7 @@ from extract_repository_methods import extract_repository_methods
 from extract_findby_variable_name import extract_findby_variable_name
 from extract_method_action import extract_method_action
 from extract_parameter_name import extract_parameter_name
-from extract_entity_type import extract_entity_type
+from extract_entity_type import extract_entity_type, extract_id_type
 from generate_method_implementation import generate_method_implementation
 
 
@@ -140,6 +140,10 @@ def generate_repository_implementation(repository_file: str) -> Optional[str]:
         # Default to Entity if extraction fails
         entity_type = "Entity"
     
+    id_type = extract_id_type(repository_file)
+    if not id_type:
+        id_type = "ID"
+    
     # Extract all methods from repository
     method_names = extract_repository_methods(repository_file)
     if not method_names:
@@ -162,7 +166,8 @@ def generate_repository_implementation(repository_file: str) -> Optional[str]:
             variable_name, 
             parameter_name, 
             method_declaration,
-            entity_type
+            entity_type,
+            id_type
         )
         
         if code:
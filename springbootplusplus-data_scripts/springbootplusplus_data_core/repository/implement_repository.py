@@ -7,6 +7,7 @@ If it exists, creates a <class-name>Impl.h file in src/repository folder.
 """
 
 import os
+import re
 import sys
 from pathlib import Path
 from typing import Optional, Tuple
@@ -16,11 +17,109 @@ script_dir = os.path.dirname(os.path.abspath(__file__))
 parent_scripts_dir = os.path.dirname(os.path.dirname(script_dir))
 sys.path.insert(0, str(script_dir))
 
-from detect_repository import detect_repository
+from detect_repository import detect_repository, detect_storage_engine, detect_cache_capacity, detect_write_behind_depth
 from generate_repository_implementation import generate_repository_implementation
 
 
-def generate_impl_class(class_name: str, entity_type: str, id_type: str, source_file_path: str, is_templated: bool = True) -> str:
+# CpaRepository methods every implementation overrides by delegating to the storage engine base class.
+# The repository interface and the engine both derive from CpaRepository, so each of these must be
+# overridden in the generated class or it stays abstract. Keep this list in step with CpaRepository.h.
+# Each entry: (return type, method name, parameter declaration, call arguments)
+BASE_METHODS = [
+    ("Entity", "Save", "Entity& entity", "entity"),
+    ("optional<Entity>", "FindById", "ID id", "id"),
+    ("vector<Entity>", "FindAll", "", ""),
+    ("vector<Entity>", "FindAll", "size_t offset, size_t limit", "offset, limit"),
+    ("vector<Entity>", "FindAll", "size_t offset, size_t limit, std::function<Bool(const Entity&, const Entity&)> less", "offset, limit, less"),
+    ("Void", "ForEach", "std::function<Bool(const Entity&)> visitor", "visitor"),
+    ("Entity", "Update", "Entity& entity", "entity"),
+    ("Void", "DeleteById", "ID id", "id"),
+    ("Void", "Delete", "Entity& entity", "entity"),
+    ("Bool", "ExistsById", "ID id", "id"),
+    ("vector<Entity>", "SaveAll", "vector<Entity>& entities", "entities"),
+    ("vector<Entity>", "FindAllById", "const vector<ID>& ids", "ids"),
+    ("Void", "DeleteAllById", "const vector<ID>& ids", "ids"),
+    ("Void", "SetCacheCapacity", "size_t capacity", "capacity"),
+    ("CacheStats", "GetCacheStats", "", ""),
+    ("Void", "Preload", "size_t maxEntities", "maxEntities"),
+    ("Void", "PreloadAsync", "size_t maxEntities", "maxEntities"),
+    ("Bool", "SavePreloadSet", "", ""),
+    ("Void", "SetWriteBehind", "size_t maxQueueDepth", "maxQueueDepth"),
+    ("Bool", "Flush", "", ""),
+    ("Void", "Begin", "", ""),
+    ("Bool", "Commit", "", ""),
+    ("Void", "Rollback", "", ""),
+    ("size_t", "GetKeyCollisions", "", ""),
+    ("size_t", "GetWriteFailures", "", ""),
+    ("RepositoryStats", "GetStats", "", ""),
+    ("Void", "ResetStats", "", ""),
+]
+
+
+def generate_base_method_implementations(storage_base: str, entity_type: str, id_type: str) -> str:
+    """
+    Generate the delegating overrides for all CpaRepository methods.
+    
+    Args:
+        storage_base: Storage engine base class (CpaRepositoryImpl or LogCpaRepositoryImpl)
+        entity_type: Entity type ("Entity" for templated repositories, or a concrete type)
+        id_type: ID type ("ID" for templated repositories, or a concrete type)
+        
+    Returns:
+        String containing the method implementations
+    """
+    def substitute(text: str) -> str:
+        text = re.sub(r'\bEntity\b', entity_type, text)
+        return re.sub(r'\bID\b', id_type, text)
+    
+    implementations = []
+    for return_type, method_name, parameters, arguments in BASE_METHODS:
+        call = f"{storage_base}<{entity_type}, {id_type}>::{method_name}({arguments});"
+        if return_type != "Void":
+            call = f"return {call}"
+        implementations.append(f"""    Public Virtual {substitute(return_type)} {method_name}({substitute(parameters)}) override {{
+        {call}
+    }}""")
+    return "\n\n".join(implementations)
+
+
+def generate_constructor(impl_class_name: str, storage_base: str, entity_type: str, id_type: str,
+                         cache_capacity: Optional[int], write_behind_depth: Optional[int] = None) -> str:
+    """
+    Generate the constructor applying per-repository settings (empty if there are none).
+    
+    Args:
+        impl_class_name: Name of the implementation class
+        storage_base: Storage engine base class (CpaRepositoryImpl or LogCpaRepositoryImpl)
+        entity_type: Entity type ("Entity" for templated repositories, or a concrete type)
+        id_type: ID type ("ID" for templated repositories, or a concrete type)
+        cache_capacity: Entity cache capacity from /// @Cacheable, or None
+        write_behind_depth: Maximum write-behind queue depth from /// @WriteBehind, or None
+        
+    Returns:
+        String containing the constructor
+    """
+    settings = []
+    if cache_capacity is not None:
+        settings.append(("SetCacheCapacity", cache_capacity))
+    if write_behind_depth is not None:
+        settings.append(("SetWriteBehind", write_behind_depth))
+    if not settings:
+        return ""
+    
+    statements = "\n".join(f"        {storage_base}<{entity_type}, {id_type}>::{method}({value});"
+                           for method, value in settings)
+    return f"""
+    Public {impl_class_name}() {{
+{statements}
+    }}
+
+"""
+
+
+def generate_impl_class(class_name: str, entity_type: str, id_type: str, source_file_path: str, is_templated: bool = True,
+                        storage_base: str = "CpaRepositoryImpl", cache_capacity: Optional[int] = None,
+                        write_behind_depth: Optional[int] = None) -> str:
     """
     Generate the implementation class code.
     
@@ -30,6 +129,9 @@ def generate_impl_class(class_name: str, entity_type: str, id_type: str, source_
         id_type: ID type (second template parameter or concrete type)
         source_file_path: Absolute path to the source file containing the repository
         is_templated: Whether the repository class is templated
+        storage_base: Storage engine base class (CpaRepositoryImpl or LogCpaRepositoryImpl)
+        cache_capacity: Entity cache capacity from /// @Cacheable, or None for the default
+        write_behind_depth: Write-behind queue depth from /// @WriteBehind, or None for synchronous writes
         
     Returns:
         String containing the complete class implementation
@@ -46,33 +148,9 @@ def generate_impl_class(class_name: str, entity_type: str, id_type: str, source_
     # Generate base method implementations that delegate to CpaRepositoryImpl
     if is_templated:
         # Templated repository: use template parameters
-        base_method_implementations = f"""    Public Virtual Entity Save(Entity& entity) override {{
-        return CpaRepositoryImpl<Entity, ID>::Save(entity);
-    }}
-
-    Public Virtual optional<Entity> FindById(ID id) override {{
-        return CpaRepositoryImpl<Entity, ID>::FindById(id);
-    }}
-
-    Public Virtual vector<Entity> FindAll() override {{
-        return CpaRepositoryImpl<Entity, ID>::FindAll();
-    }}
-
-    Public Virtual Entity Update(Entity& entity) override {{
-        return CpaRepositoryImpl<Entity, ID>::Update(entity);
-    }}
-
-    Public Virtual Void DeleteById(ID id) override {{
-        CpaRepositoryImpl<Entity, ID>::DeleteById(id);
-    }}
-
-    Public Virtual Void Delete(Entity& entity) override {{
-        CpaRepositoryImpl<Entity, ID>::Delete(entity);
-    }}
-
-    Public Virtual Bool ExistsById(ID id) override {{
-        return CpaRepositoryImpl<Entity, ID>::ExistsById(id);
-    }}"""
+        base_method_implementations = generate_base_method_implementations(storage_base, "Entity", "ID")
+        constructor = generate_constructor(impl_class_name, storage_base, "Entity", "ID", cache_capacity,
+                                           write_behind_depth)
         
         # Generate custom method implementations (FindBy, DeleteBy, etc.)
         custom_method_implementations = None
@@ -113,43 +191,19 @@ struct Implementation<{class_name}<Entity, ID>*> {{
         code = f"""#ifndef {header_guard}
 #define {header_guard}
 
-#include "CpaRepositoryImpl.h"
+#include "{storage_base}.h"
 
 template<typename Entity, typename ID>
-class {impl_class_name} : public {class_name}<Entity, ID>, public CpaRepositoryImpl<Entity, ID> {{
+class {impl_class_name} : public {class_name}<Entity, ID>, public {storage_base}<Entity, ID> {{
     Public Virtual ~{impl_class_name}() = default;
-{method_implementations}
+{constructor}{method_implementations}
 #endif // {header_guard}
 """
     else:
         # Non-templated repository: use concrete types
-        base_method_implementations = f"""    Public Virtual {entity_type} Save({entity_type}& entity) override {{
-        return CpaRepositoryImpl<{entity_type}, {id_type}>::Save(entity);
-    }}
-
-    Public Virtual optional<{entity_type}> FindById({id_type} id) override {{
-        return CpaRepositoryImpl<{entity_type}, {id_type}>::FindById(id);
-    }}
-
-    Public Virtual vector<{entity_type}> FindAll() override {{
-        return CpaRepositoryImpl<{entity_type}, {id_type}>::FindAll();
-    }}
-
-    Public Virtual {entity_type} Update({entity_type}& entity) override {{
-        return CpaRepositoryImpl<{entity_type}, {id_type}>::Update(entity);
-    }}
-
-    Public Virtual Void DeleteById({id_type} id) override {{
-        CpaRepositoryImpl<{entity_type}, {id_type}>::DeleteById(id);
-    }}
-
-    Public Virtual Void Delete({entity_type}& entity) override {{
-        CpaRepositoryImpl<{entity_type}, {id_type}>::Delete(entity);
-    }}
-
-    Public Virtual Bool ExistsById({id_type} id) override {{
-        return CpaRepositoryImpl<{entity_type}, {id_type}>::ExistsById(id);
-    }}"""
+        base_method_implementations = generate_base_method_implementations(storage_base, entity_type, id_type)
+        constructor = generate_constructor(impl_class_name, storage_base, entity_type, id_type, cache_capacity,
+                                           write_behind_depth)
         
         # Generate custom method implementations (FindBy, DeleteBy, etc.)
         custom_method_implementations = None
@@ -190,11 +244,11 @@ struct Implementation<{class_name}*> {{
         code = f"""#ifndef {header_guard}
 #define {header_guard}
 
-#include "CpaRepositoryImpl.h"
+#include "{storage_base}.h"
 
-class {impl_class_name} : public {class_name}, public CpaRepositoryImpl<{entity_type}, {id_type}> {{
+class {impl_class_name} : public {class_name}, public {storage_base}<{entity_type}, {id_type}> {{
     Public Virtual ~{impl_class_name}() = default;
-{method_implementations}
+{constructor}{method_implementations}
 #endif // {header_guard}
 """
     return code
@@ -243,8 +297,16 @@ def implement_repository(file_path: str, library_dir: str, dry_run: bool = False
         # print(f"⚠️  Implementation file already exists: {impl_file_path}")
         return False
     
+    # Pick the storage engine (/// @LogStructured selects the append-only log engine)
+    storage_base = detect_storage_engine(file_path)
+    
+    # Per-repository entity cache size (/// @Cacheable(capacity)) and write-behind queue (/// @WriteBehind(depth))
+    cache_capacity = detect_cache_capacity(file_path)
+    write_behind_depth = detect_write_behind_depth(file_path)
+    
     # Generate the implementation class code
-    impl_code = generate_impl_class(class_name, entity_type, id_type, file_path, is_templated)
+    impl_code = generate_impl_class(class_name, entity_type, id_type, file_path, is_templated, storage_base,
+                                    cache_capacity, write_behind_depth)
     
     if dry_run:
         # print(f"Would create implementation file: {impl_file_path}")
@@ -14,7 +14,7 @@ import os
 import sys
 import re
 from pathlib import Path
-from typing import Optional
+from typing import List, Optional
 
 # Add parent directory to path for imports
 script_dir = os.path.dirname(os.path.abspath(__file__))
@@ -194,7 +194,7 @@ def calculate_include_path(source_file_path: str, impl_file_path: str) -> str:
     return str(impl_path)
 
 
-def process_repository(file_path: str, library_dir: str, dry_run: bool = False) -> bool:
+def process_repository(file_path: str, library_dir: str, dry_run: bool = False, outputs: Optional[List[str]] = None) -> bool:
     """
     Process a repository file: detect annotation, create implementation, and add include.
     
@@ -202,6 +202,8 @@ def process_repository(file_path: str, library_dir: str, dry_run: bool = False)
         file_path: Path to the source file to check
         library_dir: Path to the library directory (where src/repository folder should be)
         dry_run: If True, don't actually create or modify files
+        outputs: Optional list the path of the repository's implementation file is appended to
+                 when it exists (newly created or from an earlier build), for the pre-build cache
         
     Returns:
         True if repository was processed successfully, False otherwise
@@ -225,7 +227,10 @@ def process_repository(file_path: str, library_dir: str, dry_run: bool = False)
                     repository_dir = Path(library_dir) / "src" / "repository"
                     impl_file_path = repository_dir / f"{class_name}Impl.h"
                     
-                    if not impl_file_path.exists():
+                    if impl_file_path.exists():
+                        if outputs is not None:
+                            outputs.append(str(impl_file_path))
+                    else:
                         # Reprocess by manually extracting the info and creating the file
                         content_no_comments = re.sub(r'//.*?$', '', content, flags=re.MULTILINE)
                         content_no_comments = re.sub(r'/\*.*?\*/', '', content_no_comments, flags=re.DOTALL)
@@ -266,6 +271,8 @@ def process_repository(file_path: str, library_dir: str, dry_run: bool = False)
     if not dry_run and not impl_file_path.exists():
         # print(f"⚠️  Implementation file was not created: {impl_file_path}")
         return False
+    if outputs is not None and impl_file_path.exists():
+        outputs.append(str(impl_file_path))
     
     # Step 4: Calculate include path (relative from source file to impl file)
     include_path = calculate_include_path(file_path, str(impl_file_path))
@@ -34,6 +34,11 @@ try:
 except ImportError:
     get_client_files = None
 
+try:
+    from build_cache import BuildCache
+except ImportError:
+    BuildCache = None
+
 # Import the serializer scripts
 sys.path.insert(0, script_dir)
 
@@ -199,11 +204,24 @@ def process_all_serializable_classes(dry_run=False, serializable_macro=None):
     if not header_files:
         return 0
     
+    # Headers unchanged since the last build are skipped (see build_cache.py)
+    build_cache = None
+    library_dir = os.environ.get('LIBRARY_DIR') or globals().get('library_dir')
+    if BuildCache is not None and library_dir and not dry_run:
+        build_cache = BuildCache.for_library(str(library_dir), os.path.dirname(parent_dir))
+    
     processed_count = 0
+    processed_files = []
     
     for file_path in header_files:
         if not os.path.exists(file_path):
             continue
+        if build_cache is not None:
+            if build_cache.is_unchanged("serialization", file_path):
+                continue
+            # Recorded as the passes below leave it, whatever they find
+            build_cache.forget("serialization", file_path)
+            processed_files.append(file_path)
         
         # First, check if file has enum with @Serializable annotation
         if S8_handle_enum_serialization:
@@ -278,11 +296,28 @@ def process_all_serializable_classes(dry_run=False, serializable_macro=None):
         except Exception:
             id_fields = []
         
-        methods_code = S3_inject_serialization.generate_serialization_methods(class_name, fields, validation_fields_by_macro, id_fields)
+        # Extract @Indexed fields for secondary index methods
+        try:
+            from extract_id_fields import extract_indexed_fields
+            indexed_fields = extract_indexed_fields(file_path, class_name)
+        except Exception:
+            indexed_fields = []
+        
+        # /* @BinaryStorage */ also generates the compact binary encoding the repository stores
+        binary_storage = S3_inject_serialization.has_binary_storage_annotation(file_path)
+        
+        methods_code = S3_inject_serialization.generate_serialization_methods(class_name, fields, validation_fields_by_macro, id_fields, binary_storage, indexed_fields)
         
         if not dry_run:
             if optional_fields:
                 S3_inject_serialization.add_include_if_needed(file_path, "<optional>")
+            S3_inject_serialization.add_include_if_needed(file_path, "<CodecArena.h>")
+            if id_fields:
+                S3_inject_serialization.add_include_if_needed(file_path, "<string_view>")
+            if binary_storage:
+                S3_inject_serialization.add_include_if_needed(file_path, "<BinaryCodec.h>")
+            if indexed_fields:
+                S3_inject_serialization.add_include_if_needed(file_path, "<IndexKey.h>")
         
         success = S3_inject_serialization.inject_methods_into_class(file_path, class_name, methods_code, dry_run=dry_run)
         
@@ -290,6 +325,11 @@ def process_all_serializable_classes(dry_run=False, serializable_macro=None):
             if not dry_run:
                 S3_inject_serialization.comment_dto_macro(file_path, dry_run=False, serializable_macro=serializable_macro)
             processed_count += 1
+    
+    if build_cache is not None:
+        for file_path in processed_files:
+            build_cache.record("serialization", file_path)
+        build_cache.save()
     return processed_count
 
 
@@ -24,7 +24,7 @@ try:
     import S6_discover_validation_macros
     import S7_extract_validation_fields
     # Import extract_id_fields for primary key generation
-    from extract_id_fields import extract_id_fields
+    from extract_id_fields import extract_id_fields, extract_indexed_fields
 except ImportError as e:
     sys.exit(1)
 
@@ -86,9 +86,271 @@ def extract_inner_type_from_optional(field_type: str) -> str:
     return field_type
 
 
+def has_binary_storage_annotation(file_path: str) -> bool:
+    """Check if the Entity class opts into the binary storage format with /* @BinaryStorage */."""
+    try:
+        with open(file_path, 'r', encoding='utf-8') as file:
+            for line in file:
+                stripped_line = line.strip()
+                if stripped_line.startswith('//'):
+                    continue
+                if re.search(r'/\*\s*@BinaryStorage\s*\*/', stripped_line):
+                    return True
+    except Exception:
+        pass
+    return False
+
+
+def get_binary_field_kind(inner_type: str) -> str:
+    """Map the inner type of an optional field to its BinaryWriter/BinaryField accessor."""
+    primitive_types = ['int', 'Int', 'CInt', 'long', 'Long', 'CLong', 'float', 'Float', 'CFloat', 
+                      'double', 'Double', 'CDouble', 'bool', 'Bool', 'CBool', 'char', 'Char', 'CChar',
+                      'unsigned', 'UInt', 'CUInt', 'short', 'Short', 'CShort']
+    is_primitive = any(prim in inner_type for prim in primitive_types)
+    is_string = 'StdString' in inner_type or 'CStdString' in inner_type or 'string' in inner_type.lower()
+    
+    if is_string:
+        return 'string'
+    if not is_primitive:
+        # Nested object or enum: stored as its SerializeValue() text
+        return 'value'
+    if 'bool' in inner_type.lower():
+        return 'bool'
+    if 'float' in inner_type.lower():
+        return 'float'
+    if 'double' in inner_type.lower():
+        return 'double'
+    return 'int'
+
+
+def generate_optional_field_read(field_name: str, inner_type: str) -> List[str]:
+    """
+    Generate the lines assigning an optional field from a parsed JSON document `doc` when it is present.
+    
+    Shared by Deserialize() (fields without validation macros), DeserializeTrusted() and DeserializeFields().
+    """
+    primitive_types = ['int', 'Int', 'CInt', 'long', 'Long', 'CLong', 'float', 'Float', 'CFloat', 
+                      'double', 'Double', 'CDouble', 'bool', 'Bool', 'CBool', 'char', 'Char', 'CChar',
+                      'unsigned', 'UInt', 'CUInt', 'short', 'Short', 'CShort']
+    is_primitive = any(prim in inner_type for prim in primitive_types)
+    is_string = 'StdString' in inner_type or 'CStdString' in inner_type or 'string' in inner_type.lower()
+    
+    lines = []
+    lines.append(f"        // Deserialize optional field: {field_name}")
+    lines.append(f"        if (!doc[\"{field_name}\"].isNull()) {{")
+    if is_string:
+        lines.append(f"            obj.{field_name} = StdString(doc[\"{field_name}\"].as<const char*>());")
+    elif is_primitive:
+        if 'bool' in inner_type.lower() or 'Bool' in inner_type:
+            lines.append(f"            obj.{field_name} = doc[\"{field_name}\"].as<bool>();")
+        elif 'int' in inner_type.lower() or 'Int' in inner_type:
+            lines.append(f"            obj.{field_name} = doc[\"{field_name}\"].as<int>();")
+        elif 'float' in inner_type.lower() or 'Float' in inner_type:
+            lines.append(f"            obj.{field_name} = doc[\"{field_name}\"].as<float>();")
+        elif 'double' in inner_type.lower() or 'Double' in inner_type:
+            lines.append(f"            obj.{field_name} = doc[\"{field_name}\"].as<double>();")
+        elif 'char' in inner_type.lower() or 'Char' in inner_type:
+            lines.append(f"            obj.{field_name} = doc[\"{field_name}\"].as<char>();")
+        else:
+            lines.append(f"            obj.{field_name} = doc[\"{field_name}\"].as<{inner_type}>();")
+    else:
+        # For nested object/enum types in optional, use DeserializeValue
+        # Handle both enums (which serialize to strings) and complex objects
+        lines.append(f"            // Deserialize nested object or enum: {field_name}")
+        lines.append(f"            StdString {field_name}_json;")
+        lines.append(f"            if (doc[\"{field_name}\"].is<const char*>()) {{")
+        lines.append(f"                // Enum or string value - extract directly")
+        lines.append(f"                {field_name}_json = StdString(doc[\"{field_name}\"].as<const char*>());")
+        lines.append(f"            }} else {{")
+        lines.append(f"                // Complex object - serialize to JSON string")
+        lines.append(f"                JsonObject {field_name}_obj = doc[\"{field_name}\"].as<JsonObject>();")
+        lines.append(f"                serializeJson({field_name}_obj, {field_name}_json);")
+        lines.append(f"            }}")
+        lines.append(f"            obj.{field_name} = nayan::serializer::DeserializeValue<{inner_type}>({field_name}_json);")
+    lines.append(f"        }}")
+    return lines
+
+
+def generate_trusted_method(class_name: str, fields: List[Dict[str, str]], binary_storage: bool = False) -> str:
+    """
+    Generate DeserializeTrusted(), the repository's decoder for records read back from its own storage.
+    
+    Records were validated by Deserialize()/the validation macros before they were saved, so the
+    validation pass is skipped and every field is read only when present. A record that doesn't
+    parse is reported by returning false, so loading never throws. With binary_storage, binary
+    records go to the non-throwing DeserializeBinary() overload.
+    """
+    code_lines = []
+    optional_fields = [field for field in fields if is_optional_type(field['type'].strip())]
+    
+    code_lines.append("    // Trusted deserialization method (stored records: no validation, false instead of an exception)")
+    code_lines.append(f"    Public Static Bool DeserializeTrusted(const StdString& input, {class_name}& obj) {{")
+    if binary_storage:
+        code_lines.append("        if (BinaryReader::IsBinaryRecord(input)) {")
+        code_lines.append("            return DeserializeBinary(input, obj);")
+        code_lines.append("        }")
+        code_lines.append("")
+    code_lines.append("        JsonDocument doc(&CodecArena::Local());")
+    code_lines.append("        if (deserializeJson(doc, input.c_str())) {")
+    code_lines.append("            return false;")
+    code_lines.append("        }")
+    code_lines.append("")
+    code_lines.append(f"        obj = {class_name}();")
+    for field in optional_fields:
+        code_lines.extend(generate_optional_field_read(field['name'], extract_inner_type_from_optional(field['type'].strip())))
+    code_lines.append("        return true;")
+    code_lines.append("    }")
+    return "\n".join(code_lines)
+
+
+def generate_projection_method(class_name: str, fields: List[Dict[str, str]]) -> str:
+    """
+    Generate DeserializeFields(), which parses only the named fields of a JSON record.
+    
+    An ArduinoJson filter document keeps every other field out of the parsed document, and no
+    validation runs (the fields are read back from storage). Repository queries use it to test
+    their predicate before decoding a record in full; fields not named stay empty. Like
+    DeserializeTrusted() it doesn't throw: a record that doesn't parse comes back with no fields set.
+    """
+    code_lines = []
+    optional_fields = [field for field in fields if is_optional_type(field['type'].strip())]
+    
+    code_lines.append("    // Projection deserialization method (only the named fields are parsed, no validation)")
+    code_lines.append(f"    Public Static {class_name} DeserializeFields(const StdString& input, const Vector<StdString>& fields) {{")
+    code_lines.append("        // Keep only the named fields in the parsed document")
+    code_lines.append("        JsonDocument filter(&CodecArena::Local());")
+    code_lines.append("        for (const auto& field : fields) {")
+    code_lines.append("            filter[field.c_str()] = true;")
+    code_lines.append("        }")
+    code_lines.append("")
+    code_lines.append(f"        {class_name} obj;")
+    code_lines.append("        JsonDocument doc(&CodecArena::Local());")
+    code_lines.append("        if (deserializeJson(doc, input.c_str(), DeserializationOption::Filter(filter))) {")
+    code_lines.append("            return obj;")
+    code_lines.append("        }")
+    code_lines.append("")
+    for field in optional_fields:
+        code_lines.extend(generate_optional_field_read(field['name'], extract_inner_type_from_optional(field['type'].strip())))
+    code_lines.append("        return obj;")
+    code_lines.append("    }")
+    return "\n".join(code_lines)
+
+
+def generate_binary_serialization_methods(class_name: str, fields: List[Dict[str, str]]) -> str:
+    """
+    Generate SerializeBinary() and DeserializeBinary() for /* @BinaryStorage */ entities.
+    
+    DeserializeBinary(input) throws on a truncated record; DeserializeBinary(input, obj) returns false.
+    
+    Every optional field gets a fixed tag (its position among the optional fields, starting at 1),
+    so new fields should be appended at the end of the class to keep existing records readable.
+    See BinaryCodec.h for the record layout.
+    """
+    code_lines = []
+    optional_fields = [field for field in fields if is_optional_type(field['type'].strip())]
+    
+    write_calls = {
+        'int': 'WriteInt',
+        'bool': 'WriteBool',
+        'float': 'WriteFloat',
+        'double': 'WriteDouble',
+        'string': 'WriteString',
+    }
+    
+    code_lines.append("    // Binary storage serialization method (/* @BinaryStorage */)")
+    code_lines.append(f"    Public StdString SerializeBinary() const {{")
+    code_lines.append("        BinaryWriter writer;")
+    for tag, field in enumerate(optional_fields, 1):
+        field_name = field['name']
+        kind = get_binary_field_kind(extract_inner_type_from_optional(field['type'].strip()))
+        code_lines.append(f"        if ({field_name}.has_value()) {{")
+        if kind == 'value':
+            code_lines.append(f"            writer.WriteString({tag}, nayan::serializer::SerializeValue({field_name}.value()));")
+        else:
+            code_lines.append(f"            writer.{write_calls[kind]}({tag}, {field_name}.value());")
+        code_lines.append(f"        }}")
+    code_lines.append("        return writer.Release();")
+    code_lines.append("    }")
+    code_lines.append("")
+    
+    code_lines.append("    // Binary storage deserialization method (no JSON document and no validation pass)")
+    code_lines.append(f"    Public Static {class_name} DeserializeBinary(const StdString& input) {{")
+    code_lines.append(f"        {class_name} obj;")
+    code_lines.append("        if (!DeserializeBinary(input, obj)) {")
+    code_lines.append("            throw std::runtime_error(\"Binary record parse error\");")
+    code_lines.append("        }")
+    code_lines.append("        return obj;")
+    code_lines.append("    }")
+    code_lines.append("")
+    code_lines.append("    // Binary storage deserialization into obj, false if the record is truncated")
+    code_lines.append(f"    Public Static Bool DeserializeBinary(const StdString& input, {class_name}& obj) {{")
+    code_lines.append(f"        obj = {class_name}();")
+    code_lines.append("        BinaryReader reader(input);")
+    code_lines.append("        BinaryField field;")
+    code_lines.append("        while (reader.Next(field)) {")
+    code_lines.append("            switch (field.tag) {")
+    for tag, field in enumerate(optional_fields, 1):
+        field_name = field['name']
+        inner_type = extract_inner_type_from_optional(field['type'].strip())
+        kind = get_binary_field_kind(inner_type)
+        if kind == 'int':
+            value = f"field.AsInt<{inner_type}>()"
+        elif kind == 'bool':
+            value = "field.AsBool()"
+        elif kind == 'float':
+            value = "field.AsFloat()"
+        elif kind == 'double':
+            value = "field.AsDouble()"
+        elif kind == 'string':
+            value = "field.AsString()"
+        else:
+            value = f"nayan::serializer::DeserializeValue<{inner_type}>(field.AsString())"
+        code_lines.append(f"                case {tag}: obj.{field_name} = {value}; break;")
+    code_lines.append("                default: break;")
+    code_lines.append("            }")
+    code_lines.append("        }")
+    code_lines.append("        return reader.Ok();")
+    code_lines.append("    }")
+    
+    return "\n".join(code_lines)
+
+
+def generate_index_methods(indexed_fields: List[Dict[str, str]]) -> str:
+    """
+    Generate GetIndexedFields() and GetIndexKeys() for the /* @Indexed */ fields of an Entity class.
+    
+    The repository keeps one persisted value -> IDs index per field (see SecondaryIndex.h).
+    Only string and primitive fields can be indexed; other fields are skipped.
+    """
+    usable_fields = []
+    for field in indexed_fields:
+        field_type = field['type'].strip()
+        inner_type = extract_inner_type_from_optional(field_type) if is_optional_type(field_type) else field_type
+        if get_binary_field_kind(inner_type) != 'value':
+            usable_fields.append(field)
+    
+    if not usable_fields:
+        return ""
+    
+    field_names = ", ".join(f'"{field["name"]}"' for field in usable_fields)
+    field_keys = ", ".join(f'IndexKeyOf({field["name"]})' for field in usable_fields)
+    
+    methods = []
+    methods.append("    // Secondary index methods (/* @Indexed */ fields)")
+    methods.append("    inline Static Vector<StdString> GetIndexedFields() {")
+    methods.append(f"        return {{{field_names}}};")
+    methods.append("    }")
+    methods.append("")
+    methods.append("    inline Vector<optional<StdString>> GetIndexKeys() const {")
+    methods.append(f"        return {{{field_keys}}};")
+    methods.append("    }")
+    return "\n".join(methods)
+
+
 def generate_primary_key_methods(class_name: str, id_fields: List[Dict[str, str]] = None) -> str:
     """
-    Generate GetPrimaryKey(), GetPrimaryKeyName(), and GetTableName() methods.
+    Generate GetPrimaryKey(), GetPrimaryKeyName(), and GetTableName() methods, plus the constexpr
+    GetStorageKeyPrefix()/GetIdsFileKey() storage keys when the class has an @Id field.
     
     Args:
         class_name: Name of the class
@@ -106,7 +368,7 @@ def generate_primary_key_methods(class_name: str, id_fields: List[Dict[str, str]
         field_name = primary_key_field['name']
         
         # GetPrimaryKey() method
-        methods.append(f"    inline {field_type} GetPrimaryKey() {{")
+        methods.append(f"    inline {field_type} GetPrimaryKey() const {{")
         methods.append(f"        return {field_name};")
         methods.append(f"    }}")
         methods.append("")
@@ -118,7 +380,7 @@ def generate_primary_key_methods(class_name: str, id_fields: List[Dict[str, str]
     else:
         # No @Id field found, generate methods that return default values
         # GetPrimaryKey() method - return default constructed value
-        methods.append(f"    inline int GetPrimaryKey() {{")
+        methods.append(f"    inline int GetPrimaryKey() const {{")
         methods.append(f"        return 0;")
         methods.append(f"    }}")
         methods.append("")
@@ -135,11 +397,34 @@ def generate_primary_key_methods(class_name: str, id_fields: List[Dict[str, str]
     methods.append(f'        return "{class_name}";')
     methods.append(f"    }}")
     
+    # Storage keys fixed at build time, so the repository doesn't rebuild them on every call
+    if id_fields and len(id_fields) > 0:
+        methods.append("")
+        methods.append(f"    // Every record key is this prefix followed by the ID")
+        methods.append(f"    inline Static constexpr std::string_view GetStorageKeyPrefix() {{")
+        methods.append(f'        return "{class_name}_{field_name}_";')
+        methods.append(f"    }}")
+        methods.append("")
+        methods.append(f"    inline Static constexpr std::string_view GetIdsFileKey() {{")
+        methods.append(f'        return "{class_name}_IDs";')
+        methods.append(f"    }}")
+    
     return "\n".join(methods)
 
 
-def generate_serialization_methods(class_name: str, fields: List[Dict[str, str]], validation_fields_by_macro: Dict[str, List[Dict[str, str]]] = None, id_fields: List[Dict[str, str]] = None) -> str:
-    """Generate Serialize() and Deserialize() methods for an Entity class, plus primary key methods."""
+def generate_serialization_methods(class_name: str, fields: List[Dict[str, str]], validation_fields_by_macro: Dict[str, List[Dict[str, str]]] = None, id_fields: List[Dict[str, str]] = None,
+                                   binary_storage: bool = False, indexed_fields: List[Dict[str, str]] = None) -> str:
+    """Generate Serialize() and Deserialize() methods for an Entity class, plus primary key methods.
+    
+    Every JsonDocument is built on the calling thread's CodecArena (CodecArena.h), so the pools
+    of one record's document are reused by the next; Serialize(output) writes into a caller buffer.
+    
+    DeserializeTrusted() decodes records the repository reads back from storage without validating them;
+    DeserializeFields() parses a subset of the fields for repository queries.
+    With binary_storage (/* @BinaryStorage */) SerializeBinary()/DeserializeBinary() are generated as well;
+    the repository stores that encoding and keeps JSON for everything else.
+    indexed_fields (/* @Indexed */) adds the secondary index methods.
+    """
     if validation_fields_by_macro is None:
         validation_fields_by_macro = {}
     if id_fields is None:
@@ -149,8 +434,15 @@ def generate_serialization_methods(class_name: str, fields: List[Dict[str, str]]
     # Generate Serialize() method
     code_lines.append("    // Serialization method")
     code_lines.append(f"    Public StdString Serialize() const {{")
+    code_lines.append("        StdString output;")
+    code_lines.append("        Serialize(output);")
+    code_lines.append("        return output;")
+    code_lines.append("    }")
+    code_lines.append("")
+    code_lines.append("    // Serialization into a caller-owned buffer (its capacity is reused across records)")
+    code_lines.append(f"    Public Void Serialize(StdString& output) const {{")
     code_lines.append("        // Create JSON document")
-    code_lines.append("        JsonDocument doc;")
+    code_lines.append("        JsonDocument doc(&CodecArena::Local());")
     code_lines.append("")
     
     # Only serialize optional fields - skip non-optional fields
@@ -186,7 +478,7 @@ def generate_serialization_methods(class_name: str, fields: List[Dict[str, str]]
                 code_lines.append(f"            // or call .Serialize() for complex objects (returns JSON string)")
                 code_lines.append(f"            StdString {field_name}_json = nayan::serializer::SerializeValue({field_name}.value());")
                 code_lines.append(f"            // Try to parse as JSON object (for complex objects)")
-                code_lines.append(f"            JsonDocument {field_name}_doc;")
+                code_lines.append(f"            JsonDocument {field_name}_doc(&CodecArena::Local());")
                 code_lines.append(f"            DeserializationError {field_name}_error = deserializeJson({field_name}_doc, {field_name}_json.c_str());")
                 code_lines.append(f"            if ({field_name}_error == DeserializationError::Ok && {field_name}_doc.is<JsonObject>()) {{")
                 code_lines.append(f"                // Complex object - add parsed JSON object")
@@ -203,10 +495,8 @@ def generate_serialization_methods(class_name: str, fields: List[Dict[str, str]]
     
     code_lines.append("")
     code_lines.append("        // Serialize to string")
-    code_lines.append("        StdString output;")
+    code_lines.append("        output.clear();")
     code_lines.append("        serializeJson(doc, output);")
-    code_lines.append("")
-    code_lines.append("        return StdString(output.c_str());")
     code_lines.append("    }")
     code_lines.append("")
     
@@ -246,7 +536,7 @@ def generate_serialization_methods(class_name: str, fields: List[Dict[str, str]]
                     code_lines.append(f"        if (!doc[\"{field_name}\"].isNull()) {{")
                     code_lines.append(f"            // Extract nested object and convert to JsonDocument for validation")
                     code_lines.append(f"            JsonObject {field_name}_obj = doc[\"{field_name}\"].template as<JsonObject>();")
-                    code_lines.append(f"            JsonDocument {field_name}_doc;")
+                    code_lines.append(f"            JsonDocument {field_name}_doc(&CodecArena::Local());")
                     code_lines.append(f"            // Copy the JsonObject into JsonDocument")
                     code_lines.append(f"            {field_name}_doc.set({field_name}_obj);")
                     code_lines.append(f"            // Validate nested object's fields")
@@ -278,7 +568,7 @@ def generate_serialization_methods(class_name: str, fields: List[Dict[str, str]]
     code_lines.append("    // Deserialization method")
     code_lines.append(f"    Public Static {class_name} Deserialize(const StdString& input) {{")
     code_lines.append("        // Create JSON document")
-    code_lines.append("        JsonDocument doc;")
+    code_lines.append("        JsonDocument doc(&CodecArena::Local());")
     code_lines.append("")
     code_lines.append("        // Deserialize JSON string")
     code_lines.append("        DeserializationError error = deserializeJson(doc, input.c_str());")
@@ -362,46 +652,32 @@ def generate_serialization_methods(class_name: str, fields: List[Dict[str, str]]
                     code_lines.append(f"        }}")
                     code_lines.append(f"        obj.{field_name} = nayan::serializer::DeserializeValue<{inner_type}>({field_name}_json);")
             else:
-                code_lines.append(f"        // Deserialize optional field: {field_name}")
-                code_lines.append(f"        if (!doc[\"{field_name}\"].isNull()) {{")
-                
-                if is_string:
-                    code_lines.append(f"            obj.{field_name} = StdString(doc[\"{field_name}\"].as<const char*>());")
-                elif is_primitive:
-                    if 'bool' in inner_type.lower() or 'Bool' in inner_type:
-                        code_lines.append(f"            obj.{field_name} = doc[\"{field_name}\"].as<bool>();")
-                    elif 'int' in inner_type.lower() or 'Int' in inner_type:
-                        code_lines.append(f"            obj.{field_name} = doc[\"{field_name}\"].as<int>();")
-                    elif 'float' in inner_type.lower() or 'Float' in inner_type:
-                        code_lines.append(f"            obj.{field_name} = doc[\"{field_name}\"].as<float>();")
-                    elif 'double' in inner_type.lower() or 'Double' in inner_type:
-                        code_lines.append(f"            obj.{field_name} = doc[\"{field_name}\"].as<double>();")
-                    elif 'char' in inner_type.lower() or 'Char' in inner_type:
-                        code_lines.append(f"            obj.{field_name} = doc[\"{field_name}\"].as<char>();")
-                    else:
-                        code_lines.append(f"            obj.{field_name} = doc[\"{field_name}\"].as<{inner_type}>();")
-                else:
-                    # For nested object/enum types in optional, use DeserializeValue
-                    # Handle both enums (which serialize to strings) and complex objects
-                    code_lines.append(f"            // Deserialize nested object or enum: {field_name}")
-                    code_lines.append(f"            StdString {field_name}_json;")
-                    code_lines.append(f"            if (doc[\"{field_name}\"].is<const char*>()) {{")
-                    code_lines.append(f"                // Enum or string value - extract directly")
-                    code_lines.append(f"                {field_name}_json = StdString(doc[\"{field_name}\"].as<const char*>());")
-                    code_lines.append(f"            }} else {{")
-                    code_lines.append(f"                // Complex object - serialize to JSON string")
-                    code_lines.append(f"                JsonObject {field_name}_obj = doc[\"{field_name}\"].as<JsonObject>();")
-                    code_lines.append(f"                serializeJson({field_name}_obj, {field_name}_json);")
-                    code_lines.append(f"            }}")
-                    code_lines.append(f"            obj.{field_name} = nayan::serializer::DeserializeValue<{inner_type}>({field_name}_json);")
-                
-                code_lines.append(f"        }}")
-    
+                code_lines.extend(generate_optional_field_read(field_name, inner_type))
+            
     code_lines.append("")
     code_lines.append("        return obj;")
     code_lines.append("    }")
     code_lines.append("")
     
+    for line in generate_trusted_method(class_name, fields, binary_storage).split('\n'):
+        code_lines.append(line)
+    code_lines.append("")
+    
+    for line in generate_projection_method(class_name, fields).split('\n'):
+        code_lines.append(line)
+    code_lines.append("")
+    
+    if binary_storage:
+        for line in generate_binary_serialization_methods(class_name, fields).split('\n'):
+            code_lines.append(line)
+        code_lines.append("")
+    
+    index_methods = generate_index_methods(indexed_fields) if indexed_fields else ""
+    if index_methods:
+        for line in index_methods.split('\n'):
+            code_lines.append(line)
+        code_lines.append("")
+    
     # Always generate primary key methods after serialization methods
     code_lines.append("    // Primary key methods")
     primary_key_methods = generate_primary_key_methods(class_name, id_fields)
@@ -569,12 +845,30 @@ def main():
         args.file_path, class_name, validation_macros
     )
     
-    methods_code = generate_serialization_methods(class_name, fields, validation_fields_by_macro, id_fields)
+    binary_storage = has_binary_storage_annotation(args.file_path)
+    
+    try:
+        indexed_fields = extract_indexed_fields(args.file_path, class_name)
+    except Exception:
+        indexed_fields = []
+    
+    methods_code = generate_serialization_methods(class_name, fields, validation_fields_by_macro, id_fields, binary_storage, indexed_fields)
     
     if not args.dry_run:
         if has_optional_fields:
             add_include_if_needed(args.file_path, "<optional>")
         
+        add_include_if_needed(args.file_path, "<CodecArena.h>")
+        
+        if id_fields:
+            add_include_if_needed(args.file_path, "<string_view>")
+        
+        if binary_storage:
+            add_include_if_needed(args.file_path, "<BinaryCodec.h>")
+        
+        if indexed_fields:
+            add_include_if_needed(args.file_path, "<IndexKey.h>")
+        
         # Check if we need NayanSerializer.h for SerializeValue/DeserializeValue
         needs_serializer = False
         for field in fields:
@@ -610,6 +904,12 @@ __all__ = [
     'add_include_if_needed',
     'is_optional_type',
     'extract_inner_type_from_optional',
+    'has_binary_storage_annotation',
+    'generate_optional_field_read',
+    'generate_trusted_method',
+    'generate_projection_method',
+    'generate_binary_serialization_methods',
+    'generate_index_methods',
     'generate_serialization_methods',
     'mark_dto_annotation_processed',
     'comment_dto_macro',
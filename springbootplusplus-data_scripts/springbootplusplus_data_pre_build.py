@@ -457,27 +457,53 @@ try:
                     sys.path.insert(0, str(springbootplusplus_data_scripts_dir))
                     
                     from springbootplusplus_data_core.repository.process_repository import process_repository
+                    from springbootplusplus_data_core.build_cache import BuildCache
+                    
+                    # Headers unchanged since the last build (with their implementation still in place) are skipped
+                    build_cache = BuildCache.for_library(str(library_dir), str(springbootplusplus_data_scripts_dir))
                     
                     processed_count = 0
                     implemented_count = 0
                     
                     for file_path in all_header_files:
+                        if build_cache.is_unchanged("repository", str(file_path)):
+                            continue
                         try:
+                            # An edited repository gets a fresh implementation: the one generated from the old header
+                            # is set aside, and put back only if no new one could be generated
+                            stale_outputs = []
+                            for stale_output in build_cache.recorded_outputs("repository", str(file_path)):
+                                if os.path.exists(stale_output):
+                                    os.replace(stale_output, stale_output + ".stale")
+                                    stale_outputs.append(stale_output)
+                            
                             # Process file for repository implementation
                             # This will detect @Repository annotation, create impl file, and add include
-                            result = process_repository(str(file_path), str(library_dir), dry_run=False)
+                            outputs = []
+                            try:
+                                result = process_repository(str(file_path), str(library_dir), dry_run=False, outputs=outputs)
+                            finally:
+                                for stale_output in stale_outputs:
+                                    if os.path.exists(stale_output):
+                                        os.remove(stale_output + ".stale")
+                                    else:
+                                        os.replace(stale_output + ".stale", stale_output)
                             if result:
                                 # print(f"  ✓ Repository implementation generated for: {file_path}")
                                 implemented_count += 1
                             else:
                                 # print(f"  - No repository found in: {file_path}")
                                 pass
+                            build_cache.record("repository", str(file_path), outputs)
                             processed_count += 1
                         except Exception as e:
                             # print(f"⚠️  Warning: Error processing {file_path}: {e}")
+                            build_cache.forget("repository", str(file_path))
                             import traceback
                             traceback.print_exc()
                     
+                    build_cache.save()
+                    
                     # print(f"\n✅ Processed {processed_count} file(s), implemented {implemented_count} repository(ies)")
                     
                 except ImportError as e:
@@ -1,35 +1,163 @@
 #ifdef ARDUINO
+// FILE_MANAGER_LITTLEFS selects LittleFsFileManager as the IFileManager component instead
+#ifndef FILE_MANAGER_LITTLEFS
 #ifndef ARDUINO_FILE_MANAGER_H
 #define ARDUINO_FILE_MANAGER_H
 
 // #include "IFileManager.h"
+#include "repository/RepositoryMutex.h"
 
 // ESP32 Preferences library for reliable storage
 #ifdef ESP32
     #include <Preferences.h>
     #define PREFERENCES_AVAILABLE
+    #include <cstdio>
+    #include <cstdint>
 #endif
 
+// Append-heavy values (e.g. IDs files) are stored as a chain of chunks: key, key.1, key.2, ...
+// with the number of extra chunks under key.n. Append only rewrites the last chunk, or starts a new
+// one once it would grow past this size, so its cost doesn't depend on the size of the value.
+#ifndef ARDUINO_FILE_MANAGER_CHUNK_BYTES
+#define ARDUINO_FILE_MANAGER_CHUNK_BYTES 512
+#endif
+
+// Longest NVS key name (NVS_KEY_NAME_MAX_SIZE - 1); keys too long for a suffix are never chunked
+#define ARDUINO_FILE_MANAGER_MAX_KEY_LENGTH 15
+
+// The manager is shared by every repository and the Preferences handle is not thread-safe, so each
+// operation holds a mutex (tables written by a write-behind task or from both cores share it)
 /* @Component */
 class ArduinoFileManager final : public IFileManager {
     #ifdef PREFERENCES_AVAILABLE
     private:
         Preferences preferences;
+        RepositoryMutex mutex;
+
+        // Nesting depth of BeginSession/EndSession and whether the session holds the namespace open
+        int sessionDepth = 0;
+        bool sessionOpen = false;
+
+        // Open the namespace for a single operation (no-op while a session holds it open)
+        bool OpenNamespace(bool readOnly) {
+            if (sessionOpen) {
+                return true;
+            }
+            return preferences.begin("filemanager", readOnly);
+        }
+
+        // Close the namespace after a single operation (no-op while a session holds it open)
+        void CloseNamespace() {
+            if (!sessionOpen) {
+                preferences.end();
+            }
+        }
+
+        // Build the name of chunk index of a key (false if it wouldn't fit in an NVS key)
+        bool ChunkKey(const char* key, unsigned int index, char (&out)[ARDUINO_FILE_MANAGER_MAX_KEY_LENGTH + 1]) {
+            int length = std::snprintf(out, sizeof(out), "%s.%u", key, index);
+            return length > 0 && length <= ARDUINO_FILE_MANAGER_MAX_KEY_LENGTH;
+        }
+
+        // Name of the key holding the number of extra chunks
+        bool ChunkCountKey(const char* key, char (&out)[ARDUINO_FILE_MANAGER_MAX_KEY_LENGTH + 1]) {
+            int length = std::snprintf(out, sizeof(out), "%s.n", key);
+            return length > 0 && length <= ARDUINO_FILE_MANAGER_MAX_KEY_LENGTH;
+        }
+
+        // Number of chunks after the first one (0 for values written in one piece)
+        uint16_t GetChunkCount(const char* key) {
+            char countKey[ARDUINO_FILE_MANAGER_MAX_KEY_LENGTH + 1];
+            if (!ChunkCountKey(key, countKey) || !preferences.isKey(countKey)) {
+                return 0;
+            }
+            return preferences.getUShort(countKey, 0);
+        }
+
+        // Remove the extra chunks of a key, leaving the first one
+        void RemoveChunks(const char* key) {
+            uint16_t chunks = GetChunkCount(key);
+            if (chunks == 0) {
+                return;
+            }
+            char chunkKey[ARDUINO_FILE_MANAGER_MAX_KEY_LENGTH + 1];
+            for (unsigned int i = 1; i <= chunks; i++) {
+                if (ChunkKey(key, i, chunkKey)) {
+                    preferences.remove(chunkKey);
+                }
+            }
+            char countKey[ARDUINO_FILE_MANAGER_MAX_KEY_LENGTH + 1];
+            ChunkCountKey(key, countKey);
+            preferences.remove(countKey);
+        }
+
+        // Size of one stored value in bytes (strings have to be read, NVS doesn't report their length)
+        size_t GetValueSize(const char* key) {
+            PreferenceType type = preferences.getType(key);
+            if (type == PT_BLOB) {
+                return preferences.getBytesLength(key);
+            }
+            if (type == PT_STR) {
+                return preferences.getString(key, "").length();
+            }
+            return 0;
+        }
+
+        // Read a value stored either as a string or, when it holds NUL bytes, as a blob
+        // Blobs are read straight into the caller's buffer
+        void GetValue(const char* key, StdString& content) {
+            if (preferences.getType(key) == PT_BLOB) {
+                content.resize(preferences.getBytesLength(key));
+                if (!content.empty()) {
+                    content.resize(preferences.getBytes(key, &content[0], content.length()));
+                }
+                return;
+            }
+            String arduinoString = preferences.getString(key, "");
+            content.assign(arduinoString.c_str(), arduinoString.length());
+        }
+
+        // Store text with putString and binary contents (e.g. /* @BinaryStorage */ records) with putBytes
+        // putString needs a NUL-terminated copy unless the caller's contents already are (terminated == true)
+        size_t PutValue(const char* key, std::string_view contents, bool terminated) {
+            bool binary = contents.find('\0') != std::string_view::npos;
+            PreferenceType existingType = preferences.getType(key);
+            if (existingType != PT_INVALID && existingType != (binary ? PT_BLOB : PT_STR)) {
+                // NVS keys are typed, drop the old entry before changing representation
+                preferences.remove(key);
+            }
+            if (binary) {
+                return preferences.putBytes(key, contents.data(), contents.length());
+            }
+            if (terminated) {
+                return preferences.putString(key, contents.data());
+            }
+            return preferences.putString(key, StdString(contents).c_str());
+        }
+
+        // Open the namespace, store one value (replacing any chunks) and close it again
+        bool WriteValue(const char* key, std::string_view contents, bool terminated) {
+            FileCallScope call(stats, FileCall::Write);
+            call.Bytes(contents.length());
+            RepositoryLock<RepositoryMutex> lock(mutex);
+            bool result = OpenNamespace(false);
+            if (!result) {
+                return false;
+            }
+            
+            RemoveChunks(key);
+            size_t bytesWritten = PutValue(key, contents, terminated);
+            CloseNamespace();
+            
+            return bytesWritten > 0;
+        }
     #endif
 
     public:
         // Create: Create a new file with the given filename and contents
         Bool Create(CStdString& filename, CStdString& contents) override {
             #ifdef PREFERENCES_AVAILABLE
-                bool result = preferences.begin("filemanager", false);
-                if (!result) {
-                    return false;
-                }
-                
-                size_t bytesWritten = preferences.putString(filename.c_str(), contents.c_str());
-                preferences.end();
-                
-                return bytesWritten > 0;
+                return WriteValue(filename.c_str(), contents, true);
             #else
                 return false;
             #endif
@@ -37,20 +165,56 @@ class ArduinoFileManager final : public IFileManager {
 
         // Read: Read the contents of a file with the given filename
         StdString Read(CStdString& filename) override {
+            StdString content;
+            Read(filename.c_str(), content);
+            return content;
+        }
+
+        // Read: Read the contents of a file into a caller-owned buffer
+        Bool Read(CStdString& filename, StdString& contents) override {
+            return Read(filename.c_str(), contents);
+        }
+
+        // Read: Read the contents of a key into a caller-owned buffer (no key copy)
+        Bool Read(const char* filename, StdString& contents) override {
+            contents.clear();
             #ifdef PREFERENCES_AVAILABLE
-                bool result = preferences.begin("filemanager", true); // true = read-only
+                FileCallScope call(stats, FileCall::Read);
+                RepositoryLock<RepositoryMutex> lock(mutex);
+                bool result = OpenNamespace(true); // true = read-only
                 if (!result) {
-                    preferences.end();
-                    return StdString("");
+                    return false;
                 }
                 
-                String arduinoString = preferences.getString(filename.c_str(), "");
-                StdString content = StdString(arduinoString.c_str());
-                preferences.end();
+                GetValue(filename, contents);
                 
-                return content;
+                // Reassemble appended chunks
+                uint16_t chunks = GetChunkCount(filename);
+                if (chunks > 0) {
+                    StdString chunk;
+                    char chunkKey[ARDUINO_FILE_MANAGER_MAX_KEY_LENGTH + 1];
+                    for (unsigned int i = 1; i <= chunks; i++) {
+                        if (ChunkKey(filename, i, chunkKey)) {
+                            GetValue(chunkKey, chunk);
+                            contents.append(chunk);
+                        }
+                    }
+                }
+                CloseNamespace();
+                call.Bytes(contents.length());
+                
+                return !contents.empty();
             #else
-                return StdString("");
+                return false;
+            #endif
+        }
+
+        // Write: Create or overwrite a key from a view of the contents
+        Bool Write(const char* filename, std::string_view contents) override {
+            #ifdef PREFERENCES_AVAILABLE
+                return WriteValue(filename, contents, false);
+            #else
+                return false;
             #endif
         }
 
@@ -63,13 +227,16 @@ class ArduinoFileManager final : public IFileManager {
         // Delete: Delete a file with the given filename
         Bool Delete(CStdString& filename) override {
             #ifdef PREFERENCES_AVAILABLE
-                bool result = preferences.begin("filemanager", false);
+                FileCallScope call(stats, FileCall::Delete);
+                RepositoryLock<RepositoryMutex> lock(mutex);
+                bool result = OpenNamespace(false);
                 if (!result) {
                     return false;
                 }
                 
+                RemoveChunks(filename.c_str());
                 bool deleted = preferences.remove(filename.c_str());
-                preferences.end();
+                CloseNamespace();
                 
                 return deleted;
             #else
@@ -79,30 +246,188 @@ class ArduinoFileManager final : public IFileManager {
 
         // Append: Append contents to an existing file (creates file if it doesn't exist)
         Bool Append(CStdString& filename, CStdString& contents) override {
+            return Append(filename.c_str(), std::string_view(contents));
+        }
+
+        // Append: Append a view of the contents to a key (creates it if it doesn't exist)
+        // NVS can't append in place, so only the last chunk is rewritten; once it would outgrow
+        // ARDUINO_FILE_MANAGER_CHUNK_BYTES the contents start a new chunk instead
+        Bool Append(const char* filename, std::string_view contents) override {
             #ifdef PREFERENCES_AVAILABLE
-                bool result = preferences.begin("filemanager", false);
+                FileCallScope call(stats, FileCall::Append);
+                call.Bytes(contents.length());
+                RepositoryLock<RepositoryMutex> lock(mutex);
+                bool result = OpenNamespace(false);
                 if (!result) {
                     return false;
                 }
                 
-                // Read existing content
-                String arduinoString = preferences.getString(filename.c_str(), "");
-                StdString existingContent = StdString(arduinoString.c_str());
-                
-                // Append new content
-                StdString newContent = existingContent + contents;
+                // Read the last chunk
+                uint16_t chunks = GetChunkCount(filename);
+                char lastKey[ARDUINO_FILE_MANAGER_MAX_KEY_LENGTH + 1];
+                const char* last = filename;
+                if (chunks > 0 && ChunkKey(filename, chunks, lastKey)) {
+                    last = lastKey;
+                }
+                StdString newContent;
+                GetValue(last, newContent);
                 
-                // Write back
-                size_t bytesWritten = preferences.putString(filename.c_str(), newContent.c_str());
-                preferences.end();
+                size_t bytesWritten = 0;
+                char nextKey[ARDUINO_FILE_MANAGER_MAX_KEY_LENGTH + 1];
+                char countKey[ARDUINO_FILE_MANAGER_MAX_KEY_LENGTH + 1];
+                bool startChunk = !newContent.empty() &&
+                                  newContent.length() + contents.length() > ARDUINO_FILE_MANAGER_CHUNK_BYTES &&
+                                  chunks < UINT16_MAX &&
+                                  ChunkKey(filename, chunks + 1, nextKey) && ChunkCountKey(filename, countKey);
+                if (startChunk) {
+                    // Write the contents as a new chunk, then publish it in the chunk count
+                    bytesWritten = PutValue(nextKey, contents, false);
+                    if (bytesWritten > 0 && preferences.putUShort(countKey, chunks + 1) == 0) {
+                        bytesWritten = 0;
+                    }
+                } else {
+                    // Extend the last chunk in place
+                    newContent.append(contents.data(), contents.length());
+                    bytesWritten = PutValue(last, newContent, true);
+                }
+                CloseNamespace();
                 
                 return bytesWritten > 0;
             #else
                 return false;
             #endif
         }
+
+        // WriteRange: Overwrite bytes of a value in place, starting at offset
+        // Only the chunks the range falls in are read and rewritten (e.g. one IDs file tombstone rewrites
+        // one chunk of at most ARDUINO_FILE_MANAGER_CHUNK_BYTES, not the whole value); false if the
+        // value doesn't reach offset + contents.length()
+        Bool WriteRange(CStdString& filename, size_t offset, std::string_view contents) override {
+            #ifdef PREFERENCES_AVAILABLE
+                FileCallScope call(stats, FileCall::Write);
+                call.Bytes(contents.length());
+                RepositoryLock<RepositoryMutex> lock(mutex);
+                bool result = OpenNamespace(false);
+                if (!result) {
+                    return false;
+                }
+                
+                // Chunk keys and their sizes, checking the range fits before anything is written
+                const char* key = filename.c_str();
+                uint16_t chunks = GetChunkCount(key);
+                Vector<StdString> keys;
+                Vector<size_t> sizes;
+                size_t total = 0;
+                char chunkKey[ARDUINO_FILE_MANAGER_MAX_KEY_LENGTH + 1];
+                for (unsigned int i = 0; i <= chunks; i++) {
+                    if (i > 0 && !ChunkKey(key, i, chunkKey)) {
+                        continue;
+                    }
+                    keys.push_back(StdString(i == 0 ? key : chunkKey));
+                    sizes.push_back(GetValueSize(keys.back().c_str()));
+                    total += sizes.back();
+                }
+                if (offset > total || contents.length() > total - offset) {
+                    CloseNamespace();
+                    return false;
+                }
+                
+                // Patch each chunk the range overlaps
+                bool written = true;
+                size_t chunkStart = 0;
+                size_t end = offset + contents.length();
+                StdString chunk;
+                for (size_t i = 0; i < keys.size() && chunkStart < end && written; i++) {
+                    size_t chunkEnd = chunkStart + sizes[i];
+                    if (chunkEnd > offset) {
+                        size_t from = offset > chunkStart ? offset : chunkStart;
+                        size_t to = end < chunkEnd ? end : chunkEnd;
+                        GetValue(keys[i].c_str(), chunk);
+                        chunk.replace(from - chunkStart, to - from, contents.data() + (from - offset), to - from);
+                        written = PutValue(keys[i].c_str(), chunk, true) > 0;
+                    }
+                    chunkStart = chunkEnd;
+                }
+                CloseNamespace();
+                
+                return written;
+            #else
+                return false;
+            #endif
+        }
+
+        // Exists: Check if a key exists without reading its value
+        Bool Exists(CStdString& filename) override {
+            #ifdef PREFERENCES_AVAILABLE
+                FileCallScope call(stats, FileCall::Lookup);
+                RepositoryLock<RepositoryMutex> lock(mutex);
+                bool result = OpenNamespace(true); // true = read-only
+                if (!result) {
+                    return false;
+                }
+                
+                bool exists = preferences.isKey(filename.c_str());
+                CloseNamespace();
+                
+                return exists;
+            #else
+                return false;
+            #endif
+        }
+
+        // Size: Size of a value in bytes, over all of its chunks (0 if it doesn't exist)
+        // Blobs report their length directly, strings have to be read
+        size_t Size(CStdString& filename) override {
+            #ifdef PREFERENCES_AVAILABLE
+                FileCallScope call(stats, FileCall::Lookup);
+                RepositoryLock<RepositoryMutex> lock(mutex);
+                bool result = OpenNamespace(true); // true = read-only
+                if (!result) {
+                    return 0;
+                }
+                
+                size_t size = GetValueSize(filename.c_str());
+                uint16_t chunks = GetChunkCount(filename.c_str());
+                char chunkKey[ARDUINO_FILE_MANAGER_MAX_KEY_LENGTH + 1];
+                for (unsigned int i = 1; i <= chunks; i++) {
+                    if (ChunkKey(filename.c_str(), i, chunkKey)) {
+                        size += GetValueSize(chunkKey);
+                    }
+                }
+                CloseNamespace();
+                
+                return size;
+            #else
+                return 0;
+            #endif
+        }
+
+        // BeginSession: Open the namespace read-write once for a group of operations
+        Void BeginSession() override {
+            #ifdef PREFERENCES_AVAILABLE
+                RepositoryLock<RepositoryMutex> lock(mutex);
+                if (sessionDepth++ == 0) {
+                    sessionOpen = preferences.begin("filemanager", false);
+                }
+            #endif
+        }
+
+        // EndSession: Close the namespace when the outermost session ends
+        Void EndSession() override {
+            #ifdef PREFERENCES_AVAILABLE
+                RepositoryLock<RepositoryMutex> lock(mutex);
+                if (sessionDepth == 0) {
+                    return;
+                }
+                if (--sessionDepth == 0 && sessionOpen) {
+                    sessionOpen = false;
+                    preferences.end();
+                }
+            #endif
+        }
 };
 
-#endif // ARDUINO
 #endif // ARDUINO_FILE_MANAGER_H
+#endif // FILE_MANAGER_LITTLEFS
+#endif // ARDUINO
 
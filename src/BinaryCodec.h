@@ -0,0 +1,205 @@
+#ifndef _BINARY_CODEC_H_
+#define _BINARY_CODEC_H_
+
+#include <StandardDefines.h>
+#include <cstdint>
+#include <cstring>
+
+// Compact binary record format used by entities annotated with /* @BinaryStorage */
+// Layout: <magic><field>*  where every field is <key varint><value>
+// key = (tag << 3) | wire type, tags are fixed per field (declaration order, starting at 1)
+// Absent (nullopt) fields are not written, unknown tags are skipped so fields can be appended later.
+#define BINARY_CODEC_MAGIC '\xB1'
+
+#define BINARY_WIRE_VARINT 0
+#define BINARY_WIRE_FIXED64 1
+#define BINARY_WIRE_BYTES 2
+#define BINARY_WIRE_FIXED32 5
+
+// One decoded field, valid until the reader's input goes away
+struct BinaryField {
+    uint32_t tag = 0;
+    uint8_t wireType = BINARY_WIRE_VARINT;
+    uint64_t bits = 0;              // varint / fixed32 / fixed64 payload
+    const char* data = nullptr;     // bytes payload
+    size_t size = 0;
+
+    template<typename T>
+    T AsInt() const {
+        // Zigzag decoding (small negative numbers stay small on the wire)
+        int64_t value = static_cast<int64_t>(bits >> 1) ^ -static_cast<int64_t>(bits & 1);
+        return static_cast<T>(value);
+    }
+
+    Bool AsBool() const {
+        return bits != 0;
+    }
+
+    float AsFloat() const {
+        uint32_t raw = static_cast<uint32_t>(bits);
+        float value;
+        std::memcpy(&value, &raw, sizeof(value));
+        return value;
+    }
+
+    double AsDouble() const {
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    StdString AsString() const {
+        return StdString(data, size);
+    }
+};
+
+// Builds one binary record
+class BinaryWriter {
+    Private StdString buffer;
+
+    Public BinaryWriter() {
+        buffer += BINARY_CODEC_MAGIC;
+    }
+
+    Public template<typename T>
+    Void WriteInt(uint32_t tag, T value) {
+        int64_t wide = static_cast<int64_t>(value);
+        WriteKey(tag, BINARY_WIRE_VARINT);
+        WriteVarint((static_cast<uint64_t>(wide) << 1) ^ static_cast<uint64_t>(wide >> 63));
+    }
+
+    Public Void WriteBool(uint32_t tag, Bool value) {
+        WriteKey(tag, BINARY_WIRE_VARINT);
+        WriteVarint(value ? 1 : 0);
+    }
+
+    Public Void WriteFloat(uint32_t tag, float value) {
+        uint32_t raw;
+        std::memcpy(&raw, &value, sizeof(raw));
+        WriteKey(tag, BINARY_WIRE_FIXED32);
+        WriteFixed(raw, 4);
+    }
+
+    Public Void WriteDouble(uint32_t tag, double value) {
+        uint64_t raw;
+        std::memcpy(&raw, &value, sizeof(raw));
+        WriteKey(tag, BINARY_WIRE_FIXED64);
+        WriteFixed(raw, 8);
+    }
+
+    Public Void WriteString(uint32_t tag, CStdString& value) {
+        WriteKey(tag, BINARY_WIRE_BYTES);
+        WriteVarint(value.length());
+        buffer.append(value.data(), value.length());
+    }
+
+    // Hand over the encoded record (the writer must not be used afterwards)
+    Public StdString Release() {
+        return std::move(buffer);
+    }
+
+    Private Void WriteKey(uint32_t tag, uint8_t wireType) {
+        WriteVarint((static_cast<uint64_t>(tag) << 3) | wireType);
+    }
+
+    Private Void WriteVarint(uint64_t value) {
+        while (value >= 0x80) {
+            buffer += static_cast<char>((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        buffer += static_cast<char>(value);
+    }
+
+    Private Void WriteFixed(uint64_t value, int bytes) {
+        // Little endian regardless of the host
+        for (int i = 0; i < bytes; i++) {
+            buffer += static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+    }
+};
+
+// Walks the fields of one binary record
+class BinaryReader {
+    Private const StdString& input;
+    Private size_t position = 1;
+    Private Bool ok = true;
+
+    Public explicit BinaryReader(const StdString& record) : input(record) {
+        ok = IsBinaryRecord(record);
+    }
+
+    // Check whether stored contents are a binary record (as opposed to JSON)
+    Public Static Bool IsBinaryRecord(const StdString& contents) {
+        return !contents.empty() && contents[0] == BINARY_CODEC_MAGIC;
+    }
+
+    // Read the next field. Returns false at the end of the record or when it is corrupt (see Ok())
+    Public Bool Next(BinaryField& field) {
+        if (!ok || position >= input.length()) {
+            return false;
+        }
+
+        uint64_t key = 0;
+        if (!ReadVarint(key)) {
+            return Fail();
+        }
+        field.tag = static_cast<uint32_t>(key >> 3);
+        field.wireType = static_cast<uint8_t>(key & 0x07);
+
+        switch (field.wireType) {
+            case BINARY_WIRE_VARINT:
+                return ReadVarint(field.bits) || Fail();
+            case BINARY_WIRE_FIXED32:
+                return ReadFixed(field.bits, 4) || Fail();
+            case BINARY_WIRE_FIXED64:
+                return ReadFixed(field.bits, 8) || Fail();
+            case BINARY_WIRE_BYTES: {
+                uint64_t size = 0;
+                if (!ReadVarint(size) || size > input.length() - position) {
+                    return Fail();
+                }
+                field.data = input.data() + position;
+                field.size = static_cast<size_t>(size);
+                position += field.size;
+                return true;
+            }
+            default:
+                return Fail();
+        }
+    }
+
+    // False if the record was truncated or malformed
+    Public Bool Ok() const {
+        return ok;
+    }
+
+    Private Bool Fail() {
+        ok = false;
+        return false;
+    }
+
+    Private Bool ReadVarint(uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && position < input.length(); shift += 7) {
+            uint8_t byte = static_cast<uint8_t>(input[position++]);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Private Bool ReadFixed(uint64_t& value, int bytes) {
+        if (input.length() - position < static_cast<size_t>(bytes)) {
+            return false;
+        }
+        value = 0;
+        for (int i = 0; i < bytes; i++) {
+            value |= static_cast<uint64_t>(static_cast<uint8_t>(input[position++])) << (8 * i);
+        }
+        return true;
+    }
+};
+
+#endif // _BINARY_CODEC_H_
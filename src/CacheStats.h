@@ -0,0 +1,16 @@
+#ifndef _CACHE_STATS_H_
+#define _CACHE_STATS_H_
+
+#include <StandardDefines.h>
+#include <cstddef>
+
+// Entity cache counters reported by CpaRepository::GetCacheStats()
+struct CacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t size = 0;
+    size_t capacity = 0;
+};
+
+#endif // _CACHE_STATS_H_
@@ -0,0 +1,150 @@
+#ifndef _CODEC_ARENA_H_
+#define _CODEC_ARENA_H_
+
+#include <StandardDefines.h>
+#include <ArduinoJson.h>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+// Smallest and largest block the arena keeps for reuse; larger requests go straight to the heap
+#ifndef CODEC_ARENA_MIN_BLOCK
+#define CODEC_ARENA_MIN_BLOCK 32
+#endif
+
+#ifndef CODEC_ARENA_MAX_BLOCK
+#define CODEC_ARENA_MAX_BLOCK 4096
+#endif
+
+// Most bytes one arena keeps in its free lists; blocks released beyond that are freed
+#ifndef CODEC_ARENA_RETAINED_BYTES
+#define CODEC_ARENA_RETAINED_BYTES 16384
+#endif
+
+// Number of pooled block sizes (powers of two from CODEC_ARENA_MIN_BLOCK to CODEC_ARENA_MAX_BLOCK)
+constexpr size_t CodecArenaSizeClasses() {
+    size_t count = 1;
+    for (size_t size = CODEC_ARENA_MIN_BLOCK; size < CODEC_ARENA_MAX_BLOCK; size <<= 1) {
+        count++;
+    }
+    return count;
+}
+
+// ArduinoJson allocator behind the JsonDocuments of generated Serialize()/Deserialize() methods
+// A document's memory goes back to per-size free lists when it is destroyed, and the next record's
+// document is built from those blocks, so decoding a table of records doesn't allocate and free the
+// same pools over and over (heap fragmentation on long-running nodes). Blocks are rounded up to a
+// power of two, and a block keeps its size when ArduinoJson shrinks it after parsing.
+// One arena per thread (Local()); an arena must not be shared between threads.
+class CodecArena final : public ArduinoJson::Allocator {
+    Private struct alignas(std::max_align_t) BlockHeader {
+        size_t capacity;
+        BlockHeader* next;
+    };
+
+    Private Static constexpr size_t ClassCount = CodecArenaSizeClasses();
+
+    Private BlockHeader* freeLists[ClassCount] = {};
+    Private size_t retainedBytes = 0;
+
+    Public CodecArena() = default;
+    Public CodecArena(const CodecArena&) = delete;
+    Public CodecArena& operator=(const CodecArena&) = delete;
+
+    Public ~CodecArena() {
+        Release();
+    }
+
+    // Arena of the calling thread
+    Public Static CodecArena& Local() {
+        static thread_local CodecArena arena;
+        return arena;
+    }
+
+    Public void* allocate(size_t size) override {
+        size_t sizeClass = ClassOf(size);
+        BlockHeader* block = nullptr;
+        if (sizeClass < ClassCount && freeLists[sizeClass] != nullptr) {
+            block = freeLists[sizeClass];
+            freeLists[sizeClass] = block->next;
+            retainedBytes -= block->capacity;
+            return block + 1;
+        }
+
+        size_t capacity = sizeClass < ClassCount ? CapacityOf(sizeClass) : size;
+        block = static_cast<BlockHeader*>(std::malloc(sizeof(BlockHeader) + capacity));
+        if (block == nullptr) {
+            return nullptr;
+        }
+        block->capacity = capacity;
+        return block + 1;
+    }
+
+    Public void deallocate(void* pointer) override {
+        if (pointer == nullptr) {
+            return;
+        }
+        BlockHeader* block = static_cast<BlockHeader*>(pointer) - 1;
+        size_t sizeClass = ClassOf(block->capacity);
+        if (sizeClass < ClassCount && retainedBytes + block->capacity <= CODEC_ARENA_RETAINED_BYTES) {
+            block->next = freeLists[sizeClass];
+            freeLists[sizeClass] = block;
+            retainedBytes += block->capacity;
+            return;
+        }
+        std::free(block);
+    }
+
+    // Blocks that already hold size bytes are kept; otherwise the contents move to a larger block
+    Public void* reallocate(void* pointer, size_t size) override {
+        if (pointer == nullptr) {
+            return allocate(size);
+        }
+        BlockHeader* block = static_cast<BlockHeader*>(pointer) - 1;
+        if (size <= block->capacity) {
+            return pointer;
+        }
+        void* moved = allocate(size);
+        if (moved == nullptr) {
+            return nullptr;
+        }
+        std::memcpy(moved, pointer, block->capacity);
+        deallocate(pointer);
+        return moved;
+    }
+
+    // Free all blocks kept for reuse (documents still alive keep theirs)
+    Public Void Release() {
+        for (size_t i = 0; i < ClassCount; i++) {
+            while (freeLists[i] != nullptr) {
+                BlockHeader* block = freeLists[i];
+                freeLists[i] = block->next;
+                std::free(block);
+            }
+        }
+        retainedBytes = 0;
+    }
+
+    // Bytes currently kept in the free lists
+    Public size_t RetainedBytes() const {
+        return retainedBytes;
+    }
+
+    // Size class holding size bytes, ClassCount for sizes the arena doesn't pool
+    Private Static size_t ClassOf(size_t size) {
+        size_t sizeClass = 0;
+        for (size_t capacity = CODEC_ARENA_MIN_BLOCK; capacity < size; capacity <<= 1) {
+            if (capacity >= CODEC_ARENA_MAX_BLOCK) {
+                return ClassCount;
+            }
+            sizeClass++;
+        }
+        return sizeClass;
+    }
+
+    Private Static size_t CapacityOf(size_t sizeClass) {
+        return static_cast<size_t>(CODEC_ARENA_MIN_BLOCK) << sizeClass;
+    }
+};
+
+#endif // _CODEC_ARENA_H_
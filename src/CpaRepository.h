@@ -2,6 +2,9 @@
 #define _JPA_REPOSITORY_H_
 
 #include <StandardDefines.h>
+#include "CacheStats.h"
+#include "RepositoryStats.h"
+#include <functional>
 
 template<typename Entity, typename ID>
 class CpaRepository {
@@ -16,6 +19,17 @@ class CpaRepository {
     // Read: Find all entities
     Public Virtual Vector<Entity> FindAll() = 0;
 
+    // Read: Find one page of entities in FindAll() order, skipping offset and returning at most limit
+    // Only the requested IDs are decoded
+    Public Virtual Vector<Entity> FindAll(size_t offset, size_t limit) = 0;
+
+    // Read: Find one page of entities ordered by less (one scan, holding at most offset + limit entities)
+    Public Virtual Vector<Entity> FindAll(size_t offset, size_t limit, std::function<Bool(const Entity&, const Entity&)> less) = 0;
+
+    // Read: Visit all entities one at a time without materializing the table
+    // Return false from the visitor to stop early
+    Public Virtual Void ForEach(std::function<Bool(const Entity&)> visitor) = 0;
+
     // Update: Update an existing entity
     Public Virtual Entity Update(Entity& entity) = 0;
 
@@ -27,6 +41,77 @@ class CpaRepository {
 
     // Check if entity exists by ID
     Public Virtual Bool ExistsById(ID id) = 0;
+
+    // Create: Save several entities (the IDs file is written at most once per batch)
+    Public Virtual Vector<Entity> SaveAll(Vector<Entity>& entities) = 0;
+
+    // Read: Find the entities for several IDs (IDs that don't exist are skipped)
+    Public Virtual Vector<Entity> FindAllById(const Vector<ID>& ids) = 0;
+
+    // Delete: Delete several entities by ID (the IDs file is rewritten at most once per batch)
+    Public Virtual Void DeleteAllById(const Vector<ID>& ids) = 0;
+
+    // Set how many entities FindById/ExistsById keep in the LRU cache (0 disables it)
+    Public Virtual Void SetCacheCapacity(size_t capacity) = 0;
+
+    // Entity cache hit/miss counters
+    Public Virtual CacheStats GetCacheStats() = 0;
+
+    // Warm up after boot: load the ID and secondary indexes, then up to maxEntities of the entities
+    // recorded by SavePreloadSet() into the entity cache (most recently used first, 0 loads none)
+    // Entities already cached by requests are kept; preloading stops when the cache is full.
+    Public Virtual Void Preload(size_t maxEntities) = 0;
+
+    // Run Preload() in a background task while the caller goes on serving requests
+    // Only with CPA_REPOSITORY_THREAD_SAFE on a target with threads: otherwise nothing may run alongside
+    // the preload, and PreloadAsync() is exactly Preload(), returning once the cache is warm.
+    Public Virtual Void PreloadAsync(size_t maxEntities) = 0;
+
+    // Persist the IDs of the cached entities, most recently used first, for Preload() after the next boot
+    // Flush() and the repository's destructor also save it while entities are cached, Flush() at most
+    // every CPA_REPOSITORY_PRELOAD_SAVE_INTERVAL_MS. Returns false if the file can't be written.
+    Public Virtual Bool SavePreloadSet() = 0;
+
+    // Queue writes and apply them in the background, coalesced per ID, with at most
+    // maxQueueDepth pending writes (0 flushes the queue and writes synchronously again)
+    Public Virtual Void SetWriteBehind(size_t maxQueueDepth) = 0;
+
+    // Write all queued writes to storage now (no-op unless write-behind is enabled)
+    // Returns false if storage refused any of them; those stay queued for the next flush
+    Public Virtual Bool Flush() = 0;
+
+    // Begin: Start a transaction; Save/Update/Delete calls are buffered until Commit or Rollback
+    // FindById/ExistsById see the buffered writes, scans and queries see committed state only.
+    // Begin inside one is a no-op. With CPA_REPOSITORY_THREAD_SAFE the transaction holds the table's
+    // writer lock until it ends: other threads' operations on the table (and their Begin) wait for it,
+    // so Commit and Rollback must be called from the thread that called Begin. Without it a repository
+    // is used by one thread and its transaction is simply the repository's. Don't call SetWriteBehind
+    // while a transaction is open.
+    Public Virtual Void Begin() = 0;
+
+    // Commit: Write the buffered writes to a journal, then apply them in one pass and drop the journal
+    // A journal left by a crash is replayed by the next repository to use the table, and one storage
+    // refused to apply is kept and replayed by the next operation; either way the commit stands.
+    // Returns false if the journal can't be written: nothing is applied and the transaction stays open
+    // with its writes, so Commit can be retried or the transaction rolled back. It also returns false
+    // while an earlier commit's journal still waits for its replay.
+    Public Virtual Bool Commit() = 0;
+
+    // Rollback: Discard the buffered writes and end the transaction
+    Public Virtual Void Rollback() = 0;
+
+    // Number of storage key hash collisions detected (needs CPA_REPOSITORY_KEY_CHECK, otherwise 0)
+    Public Virtual size_t GetKeyCollisions() = 0;
+
+    // Number of saves and deletes storage refused; a refused write leaves the entity's previous state
+    Public Virtual size_t GetWriteFailures() = 0;
+
+    // Per-operation counts and latencies, storage calls and bytes, codec time and cache counters
+    // (everything but the cache counters needs CPA_REPOSITORY_STATS, see RepositoryStats.h)
+    Public Virtual RepositoryStats GetStats() = 0;
+
+    // Zero the counters returned by GetStats()
+    Public Virtual Void ResetStats() = 0;
 };
 
 #endif // _JPA_REPOSITORY_H_
@@ -4,71 +4,533 @@
 #define DESKTOP_FILE_MANAGER
 
 #include "IFileManager.h"
+#include "repository/RepositoryMutex.h"
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <set>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <thread>
 
+// Durability levels of DesktopFileManager writes
+// Every Create/Update/Write goes to "<file>.tmp" and is renamed over the file, so a crash never
+// leaves a half-written entity or IDs file (a failed write removes its temp file, and temp files a
+// crash left behind are removed the first time a directory is written); the level decides when data
+// reaches the disk:
+// CPA_DURABILITY_NONE      - never fsync (survives a process crash, not a power loss)
+// CPA_DURABILITY_BATCH     - writes inside a session (a repository operation or batch) are committed
+//                            together when the thread's outermost session ends: fsync the files, rename
+//                            them into place, fsync each directory once; writes outside a session (or
+//                            from another thread) commit alone
+// CPA_DURABILITY_IMMEDIATE - fsync the file and its directory before every write returns
+#define CPA_DURABILITY_NONE 0
+#define CPA_DURABILITY_BATCH 1
+#define CPA_DURABILITY_IMMEDIATE 2
+
+#ifndef DESKTOP_FILE_MANAGER_DURABILITY
+#define DESKTOP_FILE_MANAGER_DURABILITY CPA_DURABILITY_NONE
+#endif
+
+// Appends (IDs files, log segments) and WriteRange patches stay in place: both formats drop a torn
+// tail on read, and a patch is a few bytes (e.g. one IDs file tombstone)
 /* @Component */
 class DesktopFileManager final : public IFileManager {
+    Private int durability = DESKTOP_FILE_MANAGER_DURABILITY;
+
+    // Batch of one thread's session: writes waiting for the end of its outermost session (file -> temp
+    // file) and files appended to in place that still need an fsync
+    Private struct Batch {
+        int depth = 0;
+        std::map<StdString, StdString> writes;
+        std::set<StdString> syncs;
+        std::set<StdString> directories;
+    };
+
+    // Sessions are tracked per thread, so a write is only deferred into the batch of the thread that
+    // made it; guarded by mutex. The table locks keep two batches from holding the same file.
+    Private RepositoryMutex mutex;
+    Private std::map<std::thread::id, Batch> batches;
+
+    // Directories already swept for temp files left by a crash (guarded by mutex)
+    Private std::set<StdString> sweptDirectories;
+
+    // Commit batches whose session is still open, so their temp files don't outlive the manager
+    Public ~DesktopFileManager() {
+        for (auto& batch : batches) {
+            CommitBatch(batch.second);
+        }
+    }
+
+    // Durability level of later writes (CPA_DURABILITY_*); set it before the manager is shared
+    // between threads. A batch in progress is committed first.
+    Public Void SetDurability(int level) {
+        RepositoryLock<RepositoryMutex> lock(mutex);
+        for (auto& batch : batches) {
+            CommitBatch(batch.second);
+        }
+        batches.clear();
+        durability = level;
+    }
+
     // Create: Create a new file with the given filename and contents
     Public Bool Create(CStdString& filename, CStdString& contents) override {
-        std::ofstream file(filename.c_str(), std::ios::out | std::ios::trunc);
-        if (!file.is_open()) {
-            return false;
-        }
-        file << contents.c_str();
-        file.close();
-        return true;
+        return Write(filename.c_str(), contents);
     }
 
     // Read: Read the contents of a file with the given filename
+    // Binary mode, so records may hold any byte (e.g. /* @BinaryStorage */ entities)
     Public StdString Read(CStdString& filename) override {
-        std::ifstream file(filename.c_str(), std::ios::in);
-        if (!file.is_open()) {
-            return StdString("");
-        }
-        
         StdString contents;
-        std::string line;
-        while (std::getline(file, line)) {
-            contents += StdString(line.c_str());
-            if (!file.eof()) {
-                contents += StdString("\n");
-            }
-        }
-        file.close();
+        Read(filename, contents);
         return contents;
     }
 
+    // Read: Read the contents of a file into a caller-owned buffer
+    Public Bool Read(CStdString& filename, StdString& contents) override {
+        return Read(filename.c_str(), contents);
+    }
+
+    // Read: Read the whole file into a caller-owned buffer (see ReadFile)
+    // A file with an uncommitted batch write is read from its temp file; false if missing or empty
+    Public Bool Read(const char* filename, StdString& contents) override {
+        FileCallScope call(stats, FileCall::Read);
+        return WithCurrentPath(filename, [&contents, &call](const char* path) {
+            Bool found = ReadFile(path, contents);
+            call.Bytes(contents.length());
+            return found && !contents.empty();
+        });
+    }
+
     // Update: Update an existing file with the given filename and new contents
     Public Bool Update(CStdString& filename, CStdString& contents) override {
-        std::ofstream file(filename.c_str(), std::ios::out | std::ios::trunc);
-        if (!file.is_open()) {
+        return Write(filename.c_str(), contents);
+    }
+
+    // Delete: Delete a file with the given filename (and an uncommitted batch write of it)
+    Public Bool Delete(CStdString& filename) override {
+        FileCallScope call(stats, FileCall::Delete);
+        Bool batched = false;
+        if (durability == CPA_DURABILITY_BATCH) {
+            RepositoryLock<RepositoryMutex> lock(mutex);
+            for (auto& batch : batches) {
+                auto pending = batch.second.writes.find(filename);
+                if (pending != batch.second.writes.end()) {
+                    std::remove(pending->second.c_str());
+                    batch.second.writes.erase(pending);
+                }
+                batch.second.syncs.erase(filename);
+            }
+            Batch* batch = CurrentBatch();
+            batched = batch != nullptr;
+            if (batched) {
+                batch->directories.insert(DirectoryOf(filename.c_str()));
+            }
+        }
+        
+        if (std::remove(filename.c_str()) != 0) {
             return false;
         }
-        file << contents.c_str();
-        file.close();
+        if (!batched && durability != CPA_DURABILITY_NONE) {
+            SyncPath(DirectoryOf(filename.c_str()).c_str());
+        }
         return true;
     }
 
-    // Delete: Delete a file with the given filename
-    Public Bool Delete(CStdString& filename) override {
-        if (std::remove(filename.c_str()) == 0) {
+    // Append: Append contents to an existing file (creates file if it doesn't exist)
+    Public Bool Append(CStdString& filename, CStdString& contents) override {
+        return Append(filename.c_str(), std::string_view(contents));
+    }
+
+    // ReadRange: Read length bytes starting at offset (fewer if the file is shorter)
+    Public StdString ReadRange(CStdString& filename, size_t offset, size_t length) override {
+        FileCallScope call(stats, FileCall::Read);
+        StdString contents;
+        WithCurrentPath(filename.c_str(), [&contents, &call, offset, length](const char* path) {
+            contents = ReadFileRange(path, offset, length);
+            call.Bytes(contents.length());
+            return true;
+        });
+        return contents;
+    }
+
+    // Exists: Check if a file with the given filename exists (one stat, the file isn't opened)
+    Public Bool Exists(CStdString& filename) override {
+        FileCallScope call(stats, FileCall::Lookup);
+        return WithCurrentPath(filename.c_str(), [](const char* path) {
+            struct stat info;
+            return stat(path, &info) == 0 && S_ISREG(info.st_mode);
+        });
+    }
+
+    // Size: Size of a file in bytes (0 if it doesn't exist)
+    Public size_t Size(CStdString& filename) override {
+        FileCallScope call(stats, FileCall::Lookup);
+        size_t size = 0;
+        WithCurrentPath(filename.c_str(), [&size](const char* path) {
+            struct stat info;
+            if (stat(path, &info) == 0 && S_ISREG(info.st_mode)) {
+                size = static_cast<size_t>(info.st_size);
+            }
             return true;
+        });
+        return size;
+    }
+
+    // Write: Create or overwrite a file through a temp file renamed over it
+    // Inside a batch the rename waits for the end of the outermost session
+    Public Bool Write(const char* filename, std::string_view contents) override {
+        FileCallScope call(stats, FileCall::Write);
+        call.Bytes(contents.length());
+        StdString tempPath = StdString(filename) + ".tmp";
+        SweepDirectoryOnce(filename);
+        
+        if (durability == CPA_DURABILITY_BATCH) {
+            RepositoryLock<RepositoryMutex> lock(mutex);
+            Batch* batch = CurrentBatch();
+            if (batch != nullptr) {
+                if (!WriteFile(tempPath.c_str(), contents, O_WRONLY | O_CREAT | O_TRUNC, false)) {
+                    // The truncated temp file no longer holds an earlier batch write either
+                    std::remove(tempPath.c_str());
+                    batch->writes.erase(StdString(filename));
+                    return false;
+                }
+                batch->writes[StdString(filename)] = tempPath;
+                batch->syncs.erase(StdString(filename));
+                return true;
+            }
+        }
+        
+        Bool sync = durability != CPA_DURABILITY_NONE;
+        if (!WriteFile(tempPath.c_str(), contents, O_WRONLY | O_CREAT | O_TRUNC, sync)) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+        if (std::rename(tempPath.c_str(), filename) != 0) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+        if (sync) {
+            SyncPath(DirectoryOf(filename).c_str());
+        }
+        return true;
+    }
+
+    // Append: Append the caller's bytes to a file (creates file if it doesn't exist)
+    // A file with an uncommitted batch write is appended to in its temp file
+    Public Bool Append(const char* filename, std::string_view contents) override {
+        FileCallScope call(stats, FileCall::Append);
+        call.Bytes(contents.length());
+        
+        if (durability == CPA_DURABILITY_BATCH) {
+            RepositoryLock<RepositoryMutex> lock(mutex);
+            const StdString* pending = FindPendingWrite(filename);
+            if (pending != nullptr) {
+                return WriteFile(pending->c_str(), contents, O_WRONLY | O_CREAT | O_APPEND, false);
+            }
+            Batch* batch = CurrentBatch();
+            if (batch != nullptr) {
+                Bool created = access(filename, F_OK) != 0;
+                if (!WriteFile(filename, contents, O_WRONLY | O_CREAT | O_APPEND, false)) {
+                    return false;
+                }
+                batch->syncs.insert(StdString(filename));
+                if (created) {
+                    batch->directories.insert(DirectoryOf(filename));
+                }
+                return true;
+            }
+        }
+        
+        Bool sync = durability != CPA_DURABILITY_NONE;
+        Bool created = sync && access(filename, F_OK) != 0;
+        if (!WriteFile(filename, contents, O_WRONLY | O_CREAT | O_APPEND, sync)) {
+            return false;
+        }
+        if (created) {
+            SyncPath(DirectoryOf(filename).c_str());
+        }
+        return true;
+    }
+
+    // WriteRange: Overwrite bytes of an existing file in place (one pwrite, no temp file)
+    // A file with an uncommitted batch write is patched in its temp file
+    Public Bool WriteRange(CStdString& filename, size_t offset, std::string_view contents) override {
+        FileCallScope call(stats, FileCall::Write);
+        call.Bytes(contents.length());
+        
+        if (durability == CPA_DURABILITY_BATCH) {
+            RepositoryLock<RepositoryMutex> lock(mutex);
+            const StdString* pending = FindPendingWrite(filename.c_str());
+            if (pending != nullptr) {
+                return PatchFile(pending->c_str(), offset, contents, false);
+            }
+            Batch* batch = CurrentBatch();
+            if (batch != nullptr) {
+                if (!PatchFile(filename.c_str(), offset, contents, false)) {
+                    return false;
+                }
+                batch->syncs.insert(filename);
+                return true;
+            }
+        }
+        
+        return PatchFile(filename.c_str(), offset, contents, durability != CPA_DURABILITY_NONE);
+    }
+
+    // BeginSession: Start (or join) the calling thread's batch; with CPA_DURABILITY_BATCH its writes
+    // commit together
+    Public Void BeginSession() override {
+        if (durability == CPA_DURABILITY_BATCH) {
+            RepositoryLock<RepositoryMutex> lock(mutex);
+            batches[std::this_thread::get_id()].depth++;
+        }
+    }
+
+    // EndSession: Commit the calling thread's batch when its outermost session ends
+    Public Void EndSession() override {
+        if (durability == CPA_DURABILITY_BATCH) {
+            RepositoryLock<RepositoryMutex> lock(mutex);
+            auto batch = batches.find(std::this_thread::get_id());
+            if (batch != batches.end() && --batch->second.depth == 0) {
+                CommitBatch(batch->second);
+                batches.erase(batch);
+            }
+        }
+    }
+
+    // Run action on the path that currently holds a file's contents: its pending temp file (with the
+    // mutex held, so a commit can't rename it away meanwhile) or the file itself
+    // Only batch durability has pending files; the other levels never lock here
+    Private template<typename Action>
+    Bool WithCurrentPath(const char* filename, Action&& action) {
+        if (durability == CPA_DURABILITY_BATCH) {
+            RepositoryLock<RepositoryMutex> lock(mutex);
+            const StdString* pending = FindPendingWrite(filename);
+            if (pending != nullptr) {
+                return action(pending->c_str());
+            }
+        }
+        return action(filename);
+    }
+
+    // Batch of the calling thread's open session, nullptr outside a session (caller holds mutex)
+    Private Batch* CurrentBatch() {
+        if (batches.empty()) {
+            return nullptr;
+        }
+        auto batch = batches.find(std::this_thread::get_id());
+        return batch == batches.end() ? nullptr : &batch->second;
+    }
+
+    // Temp file holding an uncommitted batch write of a file, in any thread's batch (caller holds mutex)
+    Private const StdString* FindPendingWrite(const char* filename) {
+        if (batches.empty()) {
+            return nullptr;
+        }
+        StdString key(filename);
+        for (const auto& batch : batches) {
+            auto pending = batch.second.writes.find(key);
+            if (pending != batch.second.writes.end()) {
+                return &pending->second;
+            }
+        }
+        return nullptr;
+    }
+
+    // Make a batch durable: fsync every written file, rename the new ones into place, then fsync
+    // each directory once so the renames survive a power loss (caller holds mutex)
+    Private Static Void CommitBatch(Batch& batch) {
+        for (const auto& pending : batch.writes) {
+            SyncPath(pending.second.c_str());
+        }
+        for (const auto& path : batch.syncs) {
+            SyncPath(path.c_str());
+        }
+        for (const auto& pending : batch.writes) {
+            if (std::rename(pending.second.c_str(), pending.first.c_str()) == 0) {
+                batch.directories.insert(DirectoryOf(pending.first.c_str()));
+            } else {
+                std::remove(pending.second.c_str());
+            }
+        }
+        for (const auto& directory : batch.directories) {
+            SyncPath(directory.c_str());
+        }
+        batch.writes.clear();
+        batch.syncs.clear();
+        batch.directories.clear();
+    }
+
+    // Remove the "*.tmp" files a crash left in a file's directory, the first time the directory is written
+    // Temp files of pending batch writes are kept
+    Private Void SweepDirectoryOnce(const char* filename) {
+        StdString directory = DirectoryOf(filename);
+        RepositoryLock<RepositoryMutex> lock(mutex);
+        if (!sweptDirectories.insert(directory).second) {
+            return;
+        }
+        DIR* dir = opendir(directory.c_str());
+        if (dir == nullptr) {
+            return;
+        }
+        while (struct dirent* entry = readdir(dir)) {
+            StdString name(entry->d_name);
+            if (name.length() <= 4 || name.compare(name.length() - 4, 4, ".tmp") != 0) {
+                continue;
+            }
+            StdString path = PathIn(directory, name, filename);
+            if (!IsPendingTempFile(path)) {
+                std::remove(path.c_str());
+            }
+        }
+        closedir(dir);
+    }
+
+    // Check if a temp file belongs to an uncommitted batch write (caller holds mutex)
+    Private Bool IsPendingTempFile(CStdString& tempPath) {
+        for (const auto& batch : batches) {
+            for (const auto& pending : batch.second.writes) {
+                if (pending.second == tempPath) {
+                    return true;
+                }
+            }
         }
         return false;
     }
 
-    // Append: Append contents to an existing file (creates file if it doesn't exist)
-    Public Bool Append(CStdString& filename, CStdString& contents) override {
-        std::ofstream file(filename.c_str(), std::ios::out | std::ios::app);
+    // Read the whole file into a caller-owned buffer with one allocation and one read
+    // The buffer is sized from the file length up front; its capacity is reused across calls
+    Private Static Bool ReadFile(const char* filename, StdString& contents) {
+        contents.clear();
+        std::ifstream file(filename, std::ios::in | std::ios::binary | std::ios::ate);
         if (!file.is_open()) {
             return false;
         }
-        file << contents.c_str();
+
+        std::streamoff size = file.tellg();
+        if (size > 0) {
+            contents.resize(static_cast<size_t>(size));
+            file.seekg(0, std::ios::beg);
+            file.read(&contents[0], static_cast<std::streamsize>(size));
+            contents.resize(static_cast<size_t>(file.gcount()));
+        }
         file.close();
         return true;
     }
 
+    // Read length bytes starting at offset (fewer if the file is shorter)
+    Private Static StdString ReadFileRange(const char* filename, size_t offset, size_t length) {
+        std::ifstream file(filename, std::ios::in | std::ios::binary);
+        if (!file.is_open()) {
+            return StdString("");
+        }
+
+        file.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+        if (!file) {
+            return StdString("");
+        }
+
+        StdString contents(length, '\0');
+        file.read(&contents[0], static_cast<std::streamsize>(length));
+        contents.resize(static_cast<size_t>(file.gcount()));
+        file.close();
+        return contents;
+    }
+
+    // Write contents to a file opened with flags, optionally fsync'ing it before it is closed
+    Private Static Bool WriteFile(const char* filename, std::string_view contents, int flags, Bool sync) {
+        int fd = ::open(filename, flags, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        size_t written = 0;
+        while (written < contents.length()) {
+            ssize_t result = ::write(fd, contents.data() + written, contents.length() - written);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                ::close(fd);
+                return false;
+            }
+            written += static_cast<size_t>(result);
+        }
+        Bool synced = !sync || SyncFd(fd);
+        return ::close(fd) == 0 && synced;
+    }
+
+    // Overwrite bytes of an existing file at offset, refusing ranges past its end
+    Private Static Bool PatchFile(const char* filename, size_t offset, std::string_view contents, Bool sync) {
+        int fd = ::open(filename, O_WRONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || offset > static_cast<size_t>(info.st_size) ||
+            contents.length() > static_cast<size_t>(info.st_size) - offset) {
+            ::close(fd);
+            return false;
+        }
+        size_t written = 0;
+        while (written < contents.length()) {
+            ssize_t result = ::pwrite(fd, contents.data() + written, contents.length() - written,
+                                      static_cast<off_t>(offset + written));
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                ::close(fd);
+                return false;
+            }
+            written += static_cast<size_t>(result);
+        }
+        Bool synced = !sync || SyncFd(fd);
+        return ::close(fd) == 0 && synced;
+    }
+
+    // Flush a file's data to the device (F_FULLFSYNC where fsync stops at the drive cache)
+    Private Static Bool SyncFd(int fd) {
+        #ifdef F_FULLFSYNC
+            if (fcntl(fd, F_FULLFSYNC) == 0) {
+                return true;
+            }
+        #endif
+        return fsync(fd) == 0;
+    }
+
+    // fsync a file or directory by path
+    Private Static Void SyncPath(const char* path) {
+        int fd = ::open(path, O_RDONLY);
+        if (fd >= 0) {
+            SyncFd(fd);
+            ::close(fd);
+        }
+    }
+
+    // Path of an entry of the directory holding filename, spelled like filename (bare names stay bare)
+    Private Static StdString PathIn(CStdString& directory, CStdString& name, const char* filename) {
+        if (std::strchr(filename, '/') == nullptr) {
+            return name;
+        }
+        return directory == "/" ? directory + name : directory + "/" + name;
+    }
+
+    // Directory holding a file ("." for a bare name)
+    Private Static StdString DirectoryOf(const char* filename) {
+        StdString path(filename);
+        size_t slash = path.find_last_of('/');
+        if (slash == StdString::npos) {
+            return StdString(".");
+        }
+        return slash == 0 ? StdString("/") : path.substr(0, slash);
+    }
+
 };
 
 #endif // ARDUINO
@@ -0,0 +1,188 @@
+#ifndef _FILE_MANAGER_COUNTERS_H_
+#define _FILE_MANAGER_COUNTERS_H_
+
+#include "RepositoryStats.h"
+#include <atomic>
+#include <cstdint>
+
+#if CPA_REPOSITORY_STATS
+    #ifdef ARDUINO
+        #include <Arduino.h>
+    #else
+        #include <chrono>
+    #endif
+#endif
+
+// Recording side of the FileManagerStats in RepositoryStats.h, used by IFileManager implementations
+// (repositories build on it in repository/StatsRecorder.h). Every type here exists in both modes so
+// call sites need no #if; with CPA_REPOSITORY_STATS == 0 they hold nothing and their methods are empty.
+
+// Kinds of file manager call
+enum class FileCall : uint8_t {
+    Read,
+    Write,
+    Append,
+    Delete,
+    Lookup
+};
+
+#if CPA_REPOSITORY_STATS
+// Monotonic clock of the counters
+class StatsClock {
+    Public Static uint64_t Nanos() {
+        #ifdef ARDUINO
+            return static_cast<uint64_t>(micros()) * 1000;
+        #else
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        #endif
+    }
+};
+
+// Running totals of the calling thread; an operation's share is the difference across it
+class ThreadStats {
+    Public Static FileManagerStats& Storage() {
+        static thread_local FileManagerStats storage;
+        return storage;
+    }
+
+    Public Static uint64_t& CodecNanos() {
+        static thread_local uint64_t nanos = 0;
+        return nanos;
+    }
+
+    Public Static Void Add(FileManagerStats& target, const FileManagerStats& delta) {
+        target.reads += delta.reads;
+        target.writes += delta.writes;
+        target.appends += delta.appends;
+        target.deletes += delta.deletes;
+        target.lookups += delta.lookups;
+        target.bytesRead += delta.bytesRead;
+        target.bytesWritten += delta.bytesWritten;
+        target.nanos += delta.nanos;
+    }
+
+    Public Static FileManagerStats Since(const FileManagerStats& before) {
+        const FileManagerStats& now = Storage();
+        FileManagerStats delta;
+        delta.reads = now.reads - before.reads;
+        delta.writes = now.writes - before.writes;
+        delta.appends = now.appends - before.appends;
+        delta.deletes = now.deletes - before.deletes;
+        delta.lookups = now.lookups - before.lookups;
+        delta.bytesRead = now.bytesRead - before.bytesRead;
+        delta.bytesWritten = now.bytesWritten - before.bytesWritten;
+        delta.nanos = now.nanos - before.nanos;
+        return delta;
+    }
+};
+#endif
+
+// FileManagerStats shared between threads
+class FileManagerCounters {
+    #if CPA_REPOSITORY_STATS
+    Private std::atomic<size_t> reads{0};
+    Private std::atomic<size_t> writes{0};
+    Private std::atomic<size_t> appends{0};
+    Private std::atomic<size_t> deletes{0};
+    Private std::atomic<size_t> lookups{0};
+    Private std::atomic<uint64_t> bytesRead{0};
+    Private std::atomic<uint64_t> bytesWritten{0};
+    Private std::atomic<uint64_t> nanos{0};
+    #endif
+
+    Public Void Add(const FileManagerStats& delta) {
+        #if CPA_REPOSITORY_STATS
+            reads.fetch_add(delta.reads, std::memory_order_relaxed);
+            writes.fetch_add(delta.writes, std::memory_order_relaxed);
+            appends.fetch_add(delta.appends, std::memory_order_relaxed);
+            deletes.fetch_add(delta.deletes, std::memory_order_relaxed);
+            lookups.fetch_add(delta.lookups, std::memory_order_relaxed);
+            bytesRead.fetch_add(delta.bytesRead, std::memory_order_relaxed);
+            bytesWritten.fetch_add(delta.bytesWritten, std::memory_order_relaxed);
+            nanos.fetch_add(delta.nanos, std::memory_order_relaxed);
+        #else
+            (void)delta;
+        #endif
+    }
+
+    Public FileManagerStats Snapshot() const {
+        FileManagerStats stats;
+        #if CPA_REPOSITORY_STATS
+            stats.reads = reads.load(std::memory_order_relaxed);
+            stats.writes = writes.load(std::memory_order_relaxed);
+            stats.appends = appends.load(std::memory_order_relaxed);
+            stats.deletes = deletes.load(std::memory_order_relaxed);
+            stats.lookups = lookups.load(std::memory_order_relaxed);
+            stats.bytesRead = bytesRead.load(std::memory_order_relaxed);
+            stats.bytesWritten = bytesWritten.load(std::memory_order_relaxed);
+            stats.nanos = nanos.load(std::memory_order_relaxed);
+        #endif
+        return stats;
+    }
+
+    Public Void Reset() {
+        #if CPA_REPOSITORY_STATS
+            reads = 0;
+            writes = 0;
+            appends = 0;
+            deletes = 0;
+            lookups = 0;
+            bytesRead = 0;
+            bytesWritten = 0;
+            nanos = 0;
+        #endif
+    }
+};
+
+// Times one file manager call and adds it to the manager's counters and the calling thread's totals
+// Placed in the methods that reach storage, not in the overloads that forward to them
+class FileCallScope {
+    #if CPA_REPOSITORY_STATS
+    Private FileManagerCounters& counters;
+    Private FileCall call;
+    Private uint64_t start;
+    Private uint64_t bytes = 0;
+    #endif
+
+    Public FileCallScope(FileManagerCounters& target, FileCall kind)
+    #if CPA_REPOSITORY_STATS
+        : counters(target), call(kind), start(StatsClock::Nanos())
+    #endif
+    {
+        #if !CPA_REPOSITORY_STATS
+            (void)target;
+            (void)kind;
+        #endif
+    }
+
+    // Bytes moved by the call (read for Read, written for Write/Append)
+    Public Void Bytes(size_t count) {
+        #if CPA_REPOSITORY_STATS
+            bytes = count;
+        #else
+            (void)count;
+        #endif
+    }
+
+    Public ~FileCallScope() {
+        #if CPA_REPOSITORY_STATS
+            FileManagerStats delta;
+            switch (call) {
+                case FileCall::Read: delta.reads = 1; delta.bytesRead = bytes; break;
+                case FileCall::Write: delta.writes = 1; delta.bytesWritten = bytes; break;
+                case FileCall::Append: delta.appends = 1; delta.bytesWritten = bytes; break;
+                case FileCall::Delete: delta.deletes = 1; break;
+                case FileCall::Lookup: delta.lookups = 1; break;
+            }
+            delta.nanos = StatsClock::Nanos() - start;
+            counters.Add(delta);
+            ThreadStats::Add(ThreadStats::Storage(), delta);
+        #endif
+    }
+
+    Public FileCallScope(const FileCallScope&) = delete;
+    Public FileCallScope& operator=(const FileCallScope&) = delete;
+};
+
+#endif // _FILE_MANAGER_COUNTERS_H_
@@ -0,0 +1,27 @@
+#ifndef _FILE_MANAGER_SESSION_H_
+#define _FILE_MANAGER_SESSION_H_
+
+#include "IFileManager.h"
+
+// RAII scope that holds a file manager session open for a group of operations
+// e.g. ArduinoFileManager keeps its Preferences namespace open instead of opening it per call
+class FileManagerSession {
+    Private IFileManagerPtr fileManager;
+
+    Public explicit FileManagerSession(IFileManagerPtr manager) : fileManager(manager) {
+        if (fileManager) {
+            fileManager->BeginSession();
+        }
+    }
+
+    Public ~FileManagerSession() {
+        if (fileManager) {
+            fileManager->EndSession();
+        }
+    }
+
+    Public FileManagerSession(const FileManagerSession&) = delete;
+    Public FileManagerSession& operator=(const FileManagerSession&) = delete;
+};
+
+#endif // _FILE_MANAGER_SESSION_H_
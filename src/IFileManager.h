@@ -2,6 +2,8 @@
 #define _IFILEMANAGER_H_
 
 #include <StandardDefines.h>
+#include <string_view>
+#include "FileManagerCounters.h"
 
 DefineStandardPointers(IFileManager)
 class IFileManager {
@@ -13,6 +15,14 @@ class IFileManager {
     // Read: Read the contents of a file with the given filename
     Public Virtual StdString Read(CStdString& filename) = 0;
 
+    // Read: Read the contents of a file into a caller-owned buffer, reusing its capacity
+    // Returns false if the file doesn't exist or is empty (key-value storage can't tell the two apart)
+    // The default copies the result of Read(filename)
+    Public Virtual Bool Read(CStdString& filename, StdString& contents) {
+        contents = Read(filename);
+        return !contents.empty();
+    }
+
     // Update: Update an existing file with the given filename and new contents
     Public Virtual Bool Update(CStdString& filename, CStdString& contents) = 0;
 
@@ -21,6 +31,80 @@ class IFileManager {
 
     // Append: Append contents to an existing file (creates file if it doesn't exist)
     Public Virtual Bool Append(CStdString& filename, CStdString& contents) = 0;
+
+    // Read: Read a file into a caller-owned buffer, addressed by a C string (no filename copy)
+    // The default copies the filename once; implementations override it to avoid that
+    Public Virtual Bool Read(const char* filename, StdString& contents) {
+        return Read(StdString(filename), contents);
+    }
+
+    // Write: Create or overwrite a file from a view of the contents (e.g. part of a larger buffer)
+    // The default copies both arguments and calls Create; implementations override it to write in place
+    Public Virtual Bool Write(const char* filename, std::string_view contents) {
+        return Create(StdString(filename), StdString(contents));
+    }
+
+    // Append: Append a view of the contents to a file (creates file if it doesn't exist)
+    // The default copies both arguments and calls Append; implementations override it to write in place
+    Public Virtual Bool Append(const char* filename, std::string_view contents) {
+        return Append(StdString(filename), StdString(contents));
+    }
+
+    // ReadRange: Read length bytes starting at offset (fewer if the file is shorter)
+    // The default reads the whole file; implementations with seekable storage override it
+    Public Virtual StdString ReadRange(CStdString& filename, size_t offset, size_t length) {
+        StdString contents = Read(filename);
+        if (offset >= contents.length()) {
+            return StdString("");
+        }
+        return contents.substr(offset, length);
+    }
+
+    // WriteRange: Overwrite bytes of an existing file in place, starting at offset
+    // Returns false if the file doesn't reach offset + contents.length(). The default reads the file,
+    // patches it and rewrites it; implementations with seekable storage override it
+    Public Virtual Bool WriteRange(CStdString& filename, size_t offset, std::string_view contents) {
+        StdString existing = Read(filename);
+        if (offset > existing.length() || contents.length() > existing.length() - offset) {
+            return false;
+        }
+        existing.replace(offset, contents.length(), contents.data(), contents.length());
+        return Create(filename, existing);
+    }
+
+    // Exists: Check if a file with the given filename exists
+    // The default reads the file; implementations override it with a metadata lookup
+    Public Virtual Bool Exists(CStdString& filename) {
+        return !Read(filename).empty();
+    }
+
+    // Size: Size of a file in bytes (0 if it doesn't exist)
+    // The default reads the file; implementations override it with a metadata lookup
+    Public Virtual size_t Size(CStdString& filename) {
+        return Read(filename).length();
+    }
+
+    // BeginSession: Keep the underlying storage open until the matching EndSession
+    // Sessions nest; only the outermost pair opens and closes the storage. Prefer FileManagerSession.
+    Public Virtual Void BeginSession() {
+    }
+
+    // EndSession: Close the storage opened by the outermost BeginSession
+    Public Virtual Void EndSession() {
+    }
+
+    // GetStats: Calls, bytes and time of this file manager (all zero unless CPA_REPOSITORY_STATS is enabled)
+    Public Virtual FileManagerStats GetStats() {
+        return stats.Snapshot();
+    }
+
+    // ResetStats: Zero the counters returned by GetStats
+    Public Virtual Void ResetStats() {
+        stats.Reset();
+    }
+
+    // Counters implementations feed with a FileCallScope in each method that reaches storage
+    Protected FileManagerCounters stats;
 };
 
 #endif // _IFILEMANAGER_H_
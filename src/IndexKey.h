@@ -0,0 +1,32 @@
+#ifndef _INDEX_KEY_H_
+#define _INDEX_KEY_H_
+
+#include <StandardDefines.h>
+#include <optional>
+#include <string>
+#include <type_traits>
+
+// Key under which a field value is stored in a secondary index (/* @Indexed */ fields)
+// Entities build keys from their fields and generated FindBy methods from their parameter,
+// so both sides must go through these functions.
+template<typename T>
+StdString IndexKeyOf(const T& value) {
+    if constexpr (std::is_same_v<T, bool>) {
+        return value ? StdString("1") : StdString("0");
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        return std::to_string(value);
+    } else {
+        return StdString(value);
+    }
+}
+
+// Absent values are not indexed
+template<typename T>
+optional<StdString> IndexKeyOf(const optional<T>& value) {
+    if (!value.has_value()) {
+        return std::nullopt;
+    }
+    return IndexKeyOf(value.value());
+}
+
+#endif // _INDEX_KEY_H_
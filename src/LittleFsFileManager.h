@@ -0,0 +1,321 @@
+#ifdef ARDUINO
+#ifdef FILE_MANAGER_LITTLEFS
+#ifndef LITTLEFS_FILE_MANAGER_H
+#define LITTLEFS_FILE_MANAGER_H
+
+// #include "IFileManager.h"
+
+#include <FS.h>
+#include <LittleFS.h>
+#include <atomic>
+#include <sys/stat.h>
+#include "repository/RepositoryMutex.h"
+
+// Directory on the LittleFS partition holding the database files
+#ifndef LITTLEFS_FILE_MANAGER_ROOT
+#define LITTLEFS_FILE_MANAGER_ROOT "/db/"
+#endif
+
+// Mount point of the partition in the ESP-IDF VFS, where stat() reads directory entries
+#ifndef LITTLEFS_FILE_MANAGER_BASE_PATH
+#define LITTLEFS_FILE_MANAGER_BASE_PATH "/littlefs"
+#endif
+
+// Largest single read/write issued to the filesystem, so big records are streamed in pieces
+#ifndef LITTLEFS_FILE_MANAGER_IO_CHUNK_BYTES
+#define LITTLEFS_FILE_MANAGER_IO_CHUNK_BYTES 4096
+#endif
+
+// Filesystem-backed file manager for tables that outgrow NVS (multi-KB records, long IDs files)
+// Files live under LITTLEFS_FILE_MANAGER_ROOT; appends are real FILE_APPEND writes and sizes come
+// from the directory entry. Create/Update/Write go to "<file>.tmp" and are renamed over the file
+// (atomic in LittleFS), so a power loss mid-write keeps the old contents; temp files a power loss
+// left behind are removed when the partition is mounted.
+// Define FILE_MANAGER_LITTLEFS to use it instead of ArduinoFileManager.
+/* @Component */
+class LittleFsFileManager final : public IFileManager {
+    private:
+        std::atomic<bool> mounted{false};
+        RepositoryMutex mountMutex;
+
+        // Mount the partition on first use (formatting it if it has never been mounted)
+        // LittleFS serializes file access itself; only the first mount needs guarding
+        bool Mount() {
+            if (mounted.load()) {
+                return true;
+            }
+            RepositoryLock<RepositoryMutex> lock(mountMutex);
+            if (!mounted.load()) {
+                bool ready = LittleFS.begin(true, LITTLEFS_FILE_MANAGER_BASE_PATH);
+                StdString root(LITTLEFS_FILE_MANAGER_ROOT);
+                if (root.length() > 1 && root[root.length() - 1] == '/') {
+                    root.erase(root.length() - 1);
+                }
+                if (ready && !LittleFS.exists(root.c_str())) {
+                    LittleFS.mkdir(root.c_str());
+                } else if (ready) {
+                    RemoveTempFiles(root.c_str());
+                }
+                mounted.store(ready);
+            }
+            return mounted.load();
+        }
+
+        StdString GetPath(const char* filename) {
+            StdString path(LITTLEFS_FILE_MANAGER_ROOT);
+            path += filename;
+            return path;
+        }
+
+        // Directory entry of a regular file (false if there is none); the file isn't opened
+        bool Stat(const StdString& path, struct stat& info) {
+            StdString vfsPath(LITTLEFS_FILE_MANAGER_BASE_PATH);
+            vfsPath += path;
+            return stat(vfsPath.c_str(), &info) == 0 && S_ISREG(info.st_mode);
+        }
+
+        // Remove the "*.tmp" files an interrupted write left in the database directory
+        void RemoveTempFiles(const char* root) {
+            File directory = LittleFS.open(root);
+            if (!directory || !directory.isDirectory()) {
+                return;
+            }
+            Vector<StdString> stale;
+            for (File entry = directory.openNextFile(); entry; entry = directory.openNextFile()) {
+                StdString path(entry.path());
+                entry.close();
+                if (path.length() > 4 && path.compare(path.length() - 4, 4, ".tmp") == 0) {
+                    stale.push_back(path);
+                }
+            }
+            directory.close();
+            for (const auto& path : stale) {
+                LittleFS.remove(path.c_str());
+            }
+        }
+
+        // Write contents to an open file in bounded pieces
+        bool WriteAll(File& file, std::string_view contents) {
+            size_t written = 0;
+            while (written < contents.length()) {
+                size_t piece = contents.length() - written;
+                if (piece > LITTLEFS_FILE_MANAGER_IO_CHUNK_BYTES) {
+                    piece = LITTLEFS_FILE_MANAGER_IO_CHUNK_BYTES;
+                }
+                size_t result = file.write(reinterpret_cast<const uint8_t*>(contents.data() + written), piece);
+                if (result == 0) {
+                    return false;
+                }
+                written += result;
+            }
+            return true;
+        }
+
+        // Read up to length bytes from the current position of an open file into contents
+        void ReadAll(File& file, size_t length, StdString& contents) {
+            contents.resize(length);
+            size_t received = 0;
+            while (received < length) {
+                size_t piece = length - received;
+                if (piece > LITTLEFS_FILE_MANAGER_IO_CHUNK_BYTES) {
+                    piece = LITTLEFS_FILE_MANAGER_IO_CHUNK_BYTES;
+                }
+                size_t result = file.read(reinterpret_cast<uint8_t*>(&contents[received]), piece);
+                if (result == 0) {
+                    break;
+                }
+                received += result;
+            }
+            contents.resize(received);
+        }
+
+        // Open a file at path for writing ("w" truncates, "a" appends) and write the contents
+        bool WriteFile(const StdString& path, std::string_view contents, const char* mode) {
+            File file = LittleFS.open(path.c_str(), mode);
+            if (!file) {
+                return false;
+            }
+            bool written = WriteAll(file, contents);
+            file.close();
+            return written;
+        }
+
+        // Create or overwrite a file through a temp file renamed over it
+        bool ReplaceFile(const char* filename, std::string_view contents) {
+            FileCallScope call(stats, FileCall::Write);
+            call.Bytes(contents.length());
+            if (!Mount()) {
+                return false;
+            }
+
+            StdString path = GetPath(filename);
+            StdString tempPath = path + ".tmp";
+            if (!WriteFile(tempPath, contents, FILE_WRITE) || !LittleFS.rename(tempPath.c_str(), path.c_str())) {
+                LittleFS.remove(tempPath.c_str());
+                return false;
+            }
+            return true;
+        }
+
+        // Append the contents to a file in place (creates the file if it doesn't exist)
+        bool AppendFile(const char* filename, std::string_view contents) {
+            FileCallScope call(stats, FileCall::Append);
+            call.Bytes(contents.length());
+            if (!Mount()) {
+                return false;
+            }
+            return WriteFile(GetPath(filename), contents, FILE_APPEND);
+        }
+
+    public:
+        // Create: Create a new file with the given filename and contents
+        Bool Create(CStdString& filename, CStdString& contents) override {
+            return ReplaceFile(filename.c_str(), contents);
+        }
+
+        // Read: Read the contents of a file with the given filename
+        StdString Read(CStdString& filename) override {
+            StdString contents;
+            Read(filename.c_str(), contents);
+            return contents;
+        }
+
+        // Read: Read the contents of a file into a caller-owned buffer
+        Bool Read(CStdString& filename, StdString& contents) override {
+            return Read(filename.c_str(), contents);
+        }
+
+        // Read: Read the whole file into a caller-owned buffer, sized from the file length up front
+        // False if the file is missing or empty, like the other file managers
+        Bool Read(const char* filename, StdString& contents) override {
+            FileCallScope call(stats, FileCall::Read);
+            contents.clear();
+            if (!Mount()) {
+                return false;
+            }
+
+            StdString path = GetPath(filename);
+            struct stat info;
+            if (!Stat(path, info)) {
+                return false;
+            }
+            File file = LittleFS.open(path.c_str(), FILE_READ);
+            if (!file) {
+                return false;
+            }
+            ReadAll(file, file.size(), contents);
+            file.close();
+            call.Bytes(contents.length());
+            return !contents.empty();
+        }
+
+        // Update: Update an existing file with the given filename and new contents
+        Bool Update(CStdString& filename, CStdString& contents) override {
+            return ReplaceFile(filename.c_str(), contents);
+        }
+
+        // Delete: Delete a file with the given filename
+        Bool Delete(CStdString& filename) override {
+            FileCallScope call(stats, FileCall::Delete);
+            if (!Mount()) {
+                return false;
+            }
+
+            StdString path = GetPath(filename.c_str());
+            return LittleFS.remove(path.c_str());
+        }
+
+        // Append: Append contents to an existing file (creates file if it doesn't exist)
+        Bool Append(CStdString& filename, CStdString& contents) override {
+            return AppendFile(filename.c_str(), contents);
+        }
+
+        // Write: Create or overwrite a file from the caller's bytes (through a temp file)
+        Bool Write(const char* filename, std::string_view contents) override {
+            return ReplaceFile(filename, contents);
+        }
+
+        // Append: Append the caller's bytes to a file (creates file if it doesn't exist)
+        Bool Append(const char* filename, std::string_view contents) override {
+            return AppendFile(filename, contents);
+        }
+
+        // ReadRange: Seek and read only the requested bytes
+        StdString ReadRange(CStdString& filename, size_t offset, size_t length) override {
+            FileCallScope call(stats, FileCall::Read);
+            StdString contents;
+            if (!Mount()) {
+                return contents;
+            }
+
+            StdString path = GetPath(filename.c_str());
+            struct stat info;
+            if (!Stat(path, info)) {
+                return contents;
+            }
+            File file = LittleFS.open(path.c_str(), FILE_READ);
+            if (!file) {
+                return contents;
+            }
+            size_t size = file.size();
+            if (offset < size && file.seek(offset)) {
+                ReadAll(file, length < size - offset ? length : size - offset, contents);
+            }
+            file.close();
+            call.Bytes(contents.length());
+            return contents;
+        }
+
+        // WriteRange: Seek and overwrite only the given bytes of an existing file
+        Bool WriteRange(CStdString& filename, size_t offset, std::string_view contents) override {
+            FileCallScope call(stats, FileCall::Write);
+            call.Bytes(contents.length());
+            if (!Mount()) {
+                return false;
+            }
+
+            StdString path = GetPath(filename.c_str());
+            struct stat info;
+            if (!Stat(path, info)) {
+                return false;
+            }
+            File file = LittleFS.open(path.c_str(), "r+");
+            if (!file) {
+                return false;
+            }
+            size_t size = file.size();
+            bool written = offset <= size && contents.length() <= size - offset && file.seek(offset) &&
+                           WriteAll(file, contents);
+            file.close();
+            return written;
+        }
+
+        // Exists: Check if a file exists from its directory entry, without opening it
+        Bool Exists(CStdString& filename) override {
+            FileCallScope call(stats, FileCall::Lookup);
+            if (!Mount()) {
+                return false;
+            }
+
+            struct stat info;
+            return Stat(GetPath(filename.c_str()), info);
+        }
+
+        // Size: Size of a file in bytes from its directory entry (0 if it doesn't exist)
+        size_t Size(CStdString& filename) override {
+            FileCallScope call(stats, FileCall::Lookup);
+            if (!Mount()) {
+                return 0;
+            }
+
+            struct stat info;
+            if (!Stat(GetPath(filename.c_str()), info)) {
+                return 0;
+            }
+            return static_cast<size_t>(info.st_size);
+        }
+};
+
+#endif // LITTLEFS_FILE_MANAGER_H
+#endif // FILE_MANAGER_LITTLEFS
+#endif // ARDUINO
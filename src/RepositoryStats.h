@@ -0,0 +1,88 @@
+#ifndef _REPOSITORY_STATS_H_
+#define _REPOSITORY_STATS_H_
+
+#include <StandardDefines.h>
+#include "CacheStats.h"
+#include <cstddef>
+#include <cstdint>
+
+// Instrumentation: repositories count their operations with latency histograms, the file manager
+// calls and bytes each operation caused and the time spent serializing, and file managers count their
+// own calls. Reported by CpaRepository::GetStats() and IFileManager::GetStats().
+// 0 (default) compiles the counting out; GetStats() then returns zeros with enabled == false.
+#ifndef CPA_REPOSITORY_STATS
+#define CPA_REPOSITORY_STATS 0
+#endif
+
+// Latency histogram buckets: bucket 0 counts operations under 1 us, bucket i those under 2^i us,
+// the last one everything slower
+#ifndef CPA_REPOSITORY_STATS_BUCKETS
+#define CPA_REPOSITORY_STATS_BUCKETS 20
+#endif
+
+// File manager calls, reported by IFileManager::GetStats() and per repository operation
+// Times are nanoseconds (microsecond resolution on Arduino)
+struct FileManagerStats {
+    size_t reads = 0;         // Read, ReadRange
+    size_t writes = 0;        // Create, Update, Write
+    size_t appends = 0;
+    size_t deletes = 0;
+    size_t lookups = 0;       // Exists, Size
+    uint64_t bytesRead = 0;
+    uint64_t bytesWritten = 0;
+    uint64_t nanos = 0;       // time spent inside the file manager
+
+    size_t Calls() const {
+        return reads + writes + appends + deletes + lookups;
+    }
+};
+
+// Repository operations counted separately
+// Query covers the generated FindBy/CountBy/ExistsBy/DeleteBy methods; FindPage both paged FindAll overloads
+enum class RepositoryOperation : uint8_t {
+    Save,
+    Update,
+    FindById,
+    FindAll,
+    FindPage,
+    ForEach,
+    Query,
+    ExistsById,
+    DeleteById,
+    SaveAll,
+    FindAllById,
+    DeleteAllById,
+    Flush,
+    Commit,
+    Preload,
+    Count
+};
+
+// Counters of one kind of operation; work an operation does through another one (e.g. the ExistsById
+// inside DeleteById or the flush before a read) is counted as part of the outer operation
+struct OperationStats {
+    size_t count = 0;
+    uint64_t totalNanos = 0;
+    uint64_t maxNanos = 0;
+    uint64_t codecNanos = 0;           // serializing and deserializing entities
+    FileManagerStats storage;          // file manager calls made by these operations
+    uint32_t latency[CPA_REPOSITORY_STATS_BUCKETS] = {};
+};
+
+// Counters reported by CpaRepository::GetStats()
+// Parallel FindAll() sums the storage and codec time of all its threads
+struct RepositoryStats {
+    Bool enabled = false;
+    OperationStats operations[static_cast<size_t>(RepositoryOperation::Count)];
+    size_t serializations = 0;
+    uint64_t serializeNanos = 0;
+    size_t deserializations = 0;
+    uint64_t deserializeNanos = 0;
+    CacheStats cache;
+
+    const OperationStats& Of(RepositoryOperation operation) const {
+        return operations[static_cast<size_t>(operation)];
+    }
+};
+
+#endif // _REPOSITORY_STATS_H_
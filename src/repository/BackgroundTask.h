@@ -0,0 +1,115 @@
+#ifndef _BACKGROUND_TASK_H_
+#define _BACKGROUND_TASK_H_
+
+#include <StandardDefines.h>
+#include "RepositoryMutex.h"
+#include <functional>
+#include <atomic>
+
+// Stack size and priority of the FreeRTOS task running a repository's Preload()
+#ifndef REPOSITORY_PRELOAD_TASK_STACK
+#define REPOSITORY_PRELOAD_TASK_STACK 8192
+#endif
+
+#ifndef REPOSITORY_PRELOAD_TASK_PRIORITY
+#define REPOSITORY_PRELOAD_TASK_PRIORITY 1
+#endif
+
+#if CPA_REPOSITORY_THREADS == CPA_THREADS_STD
+    #include <thread>
+#elif CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+    #include <freertos/FreeRTOS.h>
+    #include <freertos/task.h>
+    #include <freertos/semphr.h>
+#endif
+
+// One-shot job run off the calling thread (std::thread on desktop, FreeRTOS task on ESP32)
+// Targets without threads, and a FreeRTOS task that can't be created, run the job in Run() itself.
+// Wait() blocks until the job has finished; the destructor waits too, so the job may use its owner.
+class BackgroundTask {
+    Private std::function<Void()> job;
+    Private std::atomic<Bool> running{false};
+    Private RepositoryMutex control;
+
+    #if CPA_REPOSITORY_THREADS == CPA_THREADS_STD
+    Private std::thread worker;
+    #elif CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+    Private SemaphoreHandle_t finished = nullptr;
+    #endif
+
+    Public BackgroundTask() = default;
+    Public BackgroundTask(const BackgroundTask&) = delete;
+    Public BackgroundTask& operator=(const BackgroundTask&) = delete;
+
+    Public ~BackgroundTask() {
+        Wait();
+    }
+
+    // Check if a job started by Run() may still be in progress
+    Public Bool IsRunning() const {
+        return running.load();
+    }
+
+    // Start a job, first waiting for the previous one
+    Public Void Run(std::function<Void()> callback) {
+        RepositoryLock<RepositoryMutex> lock(control);
+        Join();
+        job = callback;
+
+        #if CPA_REPOSITORY_THREADS == CPA_THREADS_STD
+            running.store(true);
+            worker = std::thread([this]() { job(); });
+        #elif CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+            finished = xSemaphoreCreateBinary();
+            running.store(true);
+            if (finished == nullptr ||
+                xTaskCreate(&BackgroundTask::TaskEntry, "cpa_preload", REPOSITORY_PRELOAD_TASK_STACK,
+                            this, REPOSITORY_PRELOAD_TASK_PRIORITY, nullptr) != pdPASS) {
+                // No task: run the job here like a target without threads
+                if (finished != nullptr) {
+                    vSemaphoreDelete(finished);
+                    finished = nullptr;
+                }
+                running.store(false);
+                job();
+            }
+        #else
+            job();
+        #endif
+    }
+
+    // Block until the job in progress (if any) has finished
+    Public Void Wait() {
+        RepositoryLock<RepositoryMutex> lock(control);
+        Join();
+    }
+
+    Private Void Join() {
+        if (!running.load()) {
+            return;
+        }
+
+        #if CPA_REPOSITORY_THREADS == CPA_THREADS_STD
+            if (worker.joinable()) {
+                worker.join();
+            }
+        #elif CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+            xSemaphoreTake(finished, portMAX_DELAY);
+            vSemaphoreDelete(finished);
+            finished = nullptr;
+        #endif
+
+        running.store(false);
+    }
+
+    #if CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+    Private Static Void TaskEntry(Void* argument) {
+        BackgroundTask* self = static_cast<BackgroundTask*>(argument);
+        self->job();
+        xSemaphoreGive(self->finished);
+        vTaskDelete(nullptr);
+    }
+    #endif
+};
+
+#endif // _BACKGROUND_TASK_H_
@@ -0,0 +1,132 @@
+#ifndef _BINARY_IDS_FILE_H_
+#define _BINARY_IDS_FILE_H_
+
+#include <StandardDefines.h>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// IDs file format of tables with integral IDs
+// 1 (default) stores them in fixed-width binary slots; 0 keeps the newline-delimited text file.
+// Tables with string IDs always use the text file. Existing text files are converted on first write.
+#ifndef CPA_REPOSITORY_BINARY_IDS
+#define CPA_REPOSITORY_BINARY_IDS 1
+#endif
+
+// Compact a binary IDs file once it holds at least this many tombstones and no more live IDs
+#ifndef CPA_REPOSITORY_IDS_COMPACT_MIN
+#define CPA_REPOSITORY_IDS_COMPACT_MIN 64
+#endif
+
+// Layout: <magic 'I' 'D' width><slot>*  where every slot is <tag><ID, width bytes little endian>
+// A delete overwrites the tag of its slot in place; compaction rewrites the file without tombstones.
+// Text IDs can't start with the magic byte, so both formats are told apart by the first byte.
+#define BINARY_IDS_MAGIC '\xC1'
+#define BINARY_IDS_HEADER_SIZE 4
+#define BINARY_IDS_LIVE '\x01'
+#define BINARY_IDS_TOMBSTONE '\x00'
+
+template<typename ID>
+class BinaryIdsCodec {
+    static_assert(std::is_integral_v<ID>, "binary IDs files hold integral IDs");
+
+    Public Static constexpr size_t Width = sizeof(ID);
+    Public Static constexpr size_t SlotSize = 1 + sizeof(ID);
+
+    // Check if contents (or their first bytes) are a binary IDs file
+    Public Static Bool IsBinary(const StdString& contents) {
+        return !contents.empty() && contents[0] == BINARY_IDS_MAGIC;
+    }
+
+    // Check if a binary IDs file holds IDs of this width (a file written for another ID type is rewritten)
+    Public Static Bool HasOwnWidth(const StdString& contents) {
+        return contents.length() >= BINARY_IDS_HEADER_SIZE && IsBinary(contents) &&
+               static_cast<uint8_t>(contents[3]) == Width;
+    }
+
+    Public Static Void AppendHeader(StdString& out) {
+        out += BINARY_IDS_MAGIC;
+        out += 'I';
+        out += 'D';
+        out += static_cast<char>(Width);
+    }
+
+    Public Static Void AppendSlot(StdString& out, ID id) {
+        char slot[SlotSize];
+        slot[0] = BINARY_IDS_LIVE;
+        #if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            std::memcpy(slot + 1, &id, Width);
+        #else
+            uint64_t bits = static_cast<uint64_t>(id);
+            for (size_t i = 0; i < Width; i++) {
+                slot[1 + i] = static_cast<char>((bits >> (8 * i)) & 0xFF);
+            }
+        #endif
+        out.append(slot, SlotSize);
+    }
+
+    // Offset of a slot in the file
+    Public Static size_t SlotOffset(size_t slot) {
+        return BINARY_IDS_HEADER_SIZE + slot * SlotSize;
+    }
+
+    // Number of complete slots in a file of size bytes (a torn last slot doesn't count)
+    Public Static size_t SlotCount(size_t size) {
+        return size <= BINARY_IDS_HEADER_SIZE ? 0 : (size - BINARY_IDS_HEADER_SIZE) / SlotSize;
+    }
+
+    // Check if slotBytes (one slot read back from the file) is the live slot of id
+    Public Static Bool IsLiveSlot(const StdString& slotBytes, ID id) {
+        return slotBytes.length() == SlotSize && slotBytes[0] == BINARY_IDS_LIVE && DecodeId(slotBytes.data() + 1) == id;
+    }
+
+    // Visit the live IDs of a binary IDs file in file order with their slot numbers
+    // visitor(id, slot) returns false to stop; a torn last slot is ignored. Files written with another
+    // ID width (the ID type changed) are read too, so they can be rewritten.
+    Public template<typename Visitor>
+    Static Void ForEachLive(const StdString& contents, Visitor&& visitor) {
+        if (contents.length() < BINARY_IDS_HEADER_SIZE || !IsBinary(contents)) {
+            return;
+        }
+        size_t width = static_cast<uint8_t>(contents[3]);
+        if (width == 0 || width > 8) {
+            return;
+        }
+        size_t slotSize = 1 + width;
+        size_t count = (contents.length() - BINARY_IDS_HEADER_SIZE) / slotSize;
+        const char* data = contents.data() + BINARY_IDS_HEADER_SIZE;
+        for (size_t slot = 0; slot < count; slot++, data += slotSize) {
+            if (data[0] != BINARY_IDS_LIVE) {
+                continue;
+            }
+            ID id = width == Width ? DecodeId(data + 1) : DecodeId(data + 1, width);
+            if (!visitor(id, slot)) {
+                return;
+            }
+        }
+    }
+
+    Private Static ID DecodeId(const char* data) {
+        #if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            ID id;
+            std::memcpy(&id, data, Width);
+            return id;
+        #else
+            return DecodeId(data, Width);
+        #endif
+    }
+
+    // Decode an ID of any width, sign-extending it for signed ID types
+    Private Static ID DecodeId(const char* data, size_t width) {
+        uint64_t bits = 0;
+        for (size_t i = 0; i < width; i++) {
+            bits |= static_cast<uint64_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+        }
+        if (std::is_signed_v<ID> && width < 8 && (bits >> (8 * width - 1)) & 1) {
+            bits |= ~uint64_t(0) << (8 * width);
+        }
+        return static_cast<ID>(bits);
+    }
+};
+
+#endif // _BINARY_IDS_FILE_H_
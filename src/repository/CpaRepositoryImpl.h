@@ -3,28 +3,148 @@
 
 #include "../CpaRepository.h"
 #include "../IFileManager.h"
+#include "../FileManagerSession.h"
+#include "../BinaryCodec.h"
+#include "../IndexKey.h"
+#include "IdIndex.h"
+#include "BinaryIdsFile.h"
+#include "SecondaryIndex.h"
+#include "EntityCache.h"
+#include "WriteBehindQueue.h"
+#include "BackgroundTask.h"
+#include "RepositoryMutex.h"
+#include "TableLock.h"
+#include "EntityTraits.h"
+#include "KeyHash.h"
+#include "LogRecord.h"
+#include "StatsRecorder.h"
 #include <optional>
 #include <type_traits>
 #include <functional>
 #include <cstdint>
+#include <algorithm>
+#include <utility>
+#include <atomic>
+
+// Directory prefix of every storage key (can be overridden, e.g. by the benchmark target)
+#ifndef DATABASE_PATH
+    #ifdef ARDUINO
+        #define DATABASE_PATH ""
+    #else
+        #define DATABASE_PATH "/Users/nkurude/db/"
+    #endif
+#endif
+
+// Desktop FindAll() reads and decodes tables of at least this many entities on several threads
+// (0 keeps it serial); CPA_REPOSITORY_PARALLEL_THREADS caps the thread count (0 = one per core)
+#ifndef CPA_REPOSITORY_PARALLEL_MIN_ENTITIES
+#define CPA_REPOSITORY_PARALLEL_MIN_ENTITIES 256
+#endif
+
+#ifndef CPA_REPOSITORY_PARALLEL_THREADS
+#define CPA_REPOSITORY_PARALLEL_THREADS 0
+#endif
+
+#if !defined(ARDUINO) && CPA_REPOSITORY_THREADS == CPA_THREADS_STD
+    #define CPA_REPOSITORY_PARALLEL_FIND_ALL
+    #include <future>
+    #include <thread>
+#endif
+
+// Default entity cache capacity (0 = disabled); a repository can set its own with /// @Cacheable(capacity)
+#ifndef CPA_REPOSITORY_CACHE_CAPACITY
+#define CPA_REPOSITORY_CACHE_CAPACITY 0
+#endif
+
+// Flush() saves the preload set (see SavePreloadSet) at most this often, the destructor always;
+// 0 leaves it to explicit SavePreloadSet() calls
+#ifndef CPA_REPOSITORY_PRELOAD_SAVE_INTERVAL_MS
+#define CPA_REPOSITORY_PRELOAD_SAVE_INTERVAL_MS 60000
+#endif
 
 #ifdef ARDUINO
-#define DATABASE_PATH ""
+    #include <Arduino.h>
 #else
-#define DATABASE_PATH "/Users/nkurude/db/"
+    #include <chrono>
 #endif
 
+// Default storage engine: one file per entity plus an IDs file per table
+// Several repository instances may store the same table. Each keeps its own ID index, secondary indexes
+// and entity cache in sync with its own writes; a write through another instance bumps the table's
+// version (see TableLock.h), and the next time this one takes the table lock it drops them to reload.
+// Queued and transaction writes stay private to their instance until they are flushed or committed.
 template<typename Entity, typename ID>
 class CpaRepositoryImpl : public CpaRepository<Entity, ID> {
-    Public Virtual ~CpaRepositoryImpl() = default;
+    // Engines that override storage hooks finish a background preload and stop the write-behind worker
+    // in their own destructor, while the hooks are still theirs; this one catches the default engine.
+    // An open transaction is rolled back first: it holds the table lock the worker's last flush needs.
+    Public Virtual ~CpaRepositoryImpl() {
+        Rollback();
+        WaitForPreload();
+        StopWriteBehind();
+        AutoSavePreloadSet(true);
+    }
 
     /* @Autowired */
     IFileManagerPtr fileManager;
 
+    // In-memory copy of the IDs file, loaded on first use and kept in sync by this instance's writes only
+    // (see IdIndex.h for the available modes)
+    Private IdIndex<ID> idIndex;
+
+    // Set once the IDs file is known to use binary slots (text files are converted by the first write)
+    Private std::atomic<Bool> idsFileBinary{false};
+
+    // Secondary indexes of /* @Indexed */ fields, in Entity::GetIndexedFields() order
+    Private Vector<SecondaryIndex> secondaryIndexes;
+    Private std::atomic<Bool> secondaryIndexesReady{false};
+
+    // LRU cache of deserialized entities, written through on every write
+    Private EntityCache<Entity, ID> entityCache{CPA_REPOSITORY_CACHE_CAPACITY};
+
+    // Records refused because their file held another key with the same hash (see CPA_REPOSITORY_KEY_CHECK)
+    Private std::atomic<size_t> keyCollisions{0};
+
+    // Saves and deletes storage refused (see GetWriteFailures)
+    Private std::atomic<size_t> writeFailures{0};
+
+    // Operation, storage and codec counters (see RepositoryStats.h; empty unless CPA_REPOSITORY_STATS)
+    Private RepositoryCounters repositoryStats;
+
+    // Queued writes while write-behind is enabled (see SetWriteBehind)
+    Private WriteBehindQueue<Entity, ID> writeBehind;
+
+    // Writes buffered by the open transaction, coalesced per ID like write-behind (it never starts a worker)
+    Private WriteBehindQueue<Entity, ID> transaction;
+    Private std::atomic<Bool> transactionOpen{false};
+
+    // The table's writer lock, held by the thread that called Begin until Commit or Rollback ends the
+    // transaction, so other threads wait instead of joining it (a no-op unless IsLocking() at Begin)
+    Private optional<TableLockGuard<Entity>> transactionLock;
+
+    // Table version the in-memory state above matches (see SyncWithTable)
+    Private std::atomic<uint32_t> seenVersion{0};
+
+    // Set once a journal left by an interrupted commit has been looked for (see RecoverJournal)
+    Private std::atomic<Bool> journalChecked{false};
+
+    // Background warm-up started by PreloadAsync()
+    Private BackgroundTask preloadTask;
+
+    // When Flush() last saved the preload set (see AutoSavePreloadSet)
+    Private std::atomic<uint32_t> preloadSavedAt{0};
+    Private std::atomic<Bool> preloadSaved{false};
+
+    // Encoding buffer of single writes, only touched under the exclusive table lock (keeps its capacity)
+    Private StdString encodeBuffer;
+
+    // Serializes lazy loading that readers sharing the table lock may trigger (index builds, engine caches)
+    Protected RepositoryRecursiveMutex initMutex;
+
     // Private template function to convert ID to string
     // Handles both string types and primitive types
     // Since StdString is a typedef for std::string, we check for std::string
-    Private template<typename T>
+    Protected template<typename T>
     StdString ConvertToString(const T& value) {
         // Check if T is a string type (StdString is std::string, so check for std::string)
         if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, StdString>) {
@@ -38,7 +158,7 @@ class CpaRepositoryImpl : public CpaRepository<Entity, ID> {
 
     // Private template function to convert string to ID type
     // Handles both string types and primitive types
-    Private template<typename T>
+    Protected template<typename T>
     T ConvertFromString(const StdString& str) {
         // Check if T is a string type
         if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, StdString>) {
@@ -65,46 +185,148 @@ class CpaRepositoryImpl : public CpaRepository<Entity, ID> {
         }
     }
 
-    // Helper method to get IDs file path
-    Protected StdString GetIdsFilePath() {
-        StdString tableName = Entity::GetTableName();
-        return StdString(DATABASE_PATH) + GenerateHash(tableName + "_IDs");
+    // Helper method to get IDs file path (computed once per table)
+    Protected CStdString& GetIdsFilePath() {
+        static CStdString idsFilePath = StdString(DATABASE_PATH) + GenerateHash(GetIdsFileKey());
+        return idsFilePath;
+    }
+
+    // Helper method to get the transaction journal path (computed once per table)
+    Protected CStdString& GetJournalFilePath() {
+        static CStdString journalFilePath = StdString(DATABASE_PATH) + GenerateHash(Entity::GetTableName() + "_WAL");
+        return journalFilePath;
+    }
+
+    // Helper method to get the path of the IDs preloaded after boot (computed once per table)
+    Protected CStdString& GetPreloadFilePath() {
+        static CStdString preloadFilePath = StdString(DATABASE_PATH) + GenerateHash(Entity::GetTableName() + "_MRU");
+        return preloadFilePath;
+    }
+
+    // Storage key of the IDs file: generated at build time, or built from the table name by older entities
+    Protected Static StdString GetIdsFileKey() {
+        if constexpr (HasStorageKeys<Entity>::value) {
+            return StdString(Entity::GetIdsFileKey());
+        } else {
+            return Entity::GetTableName() + "_IDs";
+        }
+    }
+
+    // Prefix of every record key, "<table>_<primary key>_" (computed once per table for older entities)
+    Protected Static std::string_view GetStorageKeyPrefix() {
+        if constexpr (HasStorageKeys<Entity>::value) {
+            return Entity::GetStorageKeyPrefix();
+        } else {
+            static CStdString prefix = Entity::GetTableName() + "_" + Entity::GetPrimaryKeyName() + "_";
+            return prefix;
+        }
+    }
+
+    // FNV-1a state after the record key prefix: a compile-time constant for generated entities
+    Protected Static uint64_t GetStorageKeyPrefixHash() {
+        if constexpr (HasStorageKeys<Entity>::value) {
+            constexpr uint64_t prefixHash = KeyHash::Update(KeyHash::Seed, Entity::GetStorageKeyPrefix());
+            return prefixHash;
+        } else {
+            static const uint64_t prefixHash = KeyHash::Update(KeyHash::Seed, GetStorageKeyPrefix());
+            return prefixHash;
+        }
     }
 
     // Helper method to generate consistent hash for a string input
-    // Returns a hash value as StdString (guaranteed to be <= 14 characters)
-    Protected Static StdString GenerateHash(CStdString input) {
-        // Use std::hash to generate hash, then cast to uint32_t to ensure <= 14 characters
-        // uint32_t max value is 4,294,967,295 (10 digits), which is well within 14 character limit
-        std::hash<StdString> hasher;
-        size_t hashValue = hasher(StdString(input.c_str()));
-        uint32_t hash32 = static_cast<uint32_t>(hashValue);
-        
-        // Convert to string and return
-        return StdString(std::to_string(hash32).c_str());
+    // Returns a hash value as StdString (at most 12 characters, within the NVS key limit)
+    Protected Static StdString GenerateHash(std::string_view input) {
+        #if CPA_REPOSITORY_KEY_HASH == CPA_KEY_HASH_STD
+            // Use std::hash to generate hash, then cast to uint32_t to ensure <= 14 characters
+            // uint32_t max value is 4,294,967,295 (10 digits), which is well within 14 character limit
+            // (hashing the view gives the same value as hashing an equal std::string)
+            std::hash<std::string_view> hasher;
+            uint32_t hash32 = static_cast<uint32_t>(hasher(input));
+            return std::to_string(hash32);
+        #else
+            return KeyHash::Encode(KeyHash::Update(KeyHash::Seed, input));
+        #endif
+    }
+
+    // Logical key of a record, "<table>_<primary key>_<id>" (what its file name is a hash of)
+    Protected StdString GetRecordKey(ID id) {
+        std::string_view prefix = GetStorageKeyPrefix();
+        StdString key;
+        key.reserve(prefix.length() + 24);
+        key.append(prefix.data(), prefix.length());
+        if constexpr (std::is_same_v<ID, std::string>) {
+            key += id;
+        } else {
+            key += ConvertToString(id);
+        }
+        return key;
     }
 
-    // Helper method to construct file path
+    // Helper method to construct file path: the hash of the record key
     Protected StdString GetFilePath(ID id) {
-        // Get table name (static method)
-        StdString tableName = Entity::GetTableName();
-        // Get primary key name (static method)
-        StdString primaryKeyName = Entity::GetPrimaryKeyName();
-        return StdString(DATABASE_PATH) + GenerateHash(tableName + "_" + primaryKeyName + "_" + ConvertToString(id));
+        StdString filePath(DATABASE_PATH);
+        #if CPA_REPOSITORY_KEY_HASH == CPA_KEY_HASH_STD
+            filePath += GenerateHash(GetRecordKey(id));
+        #else
+            // Continue the prefix hash over the ID only
+            if constexpr (std::is_same_v<ID, std::string>) {
+                filePath += KeyHash::Encode(KeyHash::Update(GetStorageKeyPrefixHash(), id));
+            } else {
+                filePath += KeyHash::Encode(KeyHash::Update(GetStorageKeyPrefixHash(), ConvertToString(id)));
+            }
+        #endif
+        return filePath;
+    }
+
+    // Whether the IDs file uses fixed-width binary slots (integral IDs, see BinaryIdsFile.h)
+    Protected Static constexpr Bool HasBinaryIds() {
+        return CPA_REPOSITORY_BINARY_IDS && std::is_integral_v<ID>;
     }
 
     // Helper method to read all IDs from the IDs file
-    Protected Vector<ID> ReadAllIds() {
+    // Storage hook: engines that don't keep an IDs file override this
+    Protected Virtual Vector<ID> ReadAllIds() {
+        return ReadIdsFile(nullptr);
+    }
+
+    // Read the IDs file in either format; slots, if given, receives each ID's slot in a binary file
+    // (its line in a text file)
+    Protected Vector<ID> ReadIdsFile(Vector<uint32_t>* slots) {
         Vector<ID> ids;
-        StdString idsFilePath = GetIdsFilePath();
-        CStdString idsFilePathRef = idsFilePath;
-        StdString contents = fileManager->Read(idsFilePathRef);
+        CStdString& idsFilePath = GetIdsFilePath();
+        StdString contents = fileManager->Read(idsFilePath);
         
         if (contents.empty()) {
             return ids;
         }
         
-        // Parse IDs from file (one ID per line)
+        // Binary slots: one tag check and one memcpy per ID
+        if constexpr (HasBinaryIds()) {
+            if (BinaryIdsCodec<ID>::IsBinary(contents)) {
+                Bool ownWidth = BinaryIdsCodec<ID>::HasOwnWidth(contents);
+                ids.reserve(BinaryIdsCodec<ID>::SlotCount(contents.length()));
+                BinaryIdsCodec<ID>::ForEachLive(contents, [&ids, slots, ownWidth](ID id, size_t slot) {
+                    ids.push_back(id);
+                    if (slots != nullptr && ownWidth) {
+                        slots->push_back(static_cast<uint32_t>(slot));
+                    }
+                    return true;
+                });
+                return ids;
+            }
+        }
+        
+        ParseTextIds(contents, ids);
+        if (slots != nullptr) {
+            for (size_t i = 0; i < ids.size(); i++) {
+                slots->push_back(static_cast<uint32_t>(i));
+            }
+        }
+        return ids;
+    }
+
+    // Parse IDs from a text file (one ID per line)
+    Protected Void ParseTextIds(CStdString& contents, Vector<ID>& ids) {
         StdString currentId;
         for (size_t i = 0; i < contents.length(); i++) {
             char c = contents[i];
@@ -125,207 +347,1727 @@ class CpaRepositoryImpl : public CpaRepository<Entity, ID> {
             ID id = ConvertFromString<ID>(currentId);
             ids.push_back(id);
         }
+    }
+
+    // One page of the IDs file: skip offset IDs and return at most limit
+    // Storage hook: served from the ID index (no I/O once it is loaded); without one, a binary IDs file
+    // is read in slot ranges up to the end of the page, and a text one is parsed until the page is complete
+    Protected Virtual Vector<ID> ReadIdRange(size_t offset, size_t limit) {
+        Vector<ID> ids;
+        if (limit == 0) {
+            return ids;
+        }
+        
+        #if CPA_REPOSITORY_ID_INDEX != CPA_ID_INDEX_NONE
+            {
+                // Readers share the table lock, so loading and paging the index is serialized here
+                RepositoryLock<RepositoryRecursiveMutex> init(initMutex);
+                EnsureIdIndexLoaded();
+                if (idIndex.Page(offset, limit, ids)) {
+                    return ids;
+                }
+                ids.clear();
+            }
+        #endif
+        
+        CStdString& idsFilePath = GetIdsFilePath();
+        if constexpr (HasBinaryIds()) {
+            StdString header = fileManager->ReadRange(idsFilePath, 0, BINARY_IDS_HEADER_SIZE);
+            if (BinaryIdsCodec<ID>::HasOwnWidth(header)) {
+                ReadBinaryIdRange(offset, limit, header, ids);
+                return ids;
+            }
+        }
+        
+        StdString contents;
+        fileManager->Read(idsFilePath, contents);
+        if constexpr (HasBinaryIds()) {
+            if (BinaryIdsCodec<ID>::IsBinary(contents)) {
+                size_t index = 0;
+                BinaryIdsCodec<ID>::ForEachLive(contents, [&ids, &index, offset, limit](ID id, size_t) {
+                    if (index++ >= offset) {
+                        ids.push_back(id);
+                    }
+                    return ids.size() < limit;
+                });
+                return ids;
+            }
+        }
         
+        size_t index = 0;
+        size_t start = 0;
+        while (start < contents.length() && ids.size() < limit) {
+            size_t end = contents.find_first_of("\r\n", start);
+            if (end == StdString::npos) {
+                end = contents.length();
+            }
+            if (end > start) {
+                if (index >= offset) {
+                    ids.push_back(ConvertFromString<ID>(contents.substr(start, end - start)));
+                }
+                index++;
+            }
+            start = end + 1;
+        }
         return ids;
     }
 
+    // Page of a binary IDs file without the ID index: tombstones make the offset a count of live slots,
+    // so the slots before the page are read too, each range just long enough if none is a tombstone
+    Protected Void ReadBinaryIdRange(size_t offset, size_t limit, CStdString& header, Vector<ID>& ids) {
+        CStdString& idsFilePath = GetIdsFilePath();
+        size_t slotCount = BinaryIdsCodec<ID>::SlotCount(fileManager->Size(idsFilePath));
+        size_t skip = offset;
+        size_t slot = 0;
+        StdString range;
+        while (ids.size() < limit && slot < slotCount) {
+            size_t wanted = skip + (limit - ids.size());
+            size_t count = std::min(slotCount - slot, wanted < skip ? slotCount : wanted);
+            range = header;
+            range += fileManager->ReadRange(idsFilePath, BinaryIdsCodec<ID>::SlotOffset(slot),
+                                            count * BinaryIdsCodec<ID>::SlotSize);
+            BinaryIdsCodec<ID>::ForEachLive(range, [&ids, &skip, limit](ID id, size_t) {
+                if (skip > 0) {
+                    skip--;
+                    return true;
+                }
+                ids.push_back(id);
+                return ids.size() < limit;
+            });
+            slot += count;
+        }
+    }
+
+    // Helper method to populate the ID index from the IDs file (only the first call reads the file)
+    Protected Void EnsureIdIndexLoaded() {
+        if (!idIndex.IsLoaded()) {
+            Vector<uint32_t> slots;
+            Vector<ID> ids = ReadIdsFile(&slots);
+            idIndex.Load(ids, slots);
+        }
+    }
+
     // Helper method to write all IDs to the IDs file
-    Protected Void WriteAllIds(const Vector<ID>& ids) {
-        StdString idsFilePath = GetIdsFilePath();
+    // Binary IDs files are rewritten without tombstones (this is their compaction)
+    // On failure the file and the ID index keep the previous IDs
+    Protected Bool WriteAllIds(const Vector<ID>& ids) {
+        CStdString& idsFilePath = GetIdsFilePath();
         StdString contents;
+        Vector<uint32_t> slots;
         
-        for (size_t i = 0; i < ids.size(); i++) {
-            contents += ConvertToString(ids[i]);
-            contents += StdString("\n"); // Always add newline, including after last ID
+        if constexpr (HasBinaryIds()) {
+            contents.reserve(BINARY_IDS_HEADER_SIZE + ids.size() * BinaryIdsCodec<ID>::SlotSize);
+            BinaryIdsCodec<ID>::AppendHeader(contents);
+            for (size_t i = 0; i < ids.size(); i++) {
+                BinaryIdsCodec<ID>::AppendSlot(contents, ids[i]);
+                slots.push_back(static_cast<uint32_t>(i));
+            }
+        } else {
+            for (size_t i = 0; i < ids.size(); i++) {
+                contents += ConvertToString(ids[i]);
+                contents += StdString("\n"); // Always add newline, including after last ID
+                slots.push_back(static_cast<uint32_t>(i));
+            }
         }
         
-        CStdString idsFilePathRef = idsFilePath;
-        CStdString contentsRef = contents;
-        fileManager->Create(idsFilePathRef, contentsRef);
+        if (!fileManager->Create(idsFilePath, contents)) {
+            return false;
+        }
+        if constexpr (HasBinaryIds()) {
+            idsFileBinary.store(true);
+        }
+
+        // Keep the ID index in sync with the rewritten file
+        #if CPA_REPOSITORY_ID_INDEX != CPA_ID_INDEX_NONE
+            idIndex.Load(ids, slots);
+        #endif
+        return true;
+    }
+
+    // Convert a text IDs file (or one written for another ID width) to binary slots before the first write
+    // Returns false if the conversion couldn't be written (it is tried again by the next write)
+    Protected Bool EnsureBinaryIdsFile() {
+        if (idsFileBinary.load()) {
+            return true;
+        }
+        StdString header = fileManager->ReadRange(GetIdsFilePath(), 0, BINARY_IDS_HEADER_SIZE);
+        if (!header.empty() && !BinaryIdsCodec<ID>::HasOwnWidth(header) && !WriteAllIds(ReadIdsFile(nullptr))) {
+            return false;
+        }
+        idsFileBinary.store(true);
+        return true;
     }
 
     // Helper method to check if ID exists in the IDs file
-    Protected Bool IdExistsInFile(ID id) {
-        Vector<ID> ids = ReadAllIds();
-        for (const auto& existingId : ids) {
-            if (existingId == id) {
-                return true;
+    Protected Virtual Bool IdExistsInFile(ID id) {
+        #if CPA_REPOSITORY_ID_INDEX != CPA_ID_INDEX_NONE
+            // Answer from the in-memory index, no I/O after the first call
+            EnsureIdIndexLoaded();
+            return idIndex.Contains(id);
+        #else
+            Vector<ID> ids = ReadAllIds();
+            for (const auto& existingId : ids) {
+                if (existingId == id) {
+                    return true;
+                }
             }
-        }
-        return false;
+            return false;
+        #endif
     }
 
-    // Create: Save a new entity
-    Public Virtual Entity Save(Entity& entity) override {
-        // Get generated ID (non-static method)
-        optional<ID> generatedId = entity.GetPrimaryKey();
-        
-        if(generatedId.has_value()) {
-            ID id = generatedId.value();
-            
-            // Construct file path: DATABASE_PATH/TableName_PrimaryKeyName_ID
-            StdString filePath = GetFilePath(id);
+    // Helper method to record a newly appended ID in the ID index
+    Protected Void AddIdToIndex(ID id) {
+        #if CPA_REPOSITORY_ID_INDEX != CPA_ID_INDEX_NONE
+            if (idIndex.IsLoaded()) {
+                idIndex.Insert(id);
+            }
+        #else
+            (void)id;
+        #endif
+    }
+
+    // Helper method to get the file path of a secondary index
+    Protected StdString GetIndexFilePath(CStdString& fieldName) {
+        StdString tableName = Entity::GetTableName();
+        return StdString(DATABASE_PATH) + GenerateHash(tableName + "_IDX_" + fieldName);
+    }
+
+    // Load the secondary indexes on first use, building any that don't exist yet from the table
+    Protected Void EnsureSecondaryIndexesLoaded() {
+        if constexpr (HasIndexes<Entity>::value) {
+            if (secondaryIndexesReady.load(std::memory_order_acquire)) {
+                return;
+            }
+            RepositoryLock<RepositoryRecursiveMutex> init(initMutex);
+            if (secondaryIndexesReady.load(std::memory_order_relaxed)) {
+                return;
+            }
             
-            // Serialize entity (non-static method)
-            StdString contents = entity.Serialize();
+            if (secondaryIndexes.empty()) {
+                for (const auto& fieldName : Entity::GetIndexedFields()) {
+                    secondaryIndexes.push_back(SecondaryIndex(GetIndexFilePath(fieldName)));
+                }
+            }
             
-            // Save to file using file manager
-            CStdString filePathRef = filePath;
-            CStdString contentsRef = contents;
-            fileManager->Create(filePathRef, contentsRef);
+            Vector<size_t> missing;
+            for (size_t i = 0; i < secondaryIndexes.size(); i++) {
+                if (!secondaryIndexes[i].IsLoaded() && !secondaryIndexes[i].Load(fileManager)) {
+                    secondaryIndexes[i].Reset();
+                    missing.push_back(i);
+                }
+            }
+            if (missing.empty()) {
+                secondaryIndexesReady.store(true, std::memory_order_release);
+                return;
+            }
             
-            // Append ID to IDs file if it doesn't already exist
-            if (!IdExistsInFile(id)) {
-                StdString idsFilePath = GetIdsFilePath();
-                StdString idStr = ConvertToString(id) + StdString("\n");
-                CStdString idsFilePathRef = idsFilePath;
-                CStdString idStrRef = idStr;
-                fileManager->Append(idsFilePathRef, idStrRef);
+            // One scan of the table fills every missing index
+            ScanEntities([this, &missing](const Entity& entity) {
+                optional<ID> id = PrimaryKeyOf(entity);
+                if (id.has_value()) {
+                    StdString idStr = ConvertToString(id.value());
+                    Vector<optional<StdString>> keys = entity.GetIndexKeys();
+                    for (size_t i : missing) {
+                        if (i < keys.size() && keys[i].has_value()) {
+                            secondaryIndexes[i].Insert(keys[i].value(), idStr);
+                        }
+                    }
+                }
+                return true;
+            });
+            for (size_t i : missing) {
+                secondaryIndexes[i].Persist(fileManager);
             }
+            secondaryIndexesReady.store(true, std::memory_order_release);
         }
-        
-        return entity;
     }
 
-    // Read: Find entity by ID
-    Public Virtual optional<Entity> FindById(ID id) override {
-        // Construct file path
-        StdString filePath = GetFilePath(id);
-        
-        // Read file contents
-        CStdString filePathRef = filePath;
-        StdString contents = fileManager->Read(filePathRef);
-        
-        // Check if file was read successfully (non-empty content)
-        if (contents.empty()) {
-            return std::nullopt;
+    // Stored entity an upcoming write replaces, needed to drop its old index keys (nothing without indexes)
+    Protected optional<Entity> ReadIndexedEntity(ID id) {
+        if constexpr (HasIndexes<Entity>::value) {
+            EnsureSecondaryIndexesLoaded();
+            return LoadEntity(id);
         }
-        
-        // Deserialize entity (Deserialize is a static method)
-        Entity entity = Entity::Deserialize(contents);
-        
-        return entity;
+        return std::nullopt;
     }
-    // Read: Find all entities
-    Public Virtual Vector<Entity> FindAll() override {
-        Vector<Entity> entities;
-        
-        // Read all IDs from the IDs file
-        Vector<ID> ids = ReadAllIds();
-        
-        // For each ID, read and deserialize the entity
-        for (const auto& id : ids) {
-            StdString filePath = GetFilePath(id);
-            CStdString filePathRef = filePath;
-            StdString contents = fileManager->Read(filePathRef);
+
+    // Move an entity's index entries from its previous keys to its new ones (after is nullptr on delete)
+    Protected Void UpdateSecondaryIndexes(ID id, const optional<Entity>& before, const Entity* after) {
+        if constexpr (HasIndexes<Entity>::value) {
+            EnsureSecondaryIndexesLoaded();
+            StdString idStr = ConvertToString(id);
+            Vector<optional<StdString>> oldKeys;
+            Vector<optional<StdString>> newKeys;
+            if (before.has_value()) {
+                oldKeys = before.value().GetIndexKeys();
+            }
+            if (after != nullptr) {
+                newKeys = after->GetIndexKeys();
+            }
             
-            if (!contents.empty()) {
-                // Deserialize entity (Deserialize is a static method)
-                Entity entity = Entity::Deserialize(contents);
-                entities.push_back(entity);
+            for (size_t i = 0; i < secondaryIndexes.size(); i++) {
+                optional<StdString> oldKey = i < oldKeys.size() ? oldKeys[i] : std::nullopt;
+                optional<StdString> newKey = i < newKeys.size() ? newKeys[i] : std::nullopt;
+                if (oldKey == newKey) {
+                    continue;
+                }
+                if (oldKey.has_value()) {
+                    secondaryIndexes[i].Remove(fileManager, oldKey.value(), idStr);
+                }
+                if (newKey.has_value()) {
+                    secondaryIndexes[i].Add(fileManager, newKey.value(), idStr);
+                }
             }
         }
-        
-        return entities;
     }
 
-    // Update: Update an existing entity
-    Public Virtual Entity Update(Entity& entity) override {
-        // Get ID from entity
-        optional<ID> id = entity.GetPrimaryKey();
-        
-        if(id.has_value()) {
-            ID entityId = id.value();
-            
-            // Construct file path
-            StdString filePath = GetFilePath(entityId);
-            
-            // Serialize entity
-            StdString contents = entity.Serialize();
-            
-            // Update file using file manager
-            CStdString filePathRef = filePath;
-            CStdString contentsRef = contents;
-            fileManager->Update(filePathRef, contentsRef);
-            
-            // Add ID to IDs file if it doesn't already exist (for Update on non-existent entity)
-            if (!IdExistsInFile(entityId)) {
-                StdString idsFilePath = GetIdsFilePath();
-                
-                // Read current file to check if it ends with newline
-                CStdString idsFilePathRef = idsFilePath;
-                StdString currentContents = fileManager->Read(idsFilePathRef);
+    // Visit the entities whose field has the given index key, or all entities if the field isn't @Indexed
+    // Used by generated FindBy/CountBy/ExistsBy/DeleteBy methods; visitors still compare the field value
+    Protected Void ForEachMatching(CStdString& fieldName, CStdString& key, std::function<Bool(const Entity&)> visitor) {
+        auto operation = TrackOperation(RepositoryOperation::Query);
+        RecoverJournal();
+        FlushWriteBehind();
+        auto lock = LockStorageShared();
+        if constexpr (HasIndexes<Entity>::value) {
+            Vector<StdString> fieldNames = Entity::GetIndexedFields();
+            for (size_t i = 0; i < fieldNames.size(); i++) {
+                if (fieldNames[i] != fieldName) {
+                    continue;
+                }
                 
-                // Ensure we append with proper newline
-                StdString idStr;
-                if (currentContents.empty()) {
-                    idStr = ConvertToString(entityId) + StdString("\n");
-                } else {
-                    // Check if last character is newline
-                    if (currentContents.length() > 0 && 
-                        currentContents[currentContents.length() - 1] != '\n' &&
-                        currentContents[currentContents.length() - 1] != '\r') {
-                        // File doesn't end with newline, add one before appending
-                        idStr = StdString("\n") + ConvertToString(entityId) + StdString("\n");
-                    } else {
-                        // File ends with newline, just append ID with newline
-                        idStr = ConvertToString(entityId) + StdString("\n");
+                FileManagerSession session(fileManager);
+                EnsureSecondaryIndexesLoaded();
+                const auto& found = secondaryIndexes[i].Find(key);
+                Vector<StdString> ids(found.begin(), found.end());
+                for (const auto& idStr : ids) {
+                    optional<Entity> entity = LoadEntity(ConvertFromString<ID>(idStr));
+                    if (entity.has_value() && !visitor(entity.value())) {
+                        return;
                     }
                 }
+                return;
+            }
+        }
+        FileManagerSession session(fileManager);
+        ScanEntities(visitor);
+    }
+
+    // Visit the entities for which matches holds, testing it on a projection of each record first
+    // Without an index on fieldName, records are decoded with only fieldName and the primary key
+    // (Entity::DeserializeFields) and only matching ones are decoded in full. With materialize false the
+    // visitor gets the projection itself, enough to count, check existence or collect primary keys.
+    // Indexed fields and entities without projections visit full entities.
+    Protected Void ForEachMatching(CStdString& fieldName, CStdString& key, std::function<Bool(const Entity&)> matches,
+                                   std::function<Bool(const Entity&)> visitor, Bool materialize = true) {
+        if constexpr (HasProjection<Entity>::value) {
+            if (!IsIndexedField(fieldName)) {
+                auto operation = TrackOperation(RepositoryOperation::Query);
+                RecoverJournal();
+                FlushWriteBehind();
+                auto lock = LockStorageShared();
+                FileManagerSession session(fileManager);
                 
-                CStdString idStrRef = idStr;
-                fileManager->Append(idsFilePathRef, idStrRef);
+                Vector<StdString> fields{fieldName, Entity::GetPrimaryKeyName()};
+                ScanRecords([this, &fields, &matches, &visitor, materialize](const StdString& contents) {
+                    Entity projection = DecodeFields(contents, fields);
+                    if (!matches(projection)) {
+                        return true;
+                    }
+                    if (!materialize) {
+                        return visitor(projection);
+                    }
+                    Entity entity;
+                    return !DecodeEntity(contents, entity) || visitor(entity);
+                });
+                return;
             }
         }
-        
-        return entity;
+        ForEachMatching(fieldName, key, [&matches, &visitor](const Entity& entity) {
+            return !matches(entity) || visitor(entity);
+        });
     }
 
-    // Delete: Delete entity by ID
-    Public Virtual Void DeleteById(ID id) override {
-        // Check if entity exists before attempting to delete
-        if (!ExistsById(id)) {
-            // Entity doesn't exist, nothing to delete
-            return;
+    // Check if a field is /* @Indexed */
+    Protected Static Bool IsIndexedField(CStdString& fieldName) {
+        if constexpr (HasIndexes<Entity>::value) {
+            for (const auto& indexedField : Entity::GetIndexedFields()) {
+                if (indexedField == fieldName) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Primary key of an entity seen through a const reference (e.g. inside a ForEach visitor)
+    Protected Static optional<ID> PrimaryKeyOf(const Entity& entity) {
+        if constexpr (HasConstPrimaryKey<Entity>::value) {
+            return entity.GetPrimaryKey();
+        } else {
+            Entity copy = entity;
+            return copy.GetPrimaryKey();
+        }
+    }
+
+    // Read and decode the entity for an ID, serving it from the entity cache when possible
+    Protected optional<Entity> LoadEntity(ID id) {
+        optional<Entity> cached = entityCache.Get(id);
+        if (cached.has_value()) {
+            return cached;
         }
         
-        // Construct file path
-        StdString filePath = GetFilePath(id);
-        
-        // Delete file using file manager
-        CStdString filePathRef = filePath;
-        fileManager->Delete(filePathRef);
+        StdString contents = ReadRecord(id);
+        Entity entity;
+        if (contents.empty() || !DecodeEntity(contents, entity)) {
+            return std::nullopt;
+        }
         
-        // Remove ID from IDs file
-        Vector<ID> ids = ReadAllIds();
-        Vector<ID> updatedIds;
-        for (const auto& existingId : ids) {
-            if (existingId != id) {
-                updatedIds.push_back(existingId);
+        entityCache.Put(id, entity);
+        return entity;
+    }
+
+    // Write an encoded entity and keep the entity cache in step (a failed write must not stay cached)
+    Protected Bool StoreEntity(ID id, const Entity& entity, CStdString& contents) {
+        if (WriteRecord(id, contents)) {
+            entityCache.Put(id, entity);
+            return true;
+        }
+        entityCache.Erase(id);
+        return false;
+    }
+
+    // Encode an entity for storage (binary for /* @BinaryStorage */ entities, JSON otherwise)
+    Protected StdString EncodeEntity(const Entity& entity) {
+        StdString contents;
+        EncodeEntity(entity, contents);
+        return contents;
+    }
+
+    // Encode an entity into a reused buffer; entities generated with Serialize(output) keep its capacity
+    Protected Void EncodeEntity(const Entity& entity, StdString& contents) {
+        CodecScope codec(repositoryStats, true);
+        if constexpr (HasBinaryStorage<Entity>::value) {
+            contents = entity.SerializeBinary();
+        } else if constexpr (HasBufferedSerialize<Entity>::value) {
+            entity.Serialize(contents);
+        } else {
+            contents = entity.Serialize();
+        }
+    }
+
+    // Decode stored contents; records written before an entity switched to binary are still read as JSON
+    // Stored records were validated when they were saved, so entities that provide DeserializeTrusted()
+    // skip the validation pass and report a record that doesn't parse by returning false instead of throwing.
+    Protected Bool DecodeEntity(const StdString& contents, Entity& entity) {
+        CodecScope codec(repositoryStats, false);
+        if constexpr (HasTrustedDecode<Entity>::value) {
+            return Entity::DeserializeTrusted(contents, entity);
+        } else {
+            if constexpr (HasBinaryStorage<Entity>::value) {
+                if (BinaryReader::IsBinaryRecord(contents)) {
+                    entity = Entity::DeserializeBinary(contents);
+                    return true;
+                }
             }
+            entity = Entity::Deserialize(contents);
+            return true;
         }
-        WriteAllIds(updatedIds);
     }
 
-    // Delete: Delete an entity
-    Public Virtual Void Delete(Entity& entity) override {
-        // Get ID from entity
-        optional<ID> id = entity.GetPrimaryKey();
-        
-        if(id.has_value()) {
-            // Use DeleteById to delete
-            DeleteById(id.value());
+    // Decode only the given fields of stored contents (binary records, cheap to decode, are decoded in full)
+    Protected Entity DecodeFields(const StdString& contents, const Vector<StdString>& fields) {
+        if constexpr (HasBinaryStorage<Entity>::value) {
+            if (BinaryReader::IsBinaryRecord(contents)) {
+                Entity entity;
+                DecodeEntity(contents, entity);
+                return entity;
+            }
         }
+        CodecScope codec(repositoryStats, false);
+        return Entity::DeserializeFields(contents, fields);
     }
 
-    // Check if entity exists by ID
-    Public Virtual Bool ExistsById(ID id) override {
-        // Check if the entity file exists (more reliable than checking IDs file)
-        StdString filePath = GetFilePath(id);
-        CStdString filePathRef = filePath;
-        StdString contents = fileManager->Read(filePathRef);
-        return !contents.empty();
+    // Count a public operation until the returned scope ends (nested operations are part of the outer one)
+    Protected OperationScope<Entity> TrackOperation(RepositoryOperation operation) {
+        return OperationScope<Entity>(repositoryStats, operation);
+    }
+
+    // Whether operations take the table lock: always in concurrency-safe mode, otherwise only
+    // while a write-behind worker may flush concurrently
+    Protected Bool IsLocking() const {
+        #if CPA_REPOSITORY_THREAD_SAFE
+            return true;
+        #else
+            return writeBehind.IsRunning();
+        #endif
+    }
+    
+    // Hold the table lock exclusively (writes)
+    Protected TableLockGuard<Entity> LockStorage() {
+        TableLockGuard<Entity> lock(true, IsLocking());
+        SyncWithTable();
+        return lock;
+    }
+    
+    // Hold the table lock shared with other readers
+    Protected TableLockGuard<Entity> LockStorageShared() {
+        TableLockGuard<Entity> lock(false, IsLocking());
+        SyncWithTable();
+        return lock;
+    }
+
+    // Drop the loaded state if another instance wrote the table since this one last saw it
+    // Called with the table lock held; readers sharing it race here, so the reset runs under initMutex.
+    // Everything dropped is loaded again lazily, and operations in progress work on copies of it.
+    Protected Void SyncWithTable() {
+        uint32_t version = TableLock<Entity>::Version().load(std::memory_order_acquire);
+        if (seenVersion.load(std::memory_order_acquire) == version) {
+            return;
+        }
+        RepositoryLock<RepositoryRecursiveMutex> init(initMutex);
+        if (seenVersion.load(std::memory_order_relaxed) == version) {
+            return;
+        }
+        idIndex.Clear();
+        entityCache.Clear();
+        secondaryIndexesReady.store(false, std::memory_order_release);
+        secondaryIndexes.clear();
+        InvalidateStorage();
+        seenVersion.store(version, std::memory_order_release);
+    }
+
+    // Record a write to the table so other instances reload (this one is in sync with its own writes)
+    Protected Void NoteTableWrite() {
+        seenVersion.store(TableLock<Entity>::Version().fetch_add(1, std::memory_order_acq_rel) + 1,
+                          std::memory_order_release);
+    }
+
+    // Storage hook: drop engine caches another instance's writes made stale (see SyncWithTable)
+    Protected Virtual Void InvalidateStorage() {
+    }
+
+    // Flush once a write brought the queue to its maximum depth, otherwise wake the worker
+    Protected Void OnWriteQueued(size_t depth) {
+        if (depth >= writeBehind.GetMaxDepth()) {
+            FlushWriteBehind();
+        } else {
+            writeBehind.Notify();
+        }
+    }
+
+    // Apply all queued writes: one batched store of the saved entities and one batched delete
+    // Writes storage refuses go back in the queue (behind any newer write of the same ID) and are
+    // retried by the next flush; returns false if there were any.
+    // Skipped when called inside a read (e.g. FindAll from a ForEach visitor): the shared lock
+    // can't be upgraded and the outer call already flushed
+    Protected Bool FlushWriteBehind() {
+        if (TableLock<Entity>::IsHeldShared()) {
+            return true;
+        }
+        auto operation = TrackOperation(RepositoryOperation::Flush);
+        auto lock = LockStorage();
+        Vector<Entity> saved;
+        Vector<ID> removed;
+        writeBehind.TakeAll(saved, removed);
+        Vector<size_t> failedSaves;
+        Vector<size_t> failedRemoves;
+        Bool stored = saved.empty() || StoreEntities(saved, nullptr, &failedSaves);
+        Bool deleted = removed.empty() || RemoveEntities(removed, &failedRemoves);
+        for (size_t i : failedSaves) {
+            writeBehind.Restore(PrimaryKeyOf(saved[i]).value(), saved[i]);
+        }
+        for (size_t i : failedRemoves) {
+            writeBehind.Restore(removed[i], std::nullopt);
+        }
+        return stored && deleted;
+    }
+
+    // Stop the worker and write out whatever is still queued
+    Protected Void StopWriteBehind() {
+        writeBehind.Stop();
+        FlushWriteBehind();
+    }
+
+    // Save the preload set from Flush() (force = false, rate-limited) or the destructor (force = true)
+    // Skipped while nothing is cached: an empty cache says nothing about what the next boot will need
+    Protected Void AutoSavePreloadSet(Bool force) {
+        #if CPA_REPOSITORY_PRELOAD_SAVE_INTERVAL_MS > 0
+            if (!entityCache.IsEnabled()) {
+                return;
+            }
+            uint32_t now = NowMillis();
+            if (!force && preloadSaved.load() &&
+                now - preloadSavedAt.load() < static_cast<uint32_t>(CPA_REPOSITORY_PRELOAD_SAVE_INTERVAL_MS)) {
+                return;
+            }
+            if (GetCacheStats().size == 0) {
+                return;
+            }
+            if (SavePreloadSet()) {
+                preloadSavedAt.store(now);
+                preloadSaved.store(true);
+            }
+        #else
+            (void)force;
+        #endif
+    }
+
+    // Milliseconds of a monotonic clock (wraps; compare differences only)
+    Protected Static uint32_t NowMillis() {
+        #ifdef ARDUINO
+            return static_cast<uint32_t>(millis());
+        #else
+            return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        #endif
+    }
+
+    // Wait for a PreloadAsync() in progress to finish
+    Protected Void WaitForPreload() {
+        preloadTask.Wait();
+    }
+
+    // Store several entities with one storage session and one IDs append
+    // encoded, if given, holds the already encoded contents of each entity (e.g. from the journal)
+    // Entities whose record storage refuses are neither indexed nor listed; their positions go to
+    // failed, if given. Returns false if any record, or the IDs append, failed (counted in writeFailures).
+    Protected Bool StoreEntities(Vector<Entity>& entities, const Vector<StdString>* encoded = nullptr,
+                                 Vector<size_t>* failed = nullptr) {
+        FileManagerSession session(fileManager);
+        
+        NoteTableWrite();
+        Bool ok = true;
+        Vector<ID> newIds;
+        Vector<size_t> newPositions;
+        for (size_t i = 0; i < entities.size(); i++) {
+            Entity& entity = entities[i];
+            optional<ID> generatedId = entity.GetPrimaryKey();
+            if (!generatedId.has_value()) {
+                continue;
+            }
+            ID id = generatedId.value();
+            optional<Entity> previous = ReadIndexedEntity(id);
+            
+            Bool stored;
+            if (encoded != nullptr) {
+                stored = StoreEntity(id, entity, (*encoded)[i]);
+            } else {
+                EncodeEntity(entity, encodeBuffer);
+                stored = StoreEntity(id, entity, encodeBuffer);
+            }
+            if (!stored) {
+                ok = false;
+                if (failed != nullptr) {
+                    failed->push_back(i);
+                }
+                continue;
+            }
+            UpdateSecondaryIndexes(id, previous, &entity);
+            
+            // Collect IDs not yet in the IDs file (also skips duplicates within the batch)
+            #if CPA_REPOSITORY_ID_INDEX != CPA_ID_INDEX_NONE
+                if (!IdExistsInFile(id)) {
+                    newIds.push_back(id);
+                    newPositions.push_back(i);
+                    AddIdToIndex(id);
+                }
+            #else
+                if (!IdExistsInFile(id) && std::find(newIds.begin(), newIds.end(), id) == newIds.end()) {
+                    newIds.push_back(id);
+                    newPositions.push_back(i);
+                }
+            #endif
+        }
+        
+        // Records of IDs that couldn't be listed stay unreachable until they are stored again
+        if (!AppendIds(newIds)) {
+            ok = false;
+            #if CPA_REPOSITORY_ID_INDEX != CPA_ID_INDEX_NONE
+                if (idIndex.IsLoaded()) {
+                    for (const auto& id : newIds) {
+                        idIndex.Erase(id);
+                    }
+                }
+            #endif
+            if (failed != nullptr) {
+                failed->insert(failed->end(), newPositions.begin(), newPositions.end());
+            }
+        }
+        if (!ok) {
+            writeFailures.fetch_add(1, std::memory_order_relaxed);
+        }
+        return ok;
+    }
+
+    // Delete several entities with one storage session and one IDs rewrite
+    // IDs whose record storage refuses to remove stay listed and indexed; their positions go to failed,
+    // if given. Returns false if any removal, or the IDs rewrite, failed (counted in writeFailures).
+    Protected Bool RemoveEntities(const Vector<ID>& ids, Vector<size_t>* failed = nullptr) {
+        FileManagerSession session(fileManager);
+        
+        NoteTableWrite();
+        Bool ok = true;
+        Vector<ID> removedIds;
+        for (size_t i = 0; i < ids.size(); i++) {
+            ID id = ids[i];
+            if (!RecordExists(id)) {
+                continue;
+            }
+            optional<Entity> previous = ReadIndexedEntity(id);
+            if (!RemoveRecord(id)) {
+                ok = false;
+                if (failed != nullptr) {
+                    failed->push_back(i);
+                }
+                continue;
+            }
+            entityCache.Erase(id);
+            removedIds.push_back(id);
+            UpdateSecondaryIndexes(id, previous, nullptr);
+        }
+        
+        // IDs left listed without a record are skipped by reads
+        if (!RemoveIds(removedIds)) {
+            ok = false;
+        }
+        if (!ok) {
+            writeFailures.fetch_add(1, std::memory_order_relaxed);
+        }
+        return ok;
+    }
+
+    // Buffer a write in the open transaction; false if there is none
+    // A transaction of another thread is waited out on the table lock, then this write goes to storage
+    Protected Bool BufferInTransaction(ID id, const optional<Entity>& entity) {
+        if (!transactionOpen.load()) {
+            return false;
+        }
+        auto lock = LockStorage();
+        if (!transactionOpen.load()) {
+            return false;
+        }
+        if (entity.has_value()) {
+            transaction.Put(id, entity.value());
+        } else {
+            transaction.Remove(id);
+        }
+        return true;
+    }
+
+    // Replay the journal of a commit that was interrupted before it was dropped (first operation only)
+    // A journal without its commit record was torn while being written; nothing of it was applied.
+    // A journal storage refused to apply is kept, and replayed again by the next operation.
+    // Skipped inside a read of another repository of the table: the shared lock can't be upgraded.
+    Protected Void RecoverJournal() {
+        if (journalChecked.load(std::memory_order_acquire) || TableLock<Entity>::IsHeldShared()) {
+            return;
+        }
+        // The exclusive table lock serializes the check (taken before initMutex, like every operation)
+        auto lock = LockStorage();
+        if (journalChecked.load(std::memory_order_relaxed)) {
+            return;
+        }
+        
+        CStdString& journalFilePath = GetJournalFilePath();
+        StdString journal;
+        if (fileManager->Read(journalFilePath, journal)) {
+            Vector<Entity> saved;
+            Vector<StdString> encoded;
+            Vector<ID> removed;
+            Bool committed = false;
+            size_t position = 0;
+            LogRecord record;
+            while (LogRecordCodec::ParseNext(journal, position, record)) {
+                position += record.length;
+                if (record.type == LOG_RECORD_COMMIT) {
+                    committed = true;
+                    break;
+                }
+                ID id = ConvertFromString<ID>(journal.substr(record.idOffset, record.idLength));
+                if (record.type == LOG_RECORD_PUT) {
+                    Entity entity;
+                    StdString contents = journal.substr(record.payloadOffset, record.payloadLength);
+                    if (DecodeEntity(contents, entity)) {
+                        saved.push_back(std::move(entity));
+                        encoded.push_back(std::move(contents));
+                    }
+                } else {
+                    removed.push_back(id);
+                }
+            }
+            
+            if (committed && !ApplyCommit(saved, encoded, removed)) {
+                return;
+            }
+            fileManager->Delete(journalFilePath);
+        }
+        journalChecked.store(true, std::memory_order_release);
+    }
+
+    // Apply a journaled commit: one batched store and one batched delete in a single storage session
+    // (under batch durability the session end makes the whole group durable at once)
+    // Returns false if storage refused part of it; the journal must then be kept for a replay
+    Protected Bool ApplyCommit(Vector<Entity>& saved, const Vector<StdString>& encoded, const Vector<ID>& removed) {
+        FileManagerSession session(fileManager);
+        Bool stored = saved.empty() || StoreEntities(saved, &encoded);
+        Bool deleted = removed.empty() || RemoveEntities(removed);
+        return stored && deleted;
+    }
+
+    // Storage hooks
+    // The default layout keeps one file per entity plus a newline-delimited IDs file.
+    // Alternative engines (see LogCpaRepositoryImpl.h) override these and inherit everything else.
+
+    // Storage hook: read the serialized entity for an ID into a reused buffer (false if it doesn't exist)
+    // Desktop FindAll() calls it from several threads at once, after ReadAllIds()
+    Protected Virtual Bool ReadRecord(ID id, StdString& contents) {
+        StdString filePath = GetFilePath(id);
+        if (!fileManager->Read(filePath, contents)) {
+            return false;
+        }
+        // A record of another key sharing the hash is not this entity
+        if (!CheckRecordKey(id, contents)) {
+            contents.clear();
+            return false;
+        }
+        return !contents.empty();
+    }
+
+    // Read the serialized entity for an ID (empty if it doesn't exist)
+    Protected StdString ReadRecord(ID id) {
+        StdString contents;
+        ReadRecord(id, contents);
+        return contents;
+    }
+
+    // Storage hook: write (create or overwrite) the serialized entity for an ID
+    Protected Virtual Bool WriteRecord(ID id, CStdString& contents) {
+        StdString filePath = GetFilePath(id);
+        #if CPA_REPOSITORY_KEY_CHECK
+            // Never overwrite the record of a colliding key; new records carry their key
+            if (!StoredKeyMatches(id, filePath)) {
+                return false;
+            }
+            StdString record = GetRecordKeyHeader(id);
+            record += contents;
+            return fileManager->Create(filePath, record);
+        #else
+            return fileManager->Create(filePath, contents);
+        #endif
+    }
+
+    // Storage hook: remove the serialized entity for an ID
+    Protected Virtual Bool RemoveRecord(ID id) {
+        StdString filePath = GetFilePath(id);
+        #if CPA_REPOSITORY_KEY_CHECK
+            if (!StoredKeyMatches(id, filePath)) {
+                return false;
+            }
+        #endif
+        return fileManager->Delete(filePath);
+    }
+
+    // Storage hook: check if a serialized entity exists for an ID
+    Protected Virtual Bool RecordExists(ID id) {
+        // Check if the entity file exists (more reliable than checking IDs file), without reading it
+        StdString filePath = GetFilePath(id);
+        #if CPA_REPOSITORY_KEY_CHECK
+            // The file may belong to a colliding key, which only its header tells
+            return fileManager->Exists(filePath) && StoredKeyMatches(id, filePath);
+        #else
+            return fileManager->Exists(filePath);
+        #endif
+    }
+
+    // Key header written in front of records in collision-checked mode
+    Protected StdString GetRecordKeyHeader(ID id) {
+        StdString header(1, CPA_RECORD_KEY_MARKER);
+        header += GetRecordKey(id);
+        header += CPA_RECORD_KEY_END;
+        return header;
+    }
+
+    // Strip the key header from record contents, checking it names this ID
+    // Records without a header (written in unchecked mode) pass; a mismatch is counted as a collision
+    Protected Bool CheckRecordKey(ID id, StdString& contents) {
+        if (contents.empty() || contents[0] != CPA_RECORD_KEY_MARKER) {
+            return true;
+        }
+        size_t end = contents.find(CPA_RECORD_KEY_END, 1);
+        if (end == StdString::npos) {
+            return true;
+        }
+        
+        Bool matches = std::string_view(contents).substr(1, end - 1) == GetRecordKey(id);
+        if (!matches) {
+            keyCollisions.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        contents.erase(0, end + 1);
+        return true;
+    }
+
+    // Check that the file at filePath, if any, holds the record of this ID (counts a collision if not)
+    Protected Bool StoredKeyMatches(ID id, CStdString& filePath) {
+        StdString stored;
+        if (!fileManager->Read(filePath, stored)) {
+            return true;
+        }
+        return CheckRecordKey(id, stored);
+    }
+
+    #ifdef CPA_REPOSITORY_PARALLEL_FIND_ALL
+    // Number of threads FindAll() uses for a table of count entities (1 = serial)
+    Protected Static size_t ParallelThreadCount(size_t count) {
+        if (CPA_REPOSITORY_PARALLEL_MIN_ENTITIES == 0 || count < CPA_REPOSITORY_PARALLEL_MIN_ENTITIES) {
+            return 1;
+        }
+        size_t threads = CPA_REPOSITORY_PARALLEL_THREADS;
+        if (threads == 0) {
+            threads = std::thread::hardware_concurrency();
+        }
+        // Keep every slice at least half the threshold, so small tables don't pay for idle threads
+        size_t maxThreads = std::max<size_t>(1, count / std::max<size_t>(1, CPA_REPOSITORY_PARALLEL_MIN_ENTITIES / 2));
+        return std::max<size_t>(1, std::min(threads, maxThreads));
+    }
+    
+    // Run work over [0, count) in contiguous slices, one per thread (inline for small counts)
+    // get() rethrows an exception thrown by any slice; the slices' I/O and decoding is counted
+    // towards the calling thread's operation
+    Protected Static Void ForEachSlice(size_t count, const std::function<Void(size_t, size_t)>& work) {
+        size_t threads = ParallelThreadCount(count);
+        if (threads <= 1) {
+            work(0, count);
+            return;
+        }
+        
+        Vector<std::future<Void>> slices;
+        size_t sliceSize = (count + threads - 1) / threads;
+        Vector<WorkerStats> sliceStats((count + sliceSize - 1) / sliceSize);
+        slices.reserve(sliceStats.size());
+        for (size_t begin = 0, slice = 0; begin < count; begin += sliceSize, slice++) {
+            size_t end = std::min(begin + sliceSize, count);
+            WorkerStats* stats = &sliceStats[slice];
+            slices.push_back(std::async(std::launch::async, [&work, begin, end, stats]() {
+                stats->Collect([&work, begin, end]() { work(begin, end); });
+            }));
+        }
+        for (auto& slice : slices) {
+            slice.get();
+        }
+        for (const auto& stats : sliceStats) {
+            stats.Merge();
+        }
+    }
+    #endif
+
+    // Storage hook: visit all stored entities (the caller holds the table lock and a storage session)
+    Protected Virtual Void ScanEntities(std::function<Bool(const Entity&)> visitor) {
+        // Read all IDs from the IDs file
+        Vector<ID> ids = ReadAllIds();
+        
+        // For each ID, read and deserialize the entity (one record buffer reused for the whole scan)
+        // Records that don't decode are skipped
+        StdString contents;
+        Entity entity;
+        for (const auto& id : ids) {
+            if (ReadRecord(id, contents) && DecodeEntity(contents, entity)) {
+                if (!visitor(entity)) {
+                    return;
+                }
+            }
+        }
+    }
+
+    // Storage hook: visit the stored contents of all entities without decoding them
+    // (the caller holds the table lock and a storage session; contents is only valid during the call)
+    Protected Virtual Void ScanRecords(std::function<Bool(const StdString&)> visitor) {
+        Vector<ID> ids = ReadAllIds();
+        StdString contents;
+        for (const auto& id : ids) {
+            if (ReadRecord(id, contents) && !visitor(contents)) {
+                return;
+            }
+        }
+    }
+
+    // Storage hook: load what the first requests after boot would otherwise read (Preload() holds the exclusive lock)
+    Protected Virtual Void WarmStorage() {
+        #if CPA_REPOSITORY_ID_INDEX != CPA_ID_INDEX_NONE
+            EnsureIdIndexLoaded();
+        #endif
+        EnsureSecondaryIndexesLoaded();
+    }
+
+    // Storage hook: record new IDs in the IDs file (one append for the whole batch)
+    // Returns false if the IDs couldn't be recorded
+    Protected Virtual Bool AppendIds(const Vector<ID>& ids) {
+        if (ids.empty()) {
+            return true;
+        }
+        
+        CStdString& idsFilePath = GetIdsFilePath();
+        if constexpr (HasBinaryIds()) {
+            return AppendBinaryIds(ids);
+        }
+        StdString idStr;
+        for (const auto& id : ids) {
+            idStr += ConvertToString(id);
+            idStr += StdString("\n");
+        }
+        if (!fileManager->Append(idsFilePath, idStr)) {
+            return false;
+        }
+        // Record the lines the IDs landed on, which order pages served from the index
+        #if CPA_REPOSITORY_ID_INDEX != CPA_ID_INDEX_NONE
+            if (idIndex.IsLoaded()) {
+                uint32_t line = idIndex.NextSlot();
+                for (const auto& id : ids) {
+                    idIndex.Insert(id, line++);
+                }
+            }
+        #endif
+        return true;
+    }
+
+    // Append slots for new IDs to a binary IDs file, recording their slots in the ID index once written
+    // A torn last slot would shift every later one, so such a file is rewritten first
+    Protected Bool AppendBinaryIds(const Vector<ID>& ids) {
+        if (!EnsureBinaryIdsFile()) {
+            return false;
+        }
+        CStdString& idsFilePath = GetIdsFilePath();
+        size_t size = fileManager->Size(idsFilePath);
+        if (size != 0 && BinaryIdsCodec<ID>::SlotOffset(BinaryIdsCodec<ID>::SlotCount(size)) != size) {
+            if (!WriteAllIds(ReadIdsFile(nullptr))) {
+                return false;
+            }
+            size = fileManager->Size(idsFilePath);
+        }
+        
+        StdString slots;
+        slots.reserve(BINARY_IDS_HEADER_SIZE + ids.size() * BinaryIdsCodec<ID>::SlotSize);
+        if (size == 0) {
+            BinaryIdsCodec<ID>::AppendHeader(slots);
+        }
+        for (const auto& id : ids) {
+            BinaryIdsCodec<ID>::AppendSlot(slots, id);
+        }
+        if (!fileManager->Append(idsFilePath, slots)) {
+            return false;
+        }
+        if (idIndex.IsLoaded()) {
+            size_t slot = BinaryIdsCodec<ID>::SlotCount(size);
+            for (const auto& id : ids) {
+                idIndex.Insert(id, static_cast<uint32_t>(slot++));
+            }
+        }
+        return true;
+    }
+
+    // Tombstone the slots of removed IDs in place, compacting once tombstones outnumber live IDs
+    // Slots come from the ID index, checked against the file (another repository may have compacted it);
+    // IDs without a usable slot are found with one read of the file. IDs whose tombstone couldn't be
+    // written stay in the ID index (returns false); a failed compaction only leaves the tombstones.
+    Protected Bool RemoveBinaryIds(const Vector<ID>& ids) {
+        if (!EnsureBinaryIdsFile()) {
+            return false;
+        }
+        CStdString& idsFilePath = GetIdsFilePath();
+        Vector<std::pair<size_t, ID>> slots;
+        Vector<ID> unresolved;
+        for (const auto& id : ids) {
+            uint32_t slot = idIndex.IsLoaded() ? idIndex.SlotOf(id) : IdIndex<ID>::NoSlot;
+            if (slot != IdIndex<ID>::NoSlot &&
+                BinaryIdsCodec<ID>::IsLiveSlot(fileManager->ReadRange(idsFilePath, BinaryIdsCodec<ID>::SlotOffset(slot),
+                                                                      BinaryIdsCodec<ID>::SlotSize), id)) {
+                slots.push_back(std::make_pair(static_cast<size_t>(slot), id));
+            } else {
+                unresolved.push_back(id);
+            }
+        }
+        
+        size_t totalSlots = 0;
+        size_t liveSlots = 0;
+        if (!unresolved.empty()) {
+            std::sort(unresolved.begin(), unresolved.end());
+            StdString contents;
+            fileManager->Read(idsFilePath, contents);
+            BinaryIdsCodec<ID>::ForEachLive(contents, [&unresolved, &slots, &liveSlots](ID id, size_t slot) {
+                if (std::binary_search(unresolved.begin(), unresolved.end(), id)) {
+                    slots.push_back(std::make_pair(slot, id));
+                } else {
+                    liveSlots++;
+                }
+                return true;
+            });
+            totalSlots = BinaryIdsCodec<ID>::SlotCount(contents.length());
+        }
+        
+        Bool ok = true;
+        StdString tombstone(1, BINARY_IDS_TOMBSTONE);
+        for (const auto& slot : slots) {
+            if (!fileManager->WriteRange(idsFilePath, BinaryIdsCodec<ID>::SlotOffset(slot.first), tombstone)) {
+                ok = false;
+                liveSlots++;
+            } else if (idIndex.IsLoaded()) {
+                idIndex.Erase(slot.second);
+            }
+        }
+        if (idIndex.IsLoaded()) {
+            totalSlots = BinaryIdsCodec<ID>::SlotCount(fileManager->Size(idsFilePath));
+            liveSlots = idIndex.Size();
+        }
+        
+        size_t tombstones = totalSlots > liveSlots ? totalSlots - liveSlots : 0;
+        if (tombstones >= CPA_REPOSITORY_IDS_COMPACT_MIN && tombstones >= liveSlots) {
+            WriteAllIds(ReadIdsFile(nullptr));
+        }
+        return ok;
+    }
+
+    // Storage hook: remove IDs from the IDs file (one read and one rewrite for the whole batch)
+    // Returns false if the IDs couldn't be removed
+    Protected Virtual Bool RemoveIds(const Vector<ID>& ids) {
+        if (ids.empty()) {
+            return true;
+        }
+        
+        if constexpr (HasBinaryIds()) {
+            return RemoveBinaryIds(ids);
+        }
+        
+        Vector<ID> removed = ids;
+        std::sort(removed.begin(), removed.end());
+        
+        Vector<ID> existingIds = ReadAllIds();
+        Vector<ID> updatedIds;
+        updatedIds.reserve(existingIds.size());
+        for (const auto& existingId : existingIds) {
+            if (!std::binary_search(removed.begin(), removed.end(), existingId)) {
+                updatedIds.push_back(existingId);
+            }
+        }
+        return WriteAllIds(updatedIds);
+    }
+
+    // Create: Save a new entity
+    Public Virtual Entity Save(Entity& entity) override {
+        auto operation = TrackOperation(RepositoryOperation::Save);
+        RecoverJournal();
+        // Get generated ID (non-static method)
+        optional<ID> generatedId = entity.GetPrimaryKey();
+        
+        if(generatedId.has_value()) {
+            ID id = generatedId.value();
+            
+            // Transaction: buffer the entity until Commit
+            if (BufferInTransaction(id, entity)) {
+                return entity;
+            }
+            
+            // Write-behind: queue the entity and return without touching storage
+            if (writeBehind.IsEnabled()) {
+                OnWriteQueued(writeBehind.Put(id, entity));
+                return entity;
+            }
+            
+            // Entity write and IDs append share one storage session
+            auto lock = LockStorage();
+            FileManagerSession session(fileManager);
+            optional<Entity> previous = ReadIndexedEntity(id);
+            
+            // Serialize entity (non-static method)
+            EncodeEntity(entity, encodeBuffer);
+            
+            // Save to storage
+            NoteTableWrite();
+            if (!StoreEntity(id, entity, encodeBuffer)) {
+                writeFailures.fetch_add(1, std::memory_order_relaxed);
+                return entity;
+            }
+            
+            // Append ID to IDs file if it doesn't already exist
+            if (!IdExistsInFile(id)) {
+                if (AppendIds(Vector<ID>(1, id))) {
+                    AddIdToIndex(id);
+                } else {
+                    writeFailures.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            
+            UpdateSecondaryIndexes(id, previous, &entity);
+        }
+        
+        return entity;
+    }
+
+    // Read: Find entity by ID
+    Public Virtual optional<Entity> FindById(ID id) override {
+        auto operation = TrackOperation(RepositoryOperation::FindById);
+        RecoverJournal();
+        // Taken first, so another thread's transaction is waited out rather than read
+        auto lock = LockStorageShared();
+        // A write buffered by the transaction, then a queued write, is the latest state of the entity
+        optional<Entity> pending;
+        if (transactionOpen.load() && transaction.Lookup(id, pending)) {
+            return pending;
+        }
+        if (writeBehind.IsEnabled() && writeBehind.Lookup(id, pending)) {
+            return pending;
+        }
+        
+        // Cached entity, or read and deserialize the stored contents
+        return LoadEntity(id);
+    }
+    // Read: Find all entities
+    // On desktop, large tables are read and decoded in contiguous slices of the ID list, one per thread
+    Public Virtual Vector<Entity> FindAll() override {
+        auto operation = TrackOperation(RepositoryOperation::FindAll);
+        RecoverJournal();
+        Vector<Entity> entities;
+        #ifdef CPA_REPOSITORY_PARALLEL_FIND_ALL
+            FlushWriteBehind();
+            auto lock = LockStorageShared();
+            FileManagerSession session(fileManager);
+            
+            // Each slice fills its own range of the result, so the output keeps the IDs file order
+            Vector<ID> ids = ReadAllIds();
+            Vector<optional<Entity>> decoded(ids.size());
+            ForEachSlice(ids.size(), [this, &ids, &decoded](size_t begin, size_t end) {
+                StdString contents;
+                Entity entity;
+                for (size_t i = begin; i < end; i++) {
+                    if (ReadRecord(ids[i], contents) && DecodeEntity(contents, entity)) {
+                        decoded[i] = std::move(entity);
+                    }
+                }
+            });
+            
+            entities.reserve(ids.size());
+            for (auto& entity : decoded) {
+                if (entity.has_value()) {
+                    entities.push_back(std::move(entity.value()));
+                }
+            }
+        #else
+            ForEach([&entities](const Entity& entity) {
+                entities.push_back(entity);
+                return true;
+            });
+        #endif
+        return entities;
+    }
+
+    // Read: Find one page of entities in FindAll() order
+    // IDs whose record is missing are skipped, so a page can come back short
+    Public Virtual Vector<Entity> FindAll(size_t offset, size_t limit) override {
+        auto operation = TrackOperation(RepositoryOperation::FindPage);
+        RecoverJournal();
+        FlushWriteBehind();
+        auto lock = LockStorageShared();
+        FileManagerSession session(fileManager);
+        
+        Vector<ID> ids = ReadIdRange(offset, limit);
+        Vector<Entity> entities;
+        entities.reserve(ids.size());
+        for (const auto& id : ids) {
+            optional<Entity> entity = LoadEntity(id);
+            if (entity.has_value()) {
+                entities.push_back(std::move(entity.value()));
+            }
+        }
+        return entities;
+    }
+
+    // Read: Find one page of entities ordered by less
+    // A bounded max-heap keeps the offset + limit smallest entities seen so far during the scan
+    Public Virtual Vector<Entity> FindAll(size_t offset, size_t limit, std::function<Bool(const Entity&, const Entity&)> less) override {
+        auto operation = TrackOperation(RepositoryOperation::FindPage);
+        RecoverJournal();
+        Vector<Entity> entities;
+        size_t keep = limit > SIZE_MAX - offset ? SIZE_MAX : offset + limit;
+        if (limit == 0) {
+            return entities;
+        }
+        
+        ForEach([&entities, &less, keep](const Entity& entity) {
+            if (entities.size() < keep) {
+                entities.push_back(entity);
+                std::push_heap(entities.begin(), entities.end(), less);
+            } else if (less(entity, entities.front())) {
+                std::pop_heap(entities.begin(), entities.end(), less);
+                entities.back() = entity;
+                std::push_heap(entities.begin(), entities.end(), less);
+            }
+            return true;
+        });
+        
+        std::sort_heap(entities.begin(), entities.end(), less);
+        if (offset >= entities.size()) {
+            entities.clear();
+        } else {
+            entities.erase(entities.begin(), entities.begin() + offset);
+        }
+        return entities;
+    }
+
+    // Read: Visit all entities, reading and deserializing one record at a time
+    Public Virtual Void ForEach(std::function<Bool(const Entity&)> visitor) override {
+        auto operation = TrackOperation(RepositoryOperation::ForEach);
+        RecoverJournal();
+        // Queued writes go to storage first so the scan sees them
+        FlushWriteBehind();
+        auto lock = LockStorageShared();
+        
+        // Keep storage open across all reads
+        FileManagerSession session(fileManager);
+        ScanEntities(visitor);
+    }
+
+    // Update: Update an existing entity
+    Public Virtual Entity Update(Entity& entity) override {
+        auto operation = TrackOperation(RepositoryOperation::Update);
+        RecoverJournal();
+        // Get ID from entity
+        optional<ID> id = entity.GetPrimaryKey();
+        
+        if(id.has_value()) {
+            ID entityId = id.value();
+            
+            // Transaction: buffer the entity until Commit
+            if (BufferInTransaction(entityId, entity)) {
+                return entity;
+            }
+            
+            // Write-behind: queue the entity and return without touching storage
+            if (writeBehind.IsEnabled()) {
+                OnWriteQueued(writeBehind.Put(entityId, entity));
+                return entity;
+            }
+            
+            // Entity write and IDs append share one storage session
+            auto lock = LockStorage();
+            FileManagerSession session(fileManager);
+            optional<Entity> previous = ReadIndexedEntity(entityId);
+            
+            // Serialize entity
+            EncodeEntity(entity, encodeBuffer);
+            
+            // Update storage
+            NoteTableWrite();
+            if (!StoreEntity(entityId, entity, encodeBuffer)) {
+                writeFailures.fetch_add(1, std::memory_order_relaxed);
+                return entity;
+            }
+            
+            // Add ID to IDs file if it doesn't already exist (for Update on non-existent entity)
+            if (!IdExistsInFile(entityId)) {
+                if (AppendIds(Vector<ID>(1, entityId))) {
+                    AddIdToIndex(entityId);
+                } else {
+                    writeFailures.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            
+            UpdateSecondaryIndexes(entityId, previous, &entity);
+        }
+        
+        return entity;
+    }
+
+    // Delete: Delete entity by ID
+    Public Virtual Void DeleteById(ID id) override {
+        auto operation = TrackOperation(RepositoryOperation::DeleteById);
+        RecoverJournal();
+        // Transaction: buffer the delete until Commit (applied only if the entity exists then)
+        if (BufferInTransaction(id, std::nullopt)) {
+            return;
+        }
+        
+        // Write-behind: queue the delete (applied only if the entity exists when it is flushed)
+        if (writeBehind.IsEnabled()) {
+            OnWriteQueued(writeBehind.Remove(id));
+            return;
+        }
+        
+        // Existence check, delete and IDs rewrite share one storage session
+        auto lock = LockStorage();
+        FileManagerSession session(fileManager);
+        
+        // Check if entity exists before attempting to delete
+        if (!ExistsById(id)) {
+            // Entity doesn't exist, nothing to delete
+            return;
+        }
+        
+        // Delete stored contents
+        optional<Entity> previous = ReadIndexedEntity(id);
+        NoteTableWrite();
+        if (!RemoveRecord(id)) {
+            writeFailures.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        entityCache.Erase(id);
+        
+        // Remove ID from IDs file
+        if (!RemoveIds(Vector<ID>(1, id))) {
+            writeFailures.fetch_add(1, std::memory_order_relaxed);
+        }
+        UpdateSecondaryIndexes(id, previous, nullptr);
+    }
+
+    // Delete: Delete an entity
+    Public Virtual Void Delete(Entity& entity) override {
+        // Get ID from entity
+        optional<ID> id = entity.GetPrimaryKey();
+        
+        if(id.has_value()) {
+            // Use DeleteById to delete
+            DeleteById(id.value());
+        }
+    }
+
+    // Check if entity exists by ID
+    Public Virtual Bool ExistsById(ID id) override {
+        auto operation = TrackOperation(RepositoryOperation::ExistsById);
+        RecoverJournal();
+        // Taken first, so another thread's transaction is waited out rather than read
+        auto lock = LockStorageShared();
+        // A buffered or queued write decides: stored entity or pending delete
+        optional<Entity> pending;
+        if (transactionOpen.load() && transaction.Lookup(id, pending)) {
+            return pending.has_value();
+        }
+        if (writeBehind.IsEnabled() && writeBehind.Lookup(id, pending)) {
+            return pending.has_value();
+        }
+        
+        // A cached entity is known to exist without touching storage
+        if (entityCache.Contains(id)) {
+            return true;
+        }
+        return RecordExists(id);
+    }
+
+    // Create: Save several entities with one storage session and one IDs append
+    Public Virtual Vector<Entity> SaveAll(Vector<Entity>& entities) override {
+        auto operation = TrackOperation(RepositoryOperation::SaveAll);
+        RecoverJournal();
+        if (transactionOpen.load()) {
+            // Another thread's transaction is waited out on the table lock (see BufferInTransaction)
+            auto lock = LockStorage();
+            if (transactionOpen.load()) {
+                for (auto& entity : entities) {
+                    optional<ID> generatedId = entity.GetPrimaryKey();
+                    if (generatedId.has_value()) {
+                        BufferInTransaction(generatedId.value(), entity);
+                    }
+                }
+                return entities;
+            }
+        }
+        
+        if (writeBehind.IsEnabled()) {
+            size_t depth = 0;
+            for (auto& entity : entities) {
+                optional<ID> generatedId = entity.GetPrimaryKey();
+                if (generatedId.has_value()) {
+                    depth = writeBehind.Put(generatedId.value(), entity);
+                }
+            }
+            OnWriteQueued(depth);
+            return entities;
+        }
+        
+        auto lock = LockStorage();
+        StoreEntities(entities);
+        return entities;
+    }
+
+    // Read: Find the entities for several IDs with one storage session
+    Public Virtual Vector<Entity> FindAllById(const Vector<ID>& ids) override {
+        auto operation = TrackOperation(RepositoryOperation::FindAllById);
+        RecoverJournal();
+        FlushWriteBehind();
+        auto lock = LockStorageShared();
+        
+        Vector<Entity> entities;
+        entities.reserve(ids.size());
+        
+        FileManagerSession session(fileManager);
+        for (const auto& id : ids) {
+            optional<Entity> entity = LoadEntity(id);
+            if (entity.has_value()) {
+                entities.push_back(std::move(entity.value()));
+            }
+        }
+        
+        return entities;
+    }
+
+    // Delete: Delete several entities with one storage session and one IDs rewrite
+    Public Virtual Void DeleteAllById(const Vector<ID>& ids) override {
+        auto operation = TrackOperation(RepositoryOperation::DeleteAllById);
+        RecoverJournal();
+        if (transactionOpen.load()) {
+            // Another thread's transaction is waited out on the table lock (see BufferInTransaction)
+            auto lock = LockStorage();
+            if (transactionOpen.load()) {
+                for (const auto& id : ids) {
+                    BufferInTransaction(id, std::nullopt);
+                }
+                return;
+            }
+        }
+        
+        if (writeBehind.IsEnabled()) {
+            size_t depth = 0;
+            for (const auto& id : ids) {
+                depth = writeBehind.Remove(id);
+            }
+            OnWriteQueued(depth);
+            return;
+        }
+        
+        auto lock = LockStorage();
+        RemoveEntities(ids);
+    }
+
+    // Set the entity cache capacity, evicting entries that no longer fit (0 disables the cache)
+    Public Virtual Void SetCacheCapacity(size_t capacity) override {
+        auto lock = LockStorage();
+        entityCache.SetCapacity(capacity);
+    }
+
+    // Entity cache counters (all zero while the cache is disabled)
+    Public Virtual CacheStats GetCacheStats() override {
+        auto lock = LockStorageShared();
+        return entityCache.GetStats();
+    }
+
+    // Load the indexes, then the persisted most recently used entities behind whatever is already cached
+    // Each entity is one point read; IDs that no longer exist or don't decode are skipped
+    Public Virtual Void Preload(size_t maxEntities) override {
+        auto operation = TrackOperation(RepositoryOperation::Preload);
+        RecoverJournal();
+        {
+            // Building a missing secondary index writes it, so the indexes load under the exclusive lock
+            auto lock = LockStorage();
+            WarmStorage();
+        }
+        if (maxEntities == 0 || !entityCache.IsEnabled()) {
+            return;
+        }
+        
+        StdString contents;
+        if (!fileManager->Read(GetPreloadFilePath(), contents)) {
+            return;
+        }
+        Vector<ID> ids;
+        ParseTextIds(contents, ids);
+        if (ids.size() > maxEntities) {
+            ids.resize(maxEntities);
+        }
+        
+        auto lock = LockStorageShared();
+        FileManagerSession session(fileManager);
+        for (const auto& id : ids) {
+            if (entityCache.Holds(id)) {
+                continue;
+            }
+            Entity entity;
+            if (!ReadRecord(id, contents) || !DecodeEntity(contents, entity)) {
+                continue;
+            }
+            if (!entityCache.Warm(id, entity)) {
+                break;
+            }
+        }
+    }
+
+    // Preload on the background task; requests take the table lock as usual meanwhile
+    // Without concurrency-safe mode nothing else may run alongside it, so it preloads right here
+    // (documented on CpaRepository::PreloadAsync)
+    Public Virtual Void PreloadAsync(size_t maxEntities) override {
+        #if CPA_REPOSITORY_THREAD_SAFE
+            preloadTask.Run([this, maxEntities]() { Preload(maxEntities); });
+        #else
+            Preload(maxEntities);
+        #endif
+    }
+
+    // Write the cached IDs, most recently used first, one per line (the file is removed while the cache is empty)
+    Public Virtual Bool SavePreloadSet() override {
+        Vector<ID> ids;
+        {
+            auto lock = LockStorageShared();
+            ids = entityCache.RecentIds(entityCache.GetStats().capacity);
+        }
+        
+        CStdString& preloadFilePath = GetPreloadFilePath();
+        if (ids.empty()) {
+            if (fileManager->Exists(preloadFilePath)) {
+                fileManager->Delete(preloadFilePath);
+            }
+            return true;
+        }
+        StdString contents;
+        for (const auto& id : ids) {
+            contents += ConvertToString(id);
+            contents += "\n";
+        }
+        return fileManager->Create(preloadFilePath, contents);
+    }
+
+    // Enable write-behind with at most maxQueueDepth pending writes (0 flushes and disables it)
+    // Reaching the depth flushes synchronously in the writing call
+    Public Virtual Void SetWriteBehind(size_t maxQueueDepth) override {
+        if (maxQueueDepth == 0) {
+            writeBehind.Stop();
+            writeBehind.SetMaxDepth(0);
+            FlushWriteBehind();
+            return;
+        }
+        
+        writeBehind.SetMaxDepth(maxQueueDepth);
+        writeBehind.Start([this]() { FlushWriteBehind(); });
+    }
+
+    // Write all queued writes to storage now; writes storage refuses stay queued
+    // Also saves the preload set, at most every CPA_REPOSITORY_PRELOAD_SAVE_INTERVAL_MS
+    Public Virtual Bool Flush() override {
+        Bool flushed = FlushWriteBehind();
+        AutoSavePreloadSet(false);
+        return flushed;
+    }
+
+    // Start buffering writes until Commit or Rollback (no-op while a transaction is open)
+    // The table's writer lock is held until the transaction ends; a transaction of another thread is
+    // waited out first
+    Public Virtual Void Begin() override {
+        RecoverJournal();
+        auto lock = LockStorage();
+        if (transactionOpen.load()) {
+            return;
+        }
+        transactionLock.emplace(std::move(lock));
+        transactionOpen.store(true);
+    }
+
+    // Journal the buffered writes in one file write, apply them in one pass, then drop the journal
+    // The journal is written outside the apply session so it is durable before any record changes.
+    // The transaction ends only once its journal is written; until then its writes stay buffered.
+    // A journal storage refused to apply is kept and replayed by the next operation (see RecoverJournal).
+    Public Virtual Bool Commit() override {
+        auto operation = TrackOperation(RepositoryOperation::Commit);
+        RecoverJournal();
+        if (!transactionOpen.load()) {
+            return true;
+        }
+        Bool ended = false;
+        Bool committed = CommitTransaction(ended);
+        // Released only after CommitTransaction's own hold of the lock
+        if (ended) {
+            transactionLock.reset();
+        }
+        return committed;
+    }
+
+    // Body of Commit; ended is set once the transaction is over
+    Protected Bool CommitTransaction(Bool& ended) {
+        // Writes queued before the transaction go to storage first
+        FlushWriteBehind();
+        auto lock = LockStorage();
+        if (!transactionOpen.load()) {
+            return true;
+        }
+        // An earlier commit's journal still waits for its replay; writing ours would replace it
+        if (!journalChecked.load(std::memory_order_acquire)) {
+            return false;
+        }
+        
+        Vector<Entity> saved;
+        Vector<ID> removed;
+        transaction.TakeAll(saved, removed);
+        if (saved.empty() && removed.empty()) {
+            transactionOpen.store(false);
+            ended = true;
+            return true;
+        }
+        
+        Vector<StdString> encoded;
+        encoded.reserve(saved.size());
+        StdString journal;
+        for (const auto& entity : saved) {
+            encoded.push_back(EncodeEntity(entity));
+            LogRecordCodec::AppendPut(journal, ConvertToString(PrimaryKeyOf(entity).value()), encoded.back());
+        }
+        for (const auto& id : removed) {
+            LogRecordCodec::AppendDelete(journal, ConvertToString(id));
+        }
+        LogRecordCodec::AppendCommit(journal);
+        
+        CStdString& journalFilePath = GetJournalFilePath();
+        if (!fileManager->Create(journalFilePath, journal)) {
+            // Nothing reached storage: put the writes back (behind any buffered since) and stay open
+            for (const auto& entity : saved) {
+                transaction.Restore(PrimaryKeyOf(entity).value(), entity);
+            }
+            for (const auto& id : removed) {
+                transaction.Restore(id, std::nullopt);
+            }
+            return false;
+        }
+        transactionOpen.store(false);
+        ended = true;
+        if (ApplyCommit(saved, encoded, removed)) {
+            fileManager->Delete(journalFilePath);
+        } else {
+            journalChecked.store(false, std::memory_order_release);
+        }
+        return true;
+    }
+
+    // Discard the buffered writes and end the transaction
+    Public Virtual Void Rollback() override {
+        if (!transactionOpen.load()) {
+            return;
+        }
+        {
+            auto lock = LockStorage();
+            if (!transactionOpen.load()) {
+                return;
+            }
+            Vector<Entity> saved;
+            Vector<ID> removed;
+            transaction.TakeAll(saved, removed);
+            transactionOpen.store(false);
+        }
+        transactionLock.reset();
+    }
+
+    // Number of hash collisions detected in collision-checked mode (always 0 otherwise)
+    Public Virtual size_t GetKeyCollisions() override {
+        return keyCollisions.load(std::memory_order_relaxed);
+    }
+
+    // Number of saves and deletes storage refused (queued writes are retried, so count each attempt)
+    Public Virtual size_t GetWriteFailures() override {
+        return writeFailures.load(std::memory_order_relaxed);
+    }
+
+    // Operation, storage, codec and cache counters (only cache counters unless CPA_REPOSITORY_STATS is enabled)
+    Public Virtual RepositoryStats GetStats() override {
+        RepositoryStats stats = repositoryStats.Snapshot();
+        stats.cache = GetCacheStats();
+        return stats;
+    }
+
+    // Zero the operation, storage and codec counters returned by GetStats()
+    Public Virtual Void ResetStats() override {
+        repositoryStats.Reset();
     }
 };
 
-#endif // _CPA_REPOSITORY_IMPL_H_   
\ No newline at end of file
+#endif // _CPA_REPOSITORY_IMPL_H_
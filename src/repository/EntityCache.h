@@ -0,0 +1,164 @@
+#ifndef _ENTITY_CACHE_H_
+#define _ENTITY_CACHE_H_
+
+#include <StandardDefines.h>
+#include "../CacheStats.h"
+#include "TableLock.h"
+#include <iterator>
+#include <list>
+#include <map>
+#include <optional>
+#include <utility>
+
+// Bounded LRU cache of deserialized entities, keyed by primary key
+// A capacity of 0 disables it: nothing is stored and no hits or misses are counted.
+// The repository keeps it coherent by writing through on Save/Update and erasing on Delete.
+// In concurrency-safe mode readers holding the shared table lock update it, so it has its own mutex.
+template<typename Entity, typename ID>
+class EntityCache {
+    // Most recently used entry first
+    Private std::list<std::pair<ID, Entity>> entries;
+    Private std::map<ID, typename std::list<std::pair<ID, Entity>>::iterator> positions;
+    Private size_t capacity;
+    Private CacheStats stats;
+    Private RepositoryMutex mutex;
+
+    Public explicit EntityCache(size_t maxEntries) : capacity(maxEntries) {
+    }
+
+    Public Bool IsEnabled() const {
+        return capacity > 0;
+    }
+
+    // Change the capacity, evicting least recently used entries that no longer fit
+    Public Void SetCapacity(size_t maxEntries) {
+        auto lock = Lock();
+        capacity = maxEntries;
+        Trim();
+    }
+
+    // Look up an entity, marking it most recently used (a copy, so it stays valid under concurrent use)
+    Public optional<Entity> Get(const ID& id) {
+        auto lock = Lock();
+        auto it = Find(id);
+        if (it == positions.end()) {
+            return std::nullopt;
+        }
+        return it->second->second;
+    }
+
+    // Check if an entity is cached, counting and touching it like Get()
+    Public Bool Contains(const ID& id) {
+        auto lock = Lock();
+        return Find(id) != positions.end();
+    }
+
+    // Insert or replace an entity, marking it most recently used
+    Public Void Put(const ID& id, const Entity& entity) {
+        auto lock = Lock();
+        if (!IsEnabled()) {
+            return;
+        }
+
+        auto it = positions.find(id);
+        if (it != positions.end()) {
+            it->second->second = entity;
+            entries.splice(entries.begin(), entries, it->second);
+            return;
+        }
+
+        entries.emplace_front(id, entity);
+        positions.insert(std::make_pair(id, entries.begin()));
+        Trim();
+    }
+
+    // Insert an entity preloaded at startup behind everything already cached (least recently used)
+    // Entries put by requests are never replaced or evicted by it; returns false once the cache is full
+    Public Bool Warm(const ID& id, const Entity& entity) {
+        auto lock = Lock();
+        if (entries.size() >= capacity) {
+            return false;
+        }
+        if (positions.find(id) == positions.end()) {
+            entries.emplace_back(id, entity);
+            positions.insert(std::make_pair(id, std::prev(entries.end())));
+        }
+        return true;
+    }
+
+    // Check if an entity is cached without touching it or counting a hit or miss
+    Public Bool Holds(const ID& id) {
+        auto lock = Lock();
+        return positions.find(id) != positions.end();
+    }
+
+    // IDs of at most maxEntries cached entities, most recently used first (nothing is touched)
+    Public Vector<ID> RecentIds(size_t maxEntries) {
+        auto lock = Lock();
+        Vector<ID> ids;
+        ids.reserve(maxEntries < entries.size() ? maxEntries : entries.size());
+        for (const auto& entry : entries) {
+            if (ids.size() >= maxEntries) {
+                break;
+            }
+            ids.push_back(entry.first);
+        }
+        return ids;
+    }
+
+    // Drop an entity (after it was deleted or a write of it failed)
+    Public Void Erase(const ID& id) {
+        auto lock = Lock();
+        auto it = positions.find(id);
+        if (it != positions.end()) {
+            entries.erase(it->second);
+            positions.erase(it);
+        }
+    }
+
+    Public Void Clear() {
+        auto lock = Lock();
+        entries.clear();
+        positions.clear();
+    }
+
+    // Counters since construction, with the current size and capacity
+    Public CacheStats GetStats() {
+        auto lock = Lock();
+        CacheStats current = stats;
+        current.size = entries.size();
+        current.capacity = capacity;
+        return current;
+    }
+
+    Private RepositoryLock<RepositoryMutex> Lock() {
+        return RepositoryLock<RepositoryMutex>(mutex, CPA_REPOSITORY_THREAD_SAFE != 0);
+    }
+
+    // Find an entry and mark it most recently used, counting the hit or miss (misses aren't counted while disabled)
+    Private typename std::map<ID, typename std::list<std::pair<ID, Entity>>::iterator>::iterator Find(const ID& id) {
+        if (!IsEnabled()) {
+            return positions.end();
+        }
+
+        auto it = positions.find(id);
+        if (it == positions.end()) {
+            stats.misses++;
+            return it;
+        }
+
+        stats.hits++;
+        entries.splice(entries.begin(), entries, it->second);
+        return it;
+    }
+
+    Private Void Trim() {
+        while (entries.size() > capacity) {
+            positions.erase(entries.back().first);
+            entries.pop_back();
+            stats.evictions++;
+        }
+    }
+};
+
+#endif // _ENTITY_CACHE_H_
@@ -0,0 +1,71 @@
+#ifndef _ENTITY_TRAITS_H_
+#define _ENTITY_TRAITS_H_
+
+#include <StandardDefines.h>
+#include <type_traits>
+#include <utility>
+
+// Compile-time checks for optional methods the pre-build scripts generate into an entity
+
+// /* @BinaryStorage */ entities provide SerializeBinary()/DeserializeBinary()
+template<typename T, typename = void>
+struct HasBinaryStorage : std::false_type {};
+
+template<typename T>
+struct HasBinaryStorage<T, std::void_t<decltype(std::declval<const T&>().SerializeBinary()),
+                                       decltype(T::DeserializeBinary(std::declval<const StdString&>()))>>
+    : std::true_type {};
+
+// Entities generated before GetPrimaryKey() became const only offer it on non-const objects
+template<typename T, typename = void>
+struct HasConstPrimaryKey : std::false_type {};
+
+template<typename T>
+struct HasConstPrimaryKey<T, std::void_t<decltype(std::declval<const T&>().GetPrimaryKey())>>
+    : std::true_type {};
+
+// Entities with /* @Indexed */ fields provide GetIndexedFields()/GetIndexKeys()
+template<typename T, typename = void>
+struct HasIndexes : std::false_type {};
+
+template<typename T>
+struct HasIndexes<T, std::void_t<decltype(T::GetIndexedFields()),
+                                 decltype(std::declval<const T&>().GetIndexKeys())>>
+    : std::true_type {};
+
+// Entities generated with projection support provide DeserializeFields() (parses only the named fields)
+template<typename T, typename = void>
+struct HasProjection : std::false_type {};
+
+template<typename T>
+struct HasProjection<T, std::void_t<decltype(T::DeserializeFields(std::declval<const StdString&>(),
+                                                                  std::declval<const Vector<StdString>&>()))>>
+    : std::true_type {};
+
+// Entities generated with buffered serialization provide Serialize(StdString&) (writes into a caller buffer)
+template<typename T, typename = void>
+struct HasBufferedSerialize : std::false_type {};
+
+template<typename T>
+struct HasBufferedSerialize<T, std::void_t<decltype(std::declval<const T&>().Serialize(std::declval<StdString&>()))>>
+    : std::true_type {};
+
+// Entities generated with trusted decoding provide DeserializeTrusted() (no validation, false instead of a throw)
+template<typename T, typename = void>
+struct HasTrustedDecode : std::false_type {};
+
+template<typename T>
+struct HasTrustedDecode<T, std::void_t<decltype(T::DeserializeTrusted(std::declval<const StdString&>(),
+                                                                      std::declval<T&>()))>>
+    : std::true_type {};
+
+// Entities generated with constexpr storage keys provide GetStorageKeyPrefix()/GetIdsFileKey()
+template<typename T, typename = void>
+struct HasStorageKeys : std::false_type {};
+
+template<typename T>
+struct HasStorageKeys<T, std::void_t<decltype(T::GetStorageKeyPrefix()),
+                                     decltype(T::GetIdsFileKey())>>
+    : std::true_type {};
+
+#endif // _ENTITY_TRAITS_H_
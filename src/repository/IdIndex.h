@@ -0,0 +1,214 @@
+#ifndef _ID_INDEX_H_
+#define _ID_INDEX_H_
+
+#include <StandardDefines.h>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+// ID index modes (select one with CPA_REPOSITORY_ID_INDEX before including the repository)
+// CPA_ID_INDEX_NONE   - no index, every existence check re-reads the IDs file
+// CPA_ID_INDEX_HASH   - std::unordered_set, O(1) lookups (default on desktop)
+// CPA_ID_INDEX_SORTED - sorted Vector, O(log n) lookups with the smallest footprint (default on Arduino)
+#define CPA_ID_INDEX_NONE 0
+#define CPA_ID_INDEX_HASH 1
+#define CPA_ID_INDEX_SORTED 2
+
+#ifndef CPA_REPOSITORY_ID_INDEX
+    #ifdef ARDUINO
+        #define CPA_REPOSITORY_ID_INDEX CPA_ID_INDEX_SORTED
+    #else
+        #define CPA_REPOSITORY_ID_INDEX CPA_ID_INDEX_HASH
+    #endif
+#endif
+
+#if CPA_REPOSITORY_ID_INDEX == CPA_ID_INDEX_HASH
+    #include <unordered_map>
+#endif
+
+// In-memory set of the IDs stored in a table's IDs file
+// It is loaded lazily from the IDs file and then kept in sync by the repository on every write; the
+// repository clears it (to be loaded again) once another instance of the table has written.
+// Each ID also records its slot in a binary IDs file (its line in a text one): a delete can tombstone
+// it without a scan, and pages of the IDs file come from the index in file order.
+template<typename ID>
+class IdIndex {
+    // Slot of an ID whose position in the IDs file isn't known (text IDs files)
+    Public Static constexpr uint32_t NoSlot = UINT32_MAX;
+
+    #if CPA_REPOSITORY_ID_INDEX == CPA_ID_INDEX_HASH
+    Private std::unordered_map<ID, uint32_t> ids;
+    #else
+    Private Vector<ID> ids;
+    Private Vector<uint32_t> slots;
+    #endif
+
+    Private Bool loaded = false;
+
+    // One past the highest slot recorded (the slot of the next appended line in a text IDs file)
+    Private uint32_t nextSlot = 0;
+
+    // Check if the index has been populated from the IDs file
+    Public Bool IsLoaded() const {
+        return loaded;
+    }
+
+    // Replace the index contents with the given IDs (slots unknown)
+    Public Void Load(const Vector<ID>& source) {
+        Load(source, Vector<uint32_t>());
+    }
+
+    // Replace the index contents with the given IDs and their IDs file slots (sourceSlots[i] is the
+    // slot of source[i]; missing entries are unknown)
+    Public Void Load(const Vector<ID>& source, const Vector<uint32_t>& sourceSlots) {
+        #if CPA_REPOSITORY_ID_INDEX == CPA_ID_INDEX_HASH
+            ids.clear();
+            ids.reserve(source.size());
+            for (size_t i = 0; i < source.size(); i++) {
+                ids.emplace(source[i], i < sourceSlots.size() ? sourceSlots[i] : NoSlot);
+            }
+        #else
+            Vector<std::pair<ID, uint32_t>> entries;
+            entries.reserve(source.size());
+            for (size_t i = 0; i < source.size(); i++) {
+                entries.emplace_back(source[i], i < sourceSlots.size() ? sourceSlots[i] : NoSlot);
+            }
+            // Stable, so a duplicated ID keeps its first slot
+            std::stable_sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+                return a.first < b.first;
+            });
+            ids.clear();
+            slots.clear();
+            ids.reserve(entries.size());
+            slots.reserve(entries.size());
+            for (const auto& entry : entries) {
+                if (ids.empty() || ids.back() != entry.first) {
+                    ids.push_back(entry.first);
+                    slots.push_back(entry.second);
+                }
+            }
+        #endif
+        nextSlot = 0;
+        for (uint32_t slot : sourceSlots) {
+            NoteSlot(slot);
+        }
+        loaded = true;
+    }
+
+    // Check if the ID is present
+    Public Bool Contains(const ID& id) const {
+        #if CPA_REPOSITORY_ID_INDEX == CPA_ID_INDEX_HASH
+            return ids.find(id) != ids.end();
+        #else
+            return std::binary_search(ids.begin(), ids.end(), id);
+        #endif
+    }
+
+    // Add an ID (no-op if it is already present, except that a known slot replaces the recorded one)
+    Public Void Insert(const ID& id, uint32_t slot = NoSlot) {
+        NoteSlot(slot);
+        #if CPA_REPOSITORY_ID_INDEX == CPA_ID_INDEX_HASH
+            auto inserted = ids.emplace(id, slot);
+            if (!inserted.second && slot != NoSlot) {
+                inserted.first->second = slot;
+            }
+        #else
+            auto it = std::lower_bound(ids.begin(), ids.end(), id);
+            size_t position = static_cast<size_t>(it - ids.begin());
+            if (it == ids.end() || *it != id) {
+                ids.insert(it, id);
+                slots.insert(slots.begin() + position, slot);
+            } else if (slot != NoSlot) {
+                slots[position] = slot;
+            }
+        #endif
+    }
+
+    // Slot of an ID in a binary IDs file (NoSlot if it isn't present or its slot isn't known)
+    Public uint32_t SlotOf(const ID& id) const {
+        #if CPA_REPOSITORY_ID_INDEX == CPA_ID_INDEX_HASH
+            auto it = ids.find(id);
+            return it == ids.end() ? NoSlot : it->second;
+        #else
+            auto it = std::lower_bound(ids.begin(), ids.end(), id);
+            if (it == ids.end() || *it != id) {
+                return NoSlot;
+            }
+            return slots[static_cast<size_t>(it - ids.begin())];
+        #endif
+    }
+
+    // Slot after the highest one recorded
+    Public uint32_t NextSlot() const {
+        return nextSlot;
+    }
+
+    // One page of the IDs in slot (IDs file) order: skip offset IDs and return at most limit
+    // Selects the page without sorting the whole index; false if the slot of any ID isn't known
+    Public Bool Page(size_t offset, size_t limit, Vector<ID>& page) const {
+        Vector<std::pair<uint32_t, ID>> entries;
+        entries.reserve(ids.size());
+        #if CPA_REPOSITORY_ID_INDEX == CPA_ID_INDEX_HASH
+            for (const auto& entry : ids) {
+                entries.emplace_back(entry.second, entry.first);
+            }
+        #else
+            for (size_t i = 0; i < ids.size(); i++) {
+                entries.emplace_back(slots[i], ids[i]);
+            }
+        #endif
+        for (const auto& entry : entries) {
+            if (entry.first == NoSlot) {
+                return false;
+            }
+        }
+        if (offset >= entries.size()) {
+            return true;
+        }
+        
+        auto first = entries.begin() + offset;
+        auto last = entries.begin() + offset + std::min(limit, entries.size() - offset);
+        std::nth_element(entries.begin(), first, entries.end());
+        std::partial_sort(first, last, entries.end());
+        for (auto it = first; it != last; ++it) {
+            page.push_back(it->second);
+        }
+        return true;
+    }
+
+    // Remove an ID (no-op if it is not present)
+    Public Void Erase(const ID& id) {
+        #if CPA_REPOSITORY_ID_INDEX == CPA_ID_INDEX_HASH
+            ids.erase(id);
+        #else
+            auto it = std::lower_bound(ids.begin(), ids.end(), id);
+            if (it != ids.end() && *it == id) {
+                slots.erase(slots.begin() + (it - ids.begin()));
+                ids.erase(it);
+            }
+        #endif
+    }
+
+    // Drop the contents and mark the index as not loaded
+    Public Void Clear() {
+        ids.clear();
+        #if CPA_REPOSITORY_ID_INDEX != CPA_ID_INDEX_HASH
+            slots.clear();
+        #endif
+        nextSlot = 0;
+        loaded = false;
+    }
+
+    // Number of IDs in the index
+    Public size_t Size() const {
+        return ids.size();
+    }
+
+    Private Void NoteSlot(uint32_t slot) {
+        if (slot != NoSlot && slot >= nextSlot) {
+            nextSlot = slot + 1;
+        }
+    }
+};
+
+#endif // _ID_INDEX_H_
@@ -0,0 +1,62 @@
+#ifndef _KEY_HASH_H_
+#define _KEY_HASH_H_
+
+#include <StandardDefines.h>
+#include <cstdint>
+#include <string_view>
+
+// Storage key hash algorithms
+// CPA_KEY_HASH_STD   - std::hash truncated to 32 bits (decimal); the layout of earlier releases, which
+//                      differs between standard libraries (default, so existing databases stay readable)
+// CPA_KEY_HASH_FNV1A - 64-bit FNV-1a, identical on every platform, written as 12 base-36 characters;
+//                      opt in for new databases, or to build one on the desktop and flash it. Every file
+//                      and NVS key name changes, so records written under std::hash are not found.
+#define CPA_KEY_HASH_STD 0
+#define CPA_KEY_HASH_FNV1A 1
+
+#ifndef CPA_REPOSITORY_KEY_HASH
+#define CPA_REPOSITORY_KEY_HASH CPA_KEY_HASH_STD
+#endif
+
+// Collision-checked mode: every record file starts with its full logical key, which is compared on
+// read, overwrite and delete. A mismatch means two keys share a hash; the operation is refused and
+// counted in CpaRepository::GetKeyCollisions(). Records written without the header are still read.
+#ifndef CPA_REPOSITORY_KEY_CHECK
+#define CPA_REPOSITORY_KEY_CHECK 0
+#endif
+
+// Record key header: <marker><logical key><end><payload> (neither byte starts a JSON or binary record)
+#define CPA_RECORD_KEY_MARKER '\x1E'
+#define CPA_RECORD_KEY_END '\x1F'
+
+// 64-bit FNV-1a, usable at compile time so a constant key prefix can be hashed once
+// and the state continued over each ID
+class KeyHash {
+    Public Static constexpr uint64_t Seed = 14695981039346656037ULL;
+    Private Static constexpr uint64_t Prime = 1099511628211ULL;
+
+    // Number of base-36 digits of an encoded hash; 36^12 covers 62 bits and stays under the
+    // 15-character NVS key limit with room for ArduinoFileManager chunk suffixes
+    Public Static constexpr size_t EncodedLength = 12;
+
+    Public Static constexpr uint64_t Update(uint64_t state, std::string_view bytes) {
+        for (size_t i = 0; i < bytes.length(); i++) {
+            state ^= static_cast<uint8_t>(bytes[i]);
+            state *= Prime;
+        }
+        return state;
+    }
+
+    // Fold the hash to 62 bits and write it as fixed-width lowercase base 36
+    Public Static StdString Encode(uint64_t state) {
+        uint64_t value = (state ^ (state >> 62)) & ((1ULL << 62) - 1);
+        StdString encoded(EncodedLength, '0');
+        for (size_t i = EncodedLength; i > 0 && value > 0; i--) {
+            encoded[i - 1] = "0123456789abcdefghijklmnopqrstuvwxyz"[value % 36];
+            value /= 36;
+        }
+        return encoded;
+    }
+};
+
+#endif // _KEY_HASH_H_
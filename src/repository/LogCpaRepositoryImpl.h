@@ -0,0 +1,393 @@
+#ifndef _LOG_CPA_REPOSITORY_IMPL_H_
+#define _LOG_CPA_REPOSITORY_IMPL_H_
+
+#include "CpaRepositoryImpl.h"
+#include "LogRecord.h"
+#include <map>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+#include <atomic>
+
+// Minimum amount of dead (overwritten or deleted) bytes before a segment is compacted
+#ifndef LOG_REPOSITORY_COMPACTION_MIN_BYTES
+#define LOG_REPOSITORY_COMPACTION_MIN_BYTES 4096
+#endif
+
+// Largest read ForEach()/FindAll() issue while scanning a segment
+// NVS values can only be read whole, so on Arduino the segment is scanned in one read
+#ifndef LOG_REPOSITORY_SCAN_CHUNK_BYTES
+    #ifdef ARDUINO
+        #define LOG_REPOSITORY_SCAN_CHUNK_BYTES SIZE_MAX
+    #else
+        #define LOG_REPOSITORY_SCAN_CHUNK_BYTES 16384
+    #endif
+#endif
+
+// Log-structured storage engine
+// Every table is a single append-only segment of put/tombstone records (see LogRecord.h).
+// Writes and deletes are one sequential append, an in-RAM offset index serves point reads,
+// and ForEach()/FindAll() are a single streaming scan of the segment.
+// Once more than half of the segment is dead records it is compacted on the next write.
+// Select it for a repository with the /// @LogStructured annotation next to /// @Repository.
+// Like CpaRepositoryImpl, several instances may store a table: the offset index tracks this instance's
+// appends and is rebuilt once another instance has written (see InvalidateStorage).
+template<typename Entity, typename ID>
+class LogCpaRepositoryImpl : public CpaRepositoryImpl<Entity, ID> {
+    // Finish a background preload and flush queued writes while the storage hooks below are still in place
+    // (after rolling back an open transaction, which holds the table lock)
+    Public Virtual ~LogCpaRepositoryImpl() {
+        this->Rollback();
+        this->WaitForPreload();
+        this->StopWriteBehind();
+    }
+
+    // Location of the latest put record for an ID
+    Private struct Slot {
+        size_t offset;
+        size_t length;
+        size_t payloadOffset;
+        size_t payloadLength;
+    };
+
+    Private std::map<ID, Slot> slots;
+    Private std::atomic<Bool> loaded{false};
+    Private size_t segmentSize = 0;
+    Private size_t liveBytes = 0;
+
+    // Helper method to get the segment file path (computed once per table)
+    Protected CStdString& GetSegmentFilePath() {
+        static CStdString segmentPath = StdString(DATABASE_PATH) + this->GenerateHash(Entity::GetTableName() + "_LOG");
+        return segmentPath;
+    }
+
+    // Build the offset index with one scan of the segment (only the first call reads it)
+    // Readers sharing the table lock may race here, so the build runs under the init mutex
+    Protected Void EnsureLoaded() {
+        if (loaded.load(std::memory_order_acquire)) {
+            return;
+        }
+        RepositoryLock<RepositoryRecursiveMutex> init(this->initMutex);
+        if (loaded.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        CStdString& segmentPath = GetSegmentFilePath();
+        StdString segment = this->fileManager->Read(segmentPath);
+        IndexSegment(segment);
+
+        // Drop a torn tail left by an interrupted append, otherwise later appends would be unreachable
+        if (segmentSize < segment.length()) {
+            this->fileManager->Write(segmentPath.c_str(), std::string_view(segment).substr(0, segmentSize));
+        }
+
+        loaded.store(true, std::memory_order_release);
+    }
+
+    // Compact: Rewrite the segment keeping only the latest put record of each live ID
+    Public Void Compact() {
+        auto lock = this->LockStorage();
+        FileManagerSession session(this->fileManager);
+        EnsureLoaded();
+
+        CStdString& segmentPath = GetSegmentFilePath();
+        StdString segment = this->fileManager->Read(segmentPath);
+
+        StdString compacted;
+        compacted.reserve(liveBytes);
+        size_t position = 0;
+        LogRecord record;
+        while (LogRecordCodec::ParseNext(segment, position, record)) {
+            if (IsLiveRecord(segment, record)) {
+                compacted.append(segment, record.offset, record.length);
+            }
+            position += record.length;
+        }
+
+        this->NoteTableWrite();
+        if (this->fileManager->Create(segmentPath, compacted)) {
+            IndexSegment(compacted);
+        }
+    }
+
+    Protected using CpaRepositoryImpl<Entity, ID>::ReadRecord;
+    Public using CpaRepositoryImpl<Entity, ID>::FindAll;
+
+    // Storage hook: read the payload of the latest put record
+    Protected Bool ReadRecord(ID id, StdString& contents) override {
+        EnsureLoaded();
+        auto it = slots.find(id);
+        if (it == slots.end()) {
+            contents.clear();
+            return false;
+        }
+
+        CStdString& segmentPath = GetSegmentFilePath();
+        contents = this->fileManager->ReadRange(segmentPath, it->second.payloadOffset, it->second.payloadLength);
+        return !contents.empty();
+    }
+
+    // Storage hook: append a put record
+    Protected Bool WriteRecord(ID id, CStdString& contents) override {
+        EnsureLoaded();
+
+        StdString record;
+        size_t payloadOffset = LogRecordCodec::AppendPut(record, this->ConvertToString(id), contents);
+        if (!AppendToSegment(record)) {
+            return false;
+        }
+
+        Slot slot;
+        slot.offset = segmentSize;
+        slot.length = record.length();
+        slot.payloadOffset = segmentSize + payloadOffset;
+        slot.payloadLength = contents.length();
+        SetSlot(id, slot);
+        segmentSize += record.length();
+
+        MaybeCompact();
+        return true;
+    }
+
+    // Storage hook: append a tombstone record
+    Protected Bool RemoveRecord(ID id) override {
+        EnsureLoaded();
+        auto it = slots.find(id);
+        if (it == slots.end()) {
+            return false;
+        }
+
+        StdString record;
+        LogRecordCodec::AppendDelete(record, this->ConvertToString(id));
+        if (!AppendToSegment(record)) {
+            return false;
+        }
+
+        liveBytes -= it->second.length;
+        slots.erase(it);
+        segmentSize += record.length();
+
+        MaybeCompact();
+        return true;
+    }
+
+    // Storage hook: answer from the offset index
+    Protected Bool RecordExists(ID id) override {
+        EnsureLoaded();
+        return slots.find(id) != slots.end();
+    }
+
+    // Storage hook: live IDs in segment order
+    Protected Vector<ID> ReadAllIds() override {
+        EnsureLoaded();
+
+        Vector<std::pair<size_t, ID>> ordered;
+        ordered.reserve(slots.size());
+        for (const auto& entry : slots) {
+            ordered.push_back(std::make_pair(entry.second.offset, entry.first));
+        }
+        std::sort(ordered.begin(), ordered.end(),
+                  [](const std::pair<size_t, ID>& a, const std::pair<size_t, ID>& b) { return a.first < b.first; });
+
+        Vector<ID> ids;
+        ids.reserve(ordered.size());
+        for (const auto& entry : ordered) {
+            ids.push_back(entry.second);
+        }
+        return ids;
+    }
+
+    // Storage hook: one page of the live IDs, from the offset index
+    Protected Vector<ID> ReadIdRange(size_t offset, size_t limit) override {
+        Vector<ID> ids = ReadAllIds();
+        if (offset >= ids.size()) {
+            return Vector<ID>();
+        }
+        size_t end = limit < ids.size() - offset ? offset + limit : ids.size();
+        return Vector<ID>(ids.begin() + offset, ids.begin() + end);
+    }
+
+    // The segment itself records which IDs exist, there is no separate IDs file
+    Protected Bool IdExistsInFile(ID id) override {
+        return RecordExists(id);
+    }
+
+    Protected Bool AppendIds(const Vector<ID>&) override {
+        return true;
+    }
+
+    Protected Bool RemoveIds(const Vector<ID>&) override {
+        return true;
+    }
+
+    // Storage hook: visit live entities in segment order
+    // Only one chunk of the segment and one entity are held in memory at a time; payloads that don't decode are skipped.
+    Protected Void ScanEntities(std::function<Bool(const Entity&)> visitor) override {
+        StdString contents;
+        Entity entity;
+        ScanPayloads([this, &visitor, &contents, &entity](std::string_view payload) {
+            contents.assign(payload.data(), payload.length());
+            return !this->DecodeEntity(contents, entity) || visitor(entity);
+        });
+    }
+
+    // Storage hook: visit the payloads of live entities in segment order, copied into one reused buffer
+    Protected Void ScanRecords(std::function<Bool(const StdString&)> visitor) override {
+        StdString contents;
+        ScanPayloads([&contents, &visitor](std::string_view payload) {
+            contents.assign(payload.data(), payload.length());
+            return visitor(contents);
+        });
+    }
+
+    // Storage hook: another instance appended to or compacted the segment, so rebuild the offset index
+    Protected Void InvalidateStorage() override {
+        loaded.store(false, std::memory_order_release);
+    }
+
+    // Storage hook: build the offset index (the IDs the base engine would read come from it)
+    Protected Void WarmStorage() override {
+        EnsureLoaded();
+        this->EnsureSecondaryIndexesLoaded();
+    }
+
+    #ifdef CPA_REPOSITORY_PARALLEL_FIND_ALL
+    // Read: Find all entities
+    // The segment is still read with the sequential chunked scan; only decoding is spread over threads
+    Public Virtual Vector<Entity> FindAll() override {
+        auto operation = this->TrackOperation(RepositoryOperation::FindAll);
+        this->RecoverJournal();
+        this->FlushWriteBehind();
+        auto lock = this->LockStorageShared();
+        FileManagerSession session(this->fileManager);
+
+        Vector<StdString> payloads;
+        ScanPayloads([&payloads](std::string_view payload) {
+            payloads.push_back(StdString(payload));
+            return true;
+        });
+
+        Vector<optional<Entity>> decoded(payloads.size());
+        this->ForEachSlice(payloads.size(), [this, &payloads, &decoded](size_t begin, size_t end) {
+            Entity entity;
+            for (size_t i = begin; i < end; i++) {
+                if (this->DecodeEntity(payloads[i], entity)) {
+                    decoded[i] = std::move(entity);
+                }
+            }
+        });
+
+        Vector<Entity> entities;
+        entities.reserve(decoded.size());
+        for (auto& entity : decoded) {
+            if (entity.has_value()) {
+                entities.push_back(std::move(entity.value()));
+            }
+        }
+        return entities;
+    }
+    #endif
+
+    // Visit the payloads of live put records in segment order
+    // Adjacent records are fetched together in reads of up to LOG_REPOSITORY_SCAN_CHUNK_BYTES
+    Private Void ScanPayloads(std::function<Bool(std::string_view)> visitor) {
+        EnsureLoaded();
+
+        Vector<Slot> ordered;
+        ordered.reserve(slots.size());
+        for (const auto& entry : slots) {
+            ordered.push_back(entry.second);
+        }
+        std::sort(ordered.begin(), ordered.end(),
+                  [](const Slot& a, const Slot& b) { return a.offset < b.offset; });
+
+        CStdString& segmentPath = GetSegmentFilePath();
+
+        size_t first = 0;
+        while (first < ordered.size()) {
+            size_t chunkStart = ordered[first].payloadOffset;
+            size_t chunkEnd = chunkStart + ordered[first].payloadLength;
+            size_t last = first + 1;
+            while (last < ordered.size() &&
+                   ordered[last].payloadOffset + ordered[last].payloadLength - chunkStart <= LOG_REPOSITORY_SCAN_CHUNK_BYTES) {
+                chunkEnd = ordered[last].payloadOffset + ordered[last].payloadLength;
+                last++;
+            }
+
+            StdString chunk = this->fileManager->ReadRange(segmentPath, chunkStart, chunkEnd - chunkStart);
+            for (size_t i = first; i < last; i++) {
+                size_t payloadStart = ordered[i].payloadOffset - chunkStart;
+                if (!visitor(std::string_view(chunk).substr(payloadStart, ordered[i].payloadLength))) {
+                    return;
+                }
+            }
+            first = last;
+        }
+    }
+
+    // Check if a record is the latest put for its ID
+    Private Bool IsLiveRecord(const StdString& segment, const LogRecord& record) {
+        if (record.type != LOG_RECORD_PUT) {
+            return false;
+        }
+        ID id = this->template ConvertFromString<ID>(segment.substr(record.idOffset, record.idLength));
+        auto it = slots.find(id);
+        return it != slots.end() && it->second.offset == record.offset;
+    }
+
+    // Rebuild the offset index from segment contents
+    Private Void IndexSegment(const StdString& segment) {
+        slots.clear();
+        liveBytes = 0;
+
+        size_t position = 0;
+        LogRecord record;
+        while (LogRecordCodec::ParseNext(segment, position, record)) {
+            ID id = this->template ConvertFromString<ID>(segment.substr(record.idOffset, record.idLength));
+            if (record.type == LOG_RECORD_PUT) {
+                Slot slot;
+                slot.offset = record.offset;
+                slot.length = record.length;
+                slot.payloadOffset = record.payloadOffset;
+                slot.payloadLength = record.payloadLength;
+                SetSlot(id, slot);
+            } else {
+                auto it = slots.find(id);
+                if (it != slots.end()) {
+                    liveBytes -= it->second.length;
+                    slots.erase(it);
+                }
+            }
+            position += record.length;
+        }
+
+        segmentSize = position;
+    }
+
+    // Point an ID at a new put record, keeping the live byte count in step
+    Private Void SetSlot(ID id, const Slot& slot) {
+        auto it = slots.find(id);
+        if (it != slots.end()) {
+            liveBytes -= it->second.length;
+            it->second = slot;
+        } else {
+            slots.insert(std::make_pair(id, slot));
+        }
+        liveBytes += slot.length;
+    }
+
+    Private Bool AppendToSegment(CStdString& record) {
+        CStdString& segmentPath = GetSegmentFilePath();
+        return this->fileManager->Append(segmentPath, record);
+    }
+
+    // Compact once dead records are the majority of the segment
+    Private Void MaybeCompact() {
+        size_t deadBytes = segmentSize - liveBytes;
+        if (deadBytes >= LOG_REPOSITORY_COMPACTION_MIN_BYTES && deadBytes > liveBytes) {
+            Compact();
+        }
+    }
+};
+
+#endif // _LOG_CPA_REPOSITORY_IMPL_H_
@@ -0,0 +1,113 @@
+#ifndef _LOG_RECORD_H_
+#define _LOG_RECORD_H_
+
+#include <StandardDefines.h>
+#include <cstdlib>
+
+// Record types stored in an append-only segment
+#define LOG_RECORD_PUT 'P'
+#define LOG_RECORD_DELETE 'D'
+
+// Closes a transaction journal: the records before it belong to a complete commit
+#define LOG_RECORD_COMMIT 'C'
+
+// Location of one record inside a segment
+// On-disk layout: <type><idLength>:<payloadLength>\n<id><payload>\n
+// Both lengths are decimal so the segment stays a plain string (NVS and text files can hold it),
+// and the payload may contain any character, including newlines.
+struct LogRecord {
+    char type = LOG_RECORD_PUT;
+    size_t offset = 0;          // start of the record in the segment
+    size_t length = 0;          // full record length, including the trailing newline
+    size_t idOffset = 0;
+    size_t idLength = 0;
+    size_t payloadOffset = 0;
+    size_t payloadLength = 0;
+};
+
+class LogRecordCodec {
+    // Append a put record to out and return the offset of its payload relative to the start of out
+    Public Static size_t AppendPut(StdString& out, CStdString& id, CStdString& payload) {
+        return AppendRecord(out, LOG_RECORD_PUT, id, payload);
+    }
+
+    // Append a tombstone record to out
+    Public Static Void AppendDelete(StdString& out, CStdString& id) {
+        AppendRecord(out, LOG_RECORD_DELETE, id, StdString(""));
+    }
+
+    // Append a tombstone record that carries a payload (e.g. the one ID removed from a secondary index key)
+    Public Static Void AppendDelete(StdString& out, CStdString& id, CStdString& payload) {
+        AppendRecord(out, LOG_RECORD_DELETE, id, payload);
+    }
+
+    // Append the record that marks a transaction journal complete
+    Public Static Void AppendCommit(StdString& out) {
+        AppendRecord(out, LOG_RECORD_COMMIT, StdString(""), StdString(""));
+    }
+
+    // Parse the record starting at position
+    // Returns false at the end of the segment or on a torn/corrupt tail (everything after it is ignored)
+    Public Static Bool ParseNext(const StdString& segment, size_t position, LogRecord& record) {
+        if (position >= segment.length()) {
+            return false;
+        }
+
+        char type = segment[position];
+        if (type != LOG_RECORD_PUT && type != LOG_RECORD_DELETE && type != LOG_RECORD_COMMIT) {
+            return false;
+        }
+
+        size_t cursor = position + 1;
+        size_t idLength = 0;
+        size_t payloadLength = 0;
+        if (!ParseLength(segment, cursor, ':', idLength) || !ParseLength(segment, cursor, '\n', payloadLength)) {
+            return false;
+        }
+
+        // Record body plus trailing newline must be fully present
+        if (cursor + idLength + payloadLength + 1 > segment.length() ||
+            segment[cursor + idLength + payloadLength] != '\n') {
+            return false;
+        }
+
+        record.type = type;
+        record.offset = position;
+        record.idOffset = cursor;
+        record.idLength = idLength;
+        record.payloadOffset = cursor + idLength;
+        record.payloadLength = payloadLength;
+        record.length = (cursor + idLength + payloadLength + 1) - position;
+        return true;
+    }
+
+    Private Static size_t AppendRecord(StdString& out, char type, CStdString& id, CStdString& payload) {
+        out += type;
+        out += std::to_string(id.length());
+        out += ':';
+        out += std::to_string(payload.length());
+        out += '\n';
+        out += id;
+        size_t payloadOffset = out.length();
+        out += payload;
+        out += '\n';
+        return payloadOffset;
+    }
+
+    // Parse a decimal length terminated by terminator, advancing cursor past the terminator
+    Private Static Bool ParseLength(const StdString& segment, size_t& cursor, char terminator, size_t& value) {
+        size_t start = cursor;
+        value = 0;
+        while (cursor < segment.length() && segment[cursor] >= '0' && segment[cursor] <= '9') {
+            value = value * 10 + static_cast<size_t>(segment[cursor] - '0');
+            cursor++;
+        }
+        if (cursor == start || cursor >= segment.length() || segment[cursor] != terminator) {
+            return false;
+        }
+        cursor++;
+        return true;
+    }
+};
+
+#endif // _LOG_RECORD_H_
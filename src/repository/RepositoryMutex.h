@@ -0,0 +1,201 @@
+#ifndef _REPOSITORY_MUTEX_H_
+#define _REPOSITORY_MUTEX_H_
+
+#include <StandardDefines.h>
+
+// Threading backends
+// CPA_THREADS_STD      - std::mutex / std::thread (desktop)
+// CPA_THREADS_FREERTOS - FreeRTOS semaphores and tasks (ESP32)
+// CPA_THREADS_NONE     - single-threaded targets, locks are no-ops and there are no background workers
+#define CPA_THREADS_NONE 0
+#define CPA_THREADS_STD 1
+#define CPA_THREADS_FREERTOS 2
+
+#ifndef CPA_REPOSITORY_THREADS
+    #ifndef ARDUINO
+        #define CPA_REPOSITORY_THREADS CPA_THREADS_STD
+    #elif defined(ESP32)
+        #define CPA_REPOSITORY_THREADS CPA_THREADS_FREERTOS
+    #else
+        #define CPA_REPOSITORY_THREADS CPA_THREADS_NONE
+    #endif
+#endif
+
+#if CPA_REPOSITORY_THREADS == CPA_THREADS_STD
+    #include <mutex>
+    #include <shared_mutex>
+#elif CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+    #include <freertos/FreeRTOS.h>
+    #include <freertos/semphr.h>
+#endif
+
+// Non-recursive mutex
+class RepositoryMutex {
+    #if CPA_REPOSITORY_THREADS == CPA_THREADS_STD
+    Private std::mutex mutex;
+    #elif CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+    Private SemaphoreHandle_t mutex;
+    #endif
+
+    #if CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+    Public RepositoryMutex() : mutex(xSemaphoreCreateMutex()) {
+    }
+
+    Public ~RepositoryMutex() {
+        vSemaphoreDelete(mutex);
+    }
+    #else
+    Public RepositoryMutex() = default;
+    #endif
+
+    Public RepositoryMutex(const RepositoryMutex&) = delete;
+    Public RepositoryMutex& operator=(const RepositoryMutex&) = delete;
+
+    Public Void Lock() {
+        #if CPA_REPOSITORY_THREADS == CPA_THREADS_STD
+            mutex.lock();
+        #elif CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+            xSemaphoreTake(mutex, portMAX_DELAY);
+        #endif
+    }
+
+    Public Void Unlock() {
+        #if CPA_REPOSITORY_THREADS == CPA_THREADS_STD
+            mutex.unlock();
+        #elif CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+            xSemaphoreGive(mutex);
+        #endif
+    }
+};
+
+// Mutex the owning thread may lock again (repository operations call each other)
+class RepositoryRecursiveMutex {
+    #if CPA_REPOSITORY_THREADS == CPA_THREADS_STD
+    Private std::recursive_mutex mutex;
+    #elif CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+    Private SemaphoreHandle_t mutex;
+    #endif
+
+    #if CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+    Public RepositoryRecursiveMutex() : mutex(xSemaphoreCreateRecursiveMutex()) {
+    }
+
+    Public ~RepositoryRecursiveMutex() {
+        vSemaphoreDelete(mutex);
+    }
+    #else
+    Public RepositoryRecursiveMutex() = default;
+    #endif
+
+    Public RepositoryRecursiveMutex(const RepositoryRecursiveMutex&) = delete;
+    Public RepositoryRecursiveMutex& operator=(const RepositoryRecursiveMutex&) = delete;
+
+    Public Void Lock() {
+        #if CPA_REPOSITORY_THREADS == CPA_THREADS_STD
+            mutex.lock();
+        #elif CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+            xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+        #endif
+    }
+
+    Public Void Unlock() {
+        #if CPA_REPOSITORY_THREADS == CPA_THREADS_STD
+            mutex.unlock();
+        #elif CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+            xSemaphoreGiveRecursive(mutex);
+        #endif
+    }
+};
+
+// Reader/writer lock: any number of shared holders or one exclusive holder
+// The FreeRTOS version is the classic reader count + resource semaphore (readers are preferred)
+class RepositorySharedMutex {
+    #if CPA_REPOSITORY_THREADS == CPA_THREADS_STD
+    Private std::shared_mutex mutex;
+    #elif CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+    Private SemaphoreHandle_t readerMutex;
+    Private SemaphoreHandle_t resource;
+    Private size_t readers = 0;
+    #endif
+
+    #if CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+    Public RepositorySharedMutex() : readerMutex(xSemaphoreCreateMutex()), resource(xSemaphoreCreateBinary()) {
+        // Binary semaphores start taken; the last reader out may give it back from another task
+        xSemaphoreGive(resource);
+    }
+
+    Public ~RepositorySharedMutex() {
+        vSemaphoreDelete(readerMutex);
+        vSemaphoreDelete(resource);
+    }
+    #else
+    Public RepositorySharedMutex() = default;
+    #endif
+
+    Public RepositorySharedMutex(const RepositorySharedMutex&) = delete;
+    Public RepositorySharedMutex& operator=(const RepositorySharedMutex&) = delete;
+
+    Public Void Lock() {
+        #if CPA_REPOSITORY_THREADS == CPA_THREADS_STD
+            mutex.lock();
+        #elif CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+            xSemaphoreTake(resource, portMAX_DELAY);
+        #endif
+    }
+
+    Public Void Unlock() {
+        #if CPA_REPOSITORY_THREADS == CPA_THREADS_STD
+            mutex.unlock();
+        #elif CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+            xSemaphoreGive(resource);
+        #endif
+    }
+
+    Public Void LockShared() {
+        #if CPA_REPOSITORY_THREADS == CPA_THREADS_STD
+            mutex.lock_shared();
+        #elif CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+            xSemaphoreTake(readerMutex, portMAX_DELAY);
+            if (++readers == 1) {
+                xSemaphoreTake(resource, portMAX_DELAY);
+            }
+            xSemaphoreGive(readerMutex);
+        #endif
+    }
+
+    Public Void UnlockShared() {
+        #if CPA_REPOSITORY_THREADS == CPA_THREADS_STD
+            mutex.unlock_shared();
+        #elif CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+            xSemaphoreTake(readerMutex, portMAX_DELAY);
+            if (--readers == 0) {
+                xSemaphoreGive(resource);
+            }
+            xSemaphoreGive(readerMutex);
+        #endif
+    }
+};
+
+// RAII lock scope; engage = false makes it a no-op (e.g. while no other thread can touch the object)
+template<typename Mutex>
+class RepositoryLock {
+    Private Mutex& mutex;
+    Private Bool engaged;
+
+    Public explicit RepositoryLock(Mutex& target, Bool engage = true) : mutex(target), engaged(engage) {
+        if (engaged) {
+            mutex.Lock();
+        }
+    }
+
+    Public ~RepositoryLock() {
+        if (engaged) {
+            mutex.Unlock();
+        }
+    }
+
+    Public RepositoryLock(const RepositoryLock&) = delete;
+    Public RepositoryLock& operator=(const RepositoryLock&) = delete;
+};
+
+#endif // _REPOSITORY_MUTEX_H_
@@ -0,0 +1,157 @@
+#ifndef _SECONDARY_INDEX_H_
+#define _SECONDARY_INDEX_H_
+
+#include "../IFileManager.h"
+#include "LogRecord.h"
+#include <map>
+#include <set>
+
+// Rewrite an index file once it holds this many records more than there are live entries
+#ifndef SECONDARY_INDEX_COMPACTION_MIN_RECORDS
+#define SECONDARY_INDEX_COMPACTION_MIN_RECORDS 64
+#endif
+
+// Persisted value -> IDs index for one /* @Indexed */ field
+// The file is a log of LogRecord entries keyed by field value: a put adds the ID in its payload,
+// a delete removes it. It is replayed once on first use and rewritten compacted when it grows.
+// IDs are kept in their string form, as a set per key so rebuilding a low-cardinality field stays
+// O(n log n); the repository converts them.
+class SecondaryIndex {
+    Private StdString filePath;
+    Private std::map<StdString, std::set<StdString>> entries;
+    Private Bool loaded = false;
+    Private size_t liveEntries = 0;
+    Private size_t loggedRecords = 0;
+
+    Public explicit SecondaryIndex(CStdString& path) : filePath(path) {
+    }
+
+    Public Bool IsLoaded() const {
+        return loaded;
+    }
+
+    // Load: Replay the index file
+    // Returns false if the file doesn't exist yet, the caller then rebuilds it from the table
+    Public Bool Load(IFileManagerPtr fileManager) {
+        Clear();
+        StdString contents = fileManager->Read(filePath);
+        if (contents.empty()) {
+            return false;
+        }
+
+        size_t position = 0;
+        LogRecord record;
+        while (LogRecordCodec::ParseNext(contents, position, record)) {
+            StdString key = contents.substr(record.idOffset, record.idLength);
+            StdString id = contents.substr(record.payloadOffset, record.payloadLength);
+            if (record.type == LOG_RECORD_PUT) {
+                Insert(key, id);
+            } else {
+                Erase(key, id);
+            }
+            loggedRecords++;
+            position += record.length;
+        }
+
+        // Drop a torn tail left by an interrupted append, otherwise later records would be unreachable
+        if (position < contents.length()) {
+            Persist(fileManager);
+        }
+        loaded = true;
+        return true;
+    }
+
+    // IDs stored under a key
+    Public const std::set<StdString>& Find(CStdString& key) const {
+        static const std::set<StdString> none;
+        auto it = entries.find(key);
+        return it == entries.end() ? none : it->second;
+    }
+
+    // Add: Record an ID under a key (in memory and in the index file)
+    Public Void Add(IFileManagerPtr fileManager, CStdString& key, CStdString& id) {
+        if (!Insert(key, id)) {
+            return;
+        }
+        StdString record;
+        LogRecordCodec::AppendPut(record, key, id);
+        AppendRecord(fileManager, record);
+    }
+
+    // Remove: Drop an ID from a key (in memory and in the index file)
+    Public Void Remove(IFileManagerPtr fileManager, CStdString& key, CStdString& id) {
+        if (!Erase(key, id)) {
+            return;
+        }
+        StdString record;
+        LogRecordCodec::AppendDelete(record, key, id);
+        AppendRecord(fileManager, record);
+    }
+
+    // Reset: Start from an empty, loaded index (used before a rebuild)
+    Public Void Reset() {
+        Clear();
+        loaded = true;
+    }
+
+    // Insert: Add an ID under a key in memory only. Returns false if it was already there
+    Public Bool Insert(CStdString& key, CStdString& id) {
+        loaded = true;
+        if (!entries[key].insert(id).second) {
+            return false;
+        }
+        liveEntries++;
+        return true;
+    }
+
+    // Persist: Rewrite the index file with one put record per live entry
+    Public Bool Persist(IFileManagerPtr fileManager) {
+        // A leading no-op tombstone marks the index as built even when it has no entries
+        StdString contents;
+        LogRecordCodec::AppendDelete(contents, StdString(""));
+        for (const auto& entry : entries) {
+            for (const auto& id : entry.second) {
+                LogRecordCodec::AppendPut(contents, entry.first, id);
+            }
+        }
+
+        if (!fileManager->Create(filePath, contents)) {
+            return false;
+        }
+        loggedRecords = liveEntries + 1;
+        return true;
+    }
+
+    Private Void Clear() {
+        entries.clear();
+        loaded = false;
+        liveEntries = 0;
+        loggedRecords = 0;
+    }
+
+    Private Bool Erase(CStdString& key, CStdString& id) {
+        auto it = entries.find(key);
+        if (it == entries.end()) {
+            return false;
+        }
+        if (it->second.erase(id) == 0) {
+            return false;
+        }
+        if (it->second.empty()) {
+            entries.erase(it);
+        }
+        liveEntries--;
+        return true;
+    }
+
+    Private Void AppendRecord(IFileManagerPtr fileManager, CStdString& record) {
+        fileManager->Append(filePath, record);
+        loggedRecords++;
+
+        if (loggedRecords >= SECONDARY_INDEX_COMPACTION_MIN_RECORDS && loggedRecords > 2 * liveEntries) {
+            Persist(fileManager);
+        }
+    }
+};
+
+#endif // _SECONDARY_INDEX_H_
@@ -0,0 +1,238 @@
+#ifndef _STATS_RECORDER_H_
+#define _STATS_RECORDER_H_
+
+#include "../RepositoryStats.h"
+#include "../FileManagerCounters.h"
+#include <atomic>
+#include <cstdint>
+
+// Recording side of RepositoryStats.h for repositories (the file manager side is FileManagerCounters.h).
+// Every type here exists in both modes so call sites need no #if; with CPA_REPOSITORY_STATS == 0 they
+// hold nothing and their methods are empty.
+
+// Counters of one repository, one OperationStats per RepositoryOperation
+class RepositoryCounters {
+    #if CPA_REPOSITORY_STATS
+    Private struct Operation {
+        std::atomic<size_t> count{0};
+        std::atomic<uint64_t> totalNanos{0};
+        std::atomic<uint64_t> maxNanos{0};
+        std::atomic<uint64_t> codecNanos{0};
+        FileManagerCounters storage;
+        std::atomic<uint32_t> latency[CPA_REPOSITORY_STATS_BUCKETS];
+
+        Operation() {
+            for (auto& bucket : latency) {
+                bucket = 0;
+            }
+        }
+    };
+
+    Private Operation operations[static_cast<size_t>(RepositoryOperation::Count)];
+    Private std::atomic<size_t> serializations{0};
+    Private std::atomic<uint64_t> serializeNanos{0};
+    Private std::atomic<size_t> deserializations{0};
+    Private std::atomic<uint64_t> deserializeNanos{0};
+
+    // Histogram bucket of a duration: the number of bits of its whole microseconds
+    Private Static size_t BucketOf(uint64_t nanos) {
+        uint64_t micros = nanos / 1000;
+        size_t bucket = 0;
+        while (micros > 0 && bucket < CPA_REPOSITORY_STATS_BUCKETS - 1) {
+            micros >>= 1;
+            bucket++;
+        }
+        return bucket;
+    }
+    #endif
+
+    Public Void RecordOperation(RepositoryOperation kind, uint64_t nanos, uint64_t codecNanos, const FileManagerStats& storage) {
+        #if CPA_REPOSITORY_STATS
+            Operation& operation = operations[static_cast<size_t>(kind)];
+            operation.count.fetch_add(1, std::memory_order_relaxed);
+            operation.totalNanos.fetch_add(nanos, std::memory_order_relaxed);
+            operation.codecNanos.fetch_add(codecNanos, std::memory_order_relaxed);
+            operation.storage.Add(storage);
+            operation.latency[BucketOf(nanos)].fetch_add(1, std::memory_order_relaxed);
+            uint64_t max = operation.maxNanos.load(std::memory_order_relaxed);
+            while (nanos > max && !operation.maxNanos.compare_exchange_weak(max, nanos, std::memory_order_relaxed)) {
+            }
+        #else
+            (void)kind;
+            (void)nanos;
+            (void)codecNanos;
+            (void)storage;
+        #endif
+    }
+
+    Public Void RecordCodec(Bool serialize, uint64_t nanos) {
+        #if CPA_REPOSITORY_STATS
+            if (serialize) {
+                serializations.fetch_add(1, std::memory_order_relaxed);
+                serializeNanos.fetch_add(nanos, std::memory_order_relaxed);
+            } else {
+                deserializations.fetch_add(1, std::memory_order_relaxed);
+                deserializeNanos.fetch_add(nanos, std::memory_order_relaxed);
+            }
+        #else
+            (void)serialize;
+            (void)nanos;
+        #endif
+    }
+
+    Public RepositoryStats Snapshot() const {
+        RepositoryStats stats;
+        #if CPA_REPOSITORY_STATS
+            stats.enabled = true;
+            for (size_t i = 0; i < static_cast<size_t>(RepositoryOperation::Count); i++) {
+                const Operation& operation = operations[i];
+                OperationStats& target = stats.operations[i];
+                target.count = operation.count.load(std::memory_order_relaxed);
+                target.totalNanos = operation.totalNanos.load(std::memory_order_relaxed);
+                target.maxNanos = operation.maxNanos.load(std::memory_order_relaxed);
+                target.codecNanos = operation.codecNanos.load(std::memory_order_relaxed);
+                target.storage = operation.storage.Snapshot();
+                for (size_t bucket = 0; bucket < CPA_REPOSITORY_STATS_BUCKETS; bucket++) {
+                    target.latency[bucket] = operation.latency[bucket].load(std::memory_order_relaxed);
+                }
+            }
+            stats.serializations = serializations.load(std::memory_order_relaxed);
+            stats.serializeNanos = serializeNanos.load(std::memory_order_relaxed);
+            stats.deserializations = deserializations.load(std::memory_order_relaxed);
+            stats.deserializeNanos = deserializeNanos.load(std::memory_order_relaxed);
+        #endif
+        return stats;
+    }
+
+    Public Void Reset() {
+        #if CPA_REPOSITORY_STATS
+            for (auto& operation : operations) {
+                operation.count = 0;
+                operation.totalNanos = 0;
+                operation.maxNanos = 0;
+                operation.codecNanos = 0;
+                operation.storage.Reset();
+                for (auto& bucket : operation.latency) {
+                    bucket = 0;
+                }
+            }
+            serializations = 0;
+            serializeNanos = 0;
+            deserializations = 0;
+            deserializeNanos = 0;
+        #endif
+    }
+};
+
+// Records one repository operation when it ends
+// Only the outermost operation on a table records, nested ones are part of it (depth is per thread)
+template<typename Entity>
+class OperationScope {
+    #if CPA_REPOSITORY_STATS
+    Private RepositoryCounters* counters = nullptr;
+    Private RepositoryOperation kind;
+    Private uint64_t start = 0;
+    Private uint64_t codecStart = 0;
+    Private FileManagerStats storageStart;
+
+    Private Static size_t& Depth() {
+        static thread_local size_t depth = 0;
+        return depth;
+    }
+    #endif
+
+    Public OperationScope(RepositoryCounters& target, RepositoryOperation operation)
+    #if CPA_REPOSITORY_STATS
+        : kind(operation)
+    #endif
+    {
+        #if CPA_REPOSITORY_STATS
+            if (Depth()++ == 0) {
+                counters = &target;
+                storageStart = ThreadStats::Storage();
+                codecStart = ThreadStats::CodecNanos();
+                start = StatsClock::Nanos();
+            }
+        #else
+            (void)target;
+            (void)operation;
+        #endif
+    }
+
+    Public ~OperationScope() {
+        #if CPA_REPOSITORY_STATS
+            Depth()--;
+            if (counters != nullptr) {
+                uint64_t nanos = StatsClock::Nanos() - start;
+                counters->RecordOperation(kind, nanos, ThreadStats::CodecNanos() - codecStart, ThreadStats::Since(storageStart));
+            }
+        #endif
+    }
+
+    Public OperationScope(const OperationScope&) = delete;
+    Public OperationScope& operator=(const OperationScope&) = delete;
+};
+
+// Times one serialization or deserialization
+class CodecScope {
+    #if CPA_REPOSITORY_STATS
+    Private RepositoryCounters& counters;
+    Private Bool serialize;
+    Private uint64_t start;
+    #endif
+
+    Public CodecScope(RepositoryCounters& target, Bool serializing)
+    #if CPA_REPOSITORY_STATS
+        : counters(target), serialize(serializing), start(StatsClock::Nanos())
+    #endif
+    {
+        #if !CPA_REPOSITORY_STATS
+            (void)target;
+            (void)serializing;
+        #endif
+    }
+
+    Public ~CodecScope() {
+        #if CPA_REPOSITORY_STATS
+            uint64_t nanos = StatsClock::Nanos() - start;
+            counters.RecordCodec(serialize, nanos);
+            ThreadStats::CodecNanos() += nanos;
+        #endif
+    }
+
+    Public CodecScope(const CodecScope&) = delete;
+    Public CodecScope& operator=(const CodecScope&) = delete;
+};
+
+// Carries the totals a worker thread collected back to the thread that waits for it,
+// so an operation spread over several threads still sees all of its I/O and decoding
+class WorkerStats {
+    #if CPA_REPOSITORY_STATS
+    Private FileManagerStats storage;
+    Private uint64_t codecNanos = 0;
+    #endif
+
+    // Run work on the current (worker) thread and keep what it added to the thread totals
+    Public template<typename Work>
+    Void Collect(Work&& work) {
+        #if CPA_REPOSITORY_STATS
+            FileManagerStats storageBefore = ThreadStats::Storage();
+            uint64_t codecBefore = ThreadStats::CodecNanos();
+            work();
+            storage = ThreadStats::Since(storageBefore);
+            codecNanos = ThreadStats::CodecNanos() - codecBefore;
+        #else
+            work();
+        #endif
+    }
+
+    // Add the collected totals to the calling thread's
+    Public Void Merge() const {
+        #if CPA_REPOSITORY_STATS
+            ThreadStats::Add(ThreadStats::Storage(), storage);
+            ThreadStats::CodecNanos() += codecNanos;
+        #endif
+    }
+};
+
+#endif // _STATS_RECORDER_H_
@@ -0,0 +1,107 @@
+#ifndef _TABLE_LOCK_H_
+#define _TABLE_LOCK_H_
+
+#include <StandardDefines.h>
+#include "RepositoryMutex.h"
+#include <atomic>
+#include <cstdint>
+
+// Concurrency-safe mode: every repository operation takes its table's reader/writer lock, so
+// repositories may be shared between threads (or both ESP32 cores). Reads (FindById, ExistsById,
+// ForEach, ...) share the lock and run in parallel; writes hold it exclusively and stay atomic,
+// including the IDs file read-modify-write. 0 (default) only locks while a write-behind worker runs.
+#ifndef CPA_REPOSITORY_THREAD_SAFE
+#define CPA_REPOSITORY_THREAD_SAFE 0
+#endif
+
+// Reader/writer lock and write version of one table, shared by every repository instance storing Entity
+// Repository operations call each other (Save -> index rebuild -> scan, DeleteById -> ExistsById),
+// so a thread that already holds the lock passes through nested requests. A nested write inside a
+// read (e.g. saving from a ForEach visitor) can't upgrade the shared lock and must be avoided while
+// other threads use the table.
+template<typename Entity>
+class TableLock {
+    Public Static RepositorySharedMutex& Mutex() {
+        static RepositorySharedMutex mutex;
+        return mutex;
+    }
+
+    // Bumped by every write to the table, so instances can tell their in-memory state went stale
+    Public Static std::atomic<uint32_t>& Version() {
+        static std::atomic<uint32_t> version{0};
+        return version;
+    }
+
+    // Nesting depth of the calling thread (0 = not held)
+    Public Static size_t& Depth() {
+        static thread_local size_t depth = 0;
+        return depth;
+    }
+
+    // Whether the calling thread's outermost hold is exclusive
+    Public Static Bool& Exclusive() {
+        static thread_local Bool exclusive = false;
+        return exclusive;
+    }
+
+    Public Static Bool IsHeld() {
+        return Depth() > 0;
+    }
+
+    Public Static Bool IsHeldShared() {
+        return Depth() > 0 && !Exclusive();
+    }
+};
+
+// RAII hold of a table lock; engage = false makes it a no-op
+template<typename Entity>
+class TableLockGuard {
+    Private Bool counted = false;
+    Private Bool owner = false;
+    Private Bool exclusive;
+
+    Public TableLockGuard(Bool exclusiveHold, Bool engage) : exclusive(exclusiveHold) {
+        if (!engage) {
+            return;
+        }
+
+        size_t& depth = TableLock<Entity>::Depth();
+        if (depth == 0) {
+            if (exclusive) {
+                TableLock<Entity>::Mutex().Lock();
+            } else {
+                TableLock<Entity>::Mutex().LockShared();
+            }
+            TableLock<Entity>::Exclusive() = exclusive;
+            owner = true;
+        }
+        depth++;
+        counted = true;
+    }
+
+    Public ~TableLockGuard() {
+        if (counted) {
+            TableLock<Entity>::Depth()--;
+        }
+        if (owner) {
+            TableLock<Entity>::Exclusive() = false;
+            if (exclusive) {
+                TableLock<Entity>::Mutex().Unlock();
+            } else {
+                TableLock<Entity>::Mutex().UnlockShared();
+            }
+        }
+    }
+
+    Public TableLockGuard(TableLockGuard&& other) noexcept
+        : counted(other.counted), owner(other.owner), exclusive(other.exclusive) {
+        other.counted = false;
+        other.owner = false;
+    }
+
+    Public TableLockGuard(const TableLockGuard&) = delete;
+    Public TableLockGuard& operator=(const TableLockGuard&) = delete;
+    Public TableLockGuard& operator=(TableLockGuard&&) = delete;
+};
+
+#endif // _TABLE_LOCK_H_
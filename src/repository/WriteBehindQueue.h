@@ -0,0 +1,252 @@
+#ifndef _WRITE_BEHIND_QUEUE_H_
+#define _WRITE_BEHIND_QUEUE_H_
+
+#include <StandardDefines.h>
+#include "RepositoryMutex.h"
+#include <map>
+#include <optional>
+#include <functional>
+#include <atomic>
+
+// How long the worker waits after the first queued write before flushing, so bursts coalesce
+#ifndef REPOSITORY_WRITE_BEHIND_DELAY_MS
+#define REPOSITORY_WRITE_BEHIND_DELAY_MS 20
+#endif
+
+// Stack size and priority of the FreeRTOS flush task
+#ifndef REPOSITORY_WRITE_BEHIND_TASK_STACK
+#define REPOSITORY_WRITE_BEHIND_TASK_STACK 8192
+#endif
+
+#ifndef REPOSITORY_WRITE_BEHIND_TASK_PRIORITY
+#define REPOSITORY_WRITE_BEHIND_TASK_PRIORITY 1
+#endif
+
+#if CPA_REPOSITORY_THREADS == CPA_THREADS_STD
+    #include <thread>
+    #include <mutex>
+    #include <condition_variable>
+    #include <chrono>
+#elif CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+    #include <freertos/FreeRTOS.h>
+    #include <freertos/task.h>
+    #include <freertos/semphr.h>
+#endif
+
+// Pending writes of a write-behind repository, coalesced per ID (last write wins)
+// A background worker (std::thread on desktop, FreeRTOS task on ESP32) calls the flush callback
+// shortly after writes are queued. Targets without threads have no worker; their queue is flushed
+// when it reaches the maximum depth or on an explicit Flush().
+template<typename Entity, typename ID>
+class WriteBehindQueue {
+    // Latest queued operation for an ID: an entity to store, or nullopt to delete it
+    Private std::map<ID, optional<Entity>> pending;
+    Private RepositoryMutex mutex;
+    Private std::atomic<size_t> maxDepth{0};
+    Private std::function<Void()> flush;
+    Private std::atomic<Bool> running{false};
+    Private std::atomic<Bool> stopping{false};
+
+    #if CPA_REPOSITORY_THREADS == CPA_THREADS_STD
+    Private std::thread worker;
+    Private std::mutex signalMutex;
+    Private std::condition_variable signal;
+    Private Bool wake = false;
+    #elif CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+    Private TaskHandle_t task = nullptr;
+    Private SemaphoreHandle_t stopped = nullptr;
+    #endif
+
+    Public WriteBehindQueue() = default;
+    Public WriteBehindQueue(const WriteBehindQueue&) = delete;
+    Public WriteBehindQueue& operator=(const WriteBehindQueue&) = delete;
+
+    Public ~WriteBehindQueue() {
+        Stop();
+    }
+
+    // Writes are queued while the maximum depth is non-zero
+    Public Bool IsEnabled() const {
+        return maxDepth.load() > 0;
+    }
+
+    Public size_t GetMaxDepth() const {
+        return maxDepth.load();
+    }
+
+    Public Void SetMaxDepth(size_t depth) {
+        maxDepth.store(depth);
+    }
+
+    // Check if a background worker may be flushing concurrently
+    Public Bool IsRunning() const {
+        return running.load();
+    }
+
+    // Queue an entity to be stored; returns the number of pending writes
+    Public size_t Put(const ID& id, const Entity& entity) {
+        RepositoryLock<RepositoryMutex> lock(mutex);
+        pending[id] = entity;
+        return pending.size();
+    }
+
+    // Queue a delete; returns the number of pending writes
+    Public size_t Remove(const ID& id) {
+        RepositoryLock<RepositoryMutex> lock(mutex);
+        pending[id] = std::nullopt;
+        return pending.size();
+    }
+
+    // Put back a taken write that storage refused, unless a newer write for the ID was queued since
+    Public Void Restore(const ID& id, const optional<Entity>& entity) {
+        RepositoryLock<RepositoryMutex> lock(mutex);
+        pending.emplace(id, entity);
+    }
+
+    // Look up the pending write for an ID
+    // Returns false if there is none; otherwise entity is the queued entity, or nullopt for a pending delete
+    Public Bool Lookup(const ID& id, optional<Entity>& entity) {
+        RepositoryLock<RepositoryMutex> lock(mutex);
+        auto it = pending.find(id);
+        if (it == pending.end()) {
+            return false;
+        }
+        entity = it->second;
+        return true;
+    }
+
+    // Move every pending write out of the queue, split into entities to store and IDs to delete
+    Public Void TakeAll(Vector<Entity>& saved, Vector<ID>& removed) {
+        std::map<ID, optional<Entity>> taken;
+        {
+            RepositoryLock<RepositoryMutex> lock(mutex);
+            taken.swap(pending);
+        }
+        for (auto& entry : taken) {
+            if (entry.second.has_value()) {
+                saved.push_back(std::move(entry.second.value()));
+            } else {
+                removed.push_back(entry.first);
+            }
+        }
+    }
+
+    // Start the background worker (no-op without threads or if it is already running)
+    Public Void Start(std::function<Void()> callback) {
+        #if CPA_REPOSITORY_THREADS != CPA_THREADS_NONE
+            if (running.load()) {
+                return;
+            }
+            flush = callback;
+            stopping.store(false);
+            running.store(true);
+        #endif
+
+        #if CPA_REPOSITORY_THREADS == CPA_THREADS_STD
+            wake = false;
+            worker = std::thread([this]() { Run(); });
+        #elif CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+            stopped = xSemaphoreCreateBinary();
+            if (xTaskCreate(&WriteBehindQueue::TaskEntry, "cpa_write_behind", REPOSITORY_WRITE_BEHIND_TASK_STACK,
+                            this, REPOSITORY_WRITE_BEHIND_TASK_PRIORITY, &task) != pdPASS) {
+                // No task: behave like a target without threads
+                vSemaphoreDelete(stopped);
+                stopped = nullptr;
+                task = nullptr;
+                running.store(false);
+            }
+        #else
+            (void)callback;
+        #endif
+    }
+
+    // Stop the worker and wait for a flush in progress to finish (pending writes stay queued)
+    Public Void Stop() {
+        if (!running.load()) {
+            return;
+        }
+        stopping.store(true);
+
+        #if CPA_REPOSITORY_THREADS == CPA_THREADS_STD
+            {
+                std::lock_guard<std::mutex> lock(signalMutex);
+                wake = true;
+            }
+            signal.notify_one();
+            if (worker.joinable()) {
+                worker.join();
+            }
+        #elif CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+            xTaskNotifyGive(task);
+            xSemaphoreTake(stopped, portMAX_DELAY);
+            vSemaphoreDelete(stopped);
+            stopped = nullptr;
+            task = nullptr;
+        #endif
+
+        running.store(false);
+    }
+
+    // Wake the worker after a write was queued
+    Public Void Notify() {
+        #if CPA_REPOSITORY_THREADS == CPA_THREADS_STD
+            if (running.load()) {
+                {
+                    std::lock_guard<std::mutex> lock(signalMutex);
+                    wake = true;
+                }
+                signal.notify_one();
+            }
+        #elif CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+            if (running.load() && task != nullptr) {
+                xTaskNotifyGive(task);
+            }
+        #endif
+    }
+
+    #if CPA_REPOSITORY_THREADS == CPA_THREADS_STD
+    // Worker loop: wait for a write, let the burst settle, flush
+    Private Void Run() {
+        std::unique_lock<std::mutex> lock(signalMutex);
+        while (true) {
+            signal.wait(lock, [this]() { return wake; });
+            if (stopping.load()) {
+                return;
+            }
+            signal.wait_for(lock, std::chrono::milliseconds(REPOSITORY_WRITE_BEHIND_DELAY_MS),
+                            [this]() { return stopping.load(); });
+            if (stopping.load()) {
+                return;
+            }
+            wake = false;
+
+            lock.unlock();
+            flush();
+            lock.lock();
+        }
+    }
+    #elif CPA_REPOSITORY_THREADS == CPA_THREADS_FREERTOS
+    Private Static Void TaskEntry(Void* argument) {
+        static_cast<WriteBehindQueue*>(argument)->Run();
+    }
+
+    // Task loop: wait for a notification, let the burst settle, flush
+    Private Void Run() {
+        while (true) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            if (stopping.load()) {
+                break;
+            }
+            vTaskDelay(pdMS_TO_TICKS(REPOSITORY_WRITE_BEHIND_DELAY_MS));
+            if (stopping.load()) {
+                break;
+            }
+            flush();
+        }
+        xSemaphoreGive(stopped);
+        vTaskDelete(nullptr);
+    }
+    #endif
+};
+
+#endif // _WRITE_BEHIND_QUEUE_H_
@@ -0,0 +1,129 @@
+#ifndef _TEST_ENTITY_H_
+#define _TEST_ENTITY_H_
+
+#include <StandardDefines.h>
+#include "BinaryCodec.h"
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+// Sample entity for the tests, in the shape the pre-build scripts generate for an entity with an
+// /* @Id */ field and /* @BinaryStorage */. It carries no annotations, so the scripts leave it alone.
+// Serialize() and Deserialize() write a flat JSON object by hand, which keeps the tests independent
+// of the serialization library; records written before the switch to binary are read through them.
+class TestUser {
+    Public optional<int> id;
+    Public optional<StdString> name;
+    Public optional<int> age;
+
+    Public Static TestUser Make(int key, CStdString& userName = StdString()) {
+        TestUser user;
+        user.id = key;
+        user.name = userName.empty() ? "user" + std::to_string(key) : userName;
+        user.age = 18 + key % 60;
+        return user;
+    }
+
+    Public Bool operator==(const TestUser& other) const {
+        return id == other.id && name == other.name && age == other.age;
+    }
+
+    Public StdString Serialize() const {
+        StdString json = "{\"id\":";
+        json += std::to_string(id.value_or(0));
+        json += ",\"name\":\"";
+        json += name.value_or("");
+        json += "\",\"age\":";
+        json += std::to_string(age.value_or(0));
+        json += "}";
+        return json;
+    }
+
+    Public Static TestUser Deserialize(CStdString& json) {
+        TestUser user;
+        std::string_view view(json);
+        user.id = ParseInt(view, "\"id\":");
+        user.name = ParseString(view, "\"name\":\"");
+        user.age = ParseInt(view, "\"age\":");
+        return user;
+    }
+
+    // Binary storage serialization method (/* @BinaryStorage */)
+    Public StdString SerializeBinary() const {
+        BinaryWriter writer;
+        if (id.has_value()) {
+            writer.WriteInt(1, id.value());
+        }
+        if (name.has_value()) {
+            writer.WriteString(2, name.value());
+        }
+        if (age.has_value()) {
+            writer.WriteInt(3, age.value());
+        }
+        return writer.Release();
+    }
+
+    // Binary storage deserialization method, empty fields if the record is truncated
+    Public Static TestUser DeserializeBinary(const StdString& input) {
+        TestUser user;
+        DeserializeBinary(input, user);
+        return user;
+    }
+
+    // Binary storage deserialization into user, false if the record is truncated
+    Public Static Bool DeserializeBinary(const StdString& input, TestUser& user) {
+        user = TestUser();
+        BinaryReader reader(input);
+        BinaryField field;
+        while (reader.Next(field)) {
+            switch (field.tag) {
+                case 1: user.id = field.AsInt<int>(); break;
+                case 2: user.name = field.AsString(); break;
+                case 3: user.age = field.AsInt<int>(); break;
+                default: break;
+            }
+        }
+        return reader.Ok();
+    }
+
+    Private Static int ParseInt(std::string_view json, std::string_view key) {
+        size_t position = json.find(key);
+        if (position == std::string_view::npos) {
+            return 0;
+        }
+        return std::atoi(json.data() + position + key.length());
+    }
+
+    Private Static StdString ParseString(std::string_view json, std::string_view key) {
+        size_t position = json.find(key);
+        if (position == std::string_view::npos) {
+            return StdString();
+        }
+        size_t start = position + key.length();
+        size_t end = json.find('"', start);
+        return StdString(json.substr(start, end - start));
+    }
+
+    Public inline optional<int> GetPrimaryKey() const {
+        return id;
+    }
+
+    Public inline Static StdString GetPrimaryKeyName() {
+        return "id";
+    }
+
+    Public inline Static StdString GetTableName() {
+        return "TestUser";
+    }
+
+    // Every record key is this prefix followed by the ID
+    Public inline Static constexpr std::string_view GetStorageKeyPrefix() {
+        return "TestUser_id_";
+    }
+
+    Public inline Static constexpr std::string_view GetIdsFileKey() {
+        return "TestUser_IDs";
+    }
+};
+
+#endif // _TEST_ENTITY_H_
@@ -0,0 +1,123 @@
+#ifndef _TEST_SUPPORT_H_
+#define _TEST_SUPPORT_H_
+
+#include "TestEntity.h"
+#include "DesktopFileManager.h"
+#include "repository/CpaRepositoryImpl.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+
+// Default-engine repository of TestUser with its storage paths exposed
+class TestRepository : public CpaRepositoryImpl<TestUser, int> {
+    Public explicit TestRepository(IFileManagerPtr manager) {
+        fileManager = manager;
+    }
+
+    Public using CpaRepositoryImpl<TestUser, int>::GetIdsFilePath;
+    Public using CpaRepositoryImpl<TestUser, int>::GetJournalFilePath;
+    Public using CpaRepositoryImpl<TestUser, int>::GetFilePath;
+    Public using CpaRepositoryImpl<TestUser, int>::GetPreloadFilePath;
+};
+
+// File manager decorator whose mutating calls fail, without touching storage, while Refuse(true) is
+// set; refusePath, if set, limits the refusal to paths containing it
+class RefusingFileManager final : public IFileManager {
+    Private DesktopFileManager inner;
+    Private Bool refusing = false;
+    Private StdString refusePath;
+
+    Public Void Refuse(Bool refuse, CStdString& path = StdString()) {
+        refusing = refuse;
+        refusePath = path;
+    }
+
+    Public Bool Create(CStdString& filename, CStdString& contents) override {
+        return !Refused(filename) && inner.Create(filename, contents);
+    }
+
+    Public StdString Read(CStdString& filename) override {
+        return inner.Read(filename);
+    }
+
+    Public Bool Read(CStdString& filename, StdString& contents) override {
+        return inner.Read(filename, contents);
+    }
+
+    Public Bool Read(const char* filename, StdString& contents) override {
+        return inner.Read(filename, contents);
+    }
+
+    Public Bool Update(CStdString& filename, CStdString& contents) override {
+        return !Refused(filename) && inner.Update(filename, contents);
+    }
+
+    Public Bool Delete(CStdString& filename) override {
+        return !Refused(filename) && inner.Delete(filename);
+    }
+
+    Public Bool Append(CStdString& filename, CStdString& contents) override {
+        return !Refused(filename) && inner.Append(filename, contents);
+    }
+
+    Public StdString ReadRange(CStdString& filename, size_t offset, size_t length) override {
+        return inner.ReadRange(filename, offset, length);
+    }
+
+    Public Bool WriteRange(CStdString& filename, size_t offset, std::string_view contents) override {
+        return !Refused(filename) && inner.WriteRange(filename, offset, contents);
+    }
+
+    Public Bool Exists(CStdString& filename) override {
+        return inner.Exists(filename);
+    }
+
+    Public size_t Size(CStdString& filename) override {
+        return inner.Size(filename);
+    }
+
+    Public Bool Write(const char* filename, std::string_view contents) override {
+        return !Refused(filename) && inner.Write(filename, contents);
+    }
+
+    Public Bool Append(const char* filename, std::string_view contents) override {
+        return !Refused(filename) && inner.Append(filename, contents);
+    }
+
+    Public FileManagerStats GetStats() override {
+        return inner.GetStats();
+    }
+
+    Public Void ResetStats() override {
+        inner.ResetStats();
+    }
+
+    Private Bool Refused(CStdString& filename) const {
+        return refusing && (refusePath.empty() || filename.find(refusePath) != StdString::npos);
+    }
+};
+
+// IDs of a list of entities, sorted
+inline Vector<int> SortedIds(const Vector<TestUser>& users) {
+    Vector<int> ids;
+    for (const auto& user : users) {
+        ids.push_back(user.id.value());
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+// Fixture that starts every test from an empty DATABASE_PATH
+class StorageTest : public ::testing::Test {
+    Protected Void SetUp() override {
+        std::filesystem::remove_all(DATABASE_PATH);
+        std::filesystem::create_directories(DATABASE_PATH);
+    }
+
+    Protected Void TearDown() override {
+        std::filesystem::remove_all(DATABASE_PATH);
+    }
+};
+
+#endif // _TEST_SUPPORT_H_
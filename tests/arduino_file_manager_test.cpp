@@ -0,0 +1,108 @@
+// ArduinoFileManager (NVS) against the in-memory Preferences fake: chunked appends and in-place patches
+// Built as its own executable with ARDUINO and ESP32 defined (see CMakeLists.txt)
+
+#include <StandardDefines.h>
+#include "IFileManager.h"
+#include "ArduinoFileManager.h"
+#include <gtest/gtest.h>
+
+class ArduinoFileManagerTest : public ::testing::Test {
+    Protected ArduinoFileManager fileManager;
+    Protected StdString key = "ids";
+
+    Protected Void SetUp() override {
+        Preferences::Clear();
+    }
+
+    // Append size bytes in pieces of piece bytes, returning everything appended
+    Protected StdString AppendPieces(size_t size, size_t piece, Bool binary) {
+        StdString all;
+        while (all.length() < size) {
+            StdString contents;
+            for (size_t i = 0; i < piece; i++) {
+                contents += binary && i == 0 ? '\0' : static_cast<char>('a' + (all.length() + i) % 26);
+            }
+            EXPECT_TRUE(fileManager.Append(key.c_str(), std::string_view(contents)));
+            all += contents;
+        }
+        return all;
+    }
+
+    Protected Static Bool HasKey(CStdString& name) {
+        return Preferences::Storage().count(name) > 0;
+    }
+};
+
+TEST_F(ArduinoFileManagerTest, SmallValuesStayInOneKey) {
+    StdString all = AppendPieces(100, 10, false);
+    EXPECT_EQ(fileManager.Read(key), all);
+    EXPECT_FALSE(HasKey(key + ".n"));
+}
+
+TEST_F(ArduinoFileManagerTest, AppendsPastTheChunkSizeStartNewChunks) {
+    StdString all = AppendPieces(3 * ARDUINO_FILE_MANAGER_CHUNK_BYTES, 10, false);
+    EXPECT_TRUE(HasKey(key + ".n"));
+    EXPECT_TRUE(HasKey(key + ".1"));
+    EXPECT_TRUE(HasKey(key + ".2"));
+    EXPECT_EQ(fileManager.Read(key), all);
+    EXPECT_EQ(fileManager.Size(key), all.length());
+
+    // Appending only rewrites the last chunk
+    Preferences::Puts().clear();
+    ASSERT_TRUE(fileManager.Append(key.c_str(), std::string_view("xyz")));
+    EXPECT_EQ(Preferences::Puts().count(key), 0u);
+    EXPECT_EQ(Preferences::Puts().count(key + ".1"), 0u);
+    EXPECT_EQ(fileManager.Read(key), all + "xyz");
+}
+
+TEST_F(ArduinoFileManagerTest, BinaryChunksRoundTrip) {
+    StdString all = AppendPieces(2 * ARDUINO_FILE_MANAGER_CHUNK_BYTES, 9, true);
+    StdString contents;
+    ASSERT_TRUE(fileManager.Read(key, contents));
+    EXPECT_EQ(contents, all);
+}
+
+TEST_F(ArduinoFileManagerTest, WriteReplacesEveryChunk) {
+    AppendPieces(3 * ARDUINO_FILE_MANAGER_CHUNK_BYTES, 10, false);
+    ASSERT_TRUE(fileManager.Create(key, StdString("fresh")));
+    EXPECT_FALSE(HasKey(key + ".n"));
+    EXPECT_FALSE(HasKey(key + ".1"));
+    EXPECT_EQ(fileManager.Read(key), "fresh");
+}
+
+TEST_F(ArduinoFileManagerTest, DeleteRemovesEveryChunk) {
+    AppendPieces(3 * ARDUINO_FILE_MANAGER_CHUNK_BYTES, 10, false);
+    ASSERT_TRUE(fileManager.Delete(key));
+    EXPECT_TRUE(Preferences::Storage().empty());
+    StdString contents;
+    EXPECT_FALSE(fileManager.Read(key, contents));
+}
+
+TEST_F(ArduinoFileManagerTest, WriteRangePatchesOnlyTheChunksItCovers) {
+    StdString all = AppendPieces(3 * ARDUINO_FILE_MANAGER_CHUNK_BYTES, 10, true);
+    size_t firstChunk = Preferences::Storage().at(key).bytes.length();
+
+    // A one-byte tombstone inside the second chunk
+    Preferences::Puts().clear();
+    ASSERT_TRUE(fileManager.WriteRange(key, firstChunk + 5, std::string_view("\0", 1)));
+    all[firstChunk + 5] = '\0';
+    EXPECT_EQ(Preferences::Puts().size(), 1u);
+    EXPECT_EQ(Preferences::Puts().count(key + ".1"), 1u);
+    EXPECT_EQ(fileManager.Read(key), all);
+
+    // A patch across the first chunk boundary rewrites both chunks
+    Preferences::Puts().clear();
+    ASSERT_TRUE(fileManager.WriteRange(key, firstChunk - 2, std::string_view("WXYZ")));
+    all.replace(firstChunk - 2, 4, "WXYZ");
+    EXPECT_EQ(Preferences::Puts().size(), 2u);
+    EXPECT_EQ(fileManager.Read(key), all);
+}
+
+TEST_F(ArduinoFileManagerTest, WriteRangePastTheEndChangesNothing) {
+    StdString all = AppendPieces(2 * ARDUINO_FILE_MANAGER_CHUNK_BYTES, 10, false);
+    Preferences::Puts().clear();
+    EXPECT_FALSE(fileManager.WriteRange(key, all.length() - 1, std::string_view("ab")));
+    EXPECT_FALSE(fileManager.WriteRange(key, all.length() + 1, std::string_view("")));
+    EXPECT_TRUE(Preferences::Puts().empty());
+    EXPECT_EQ(fileManager.Read(key), all);
+}
@@ -0,0 +1,122 @@
+// BinaryCodec records: every wire type, and truncated or corrupt input
+
+#include "BinaryCodec.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+TEST(BinaryCodecTest, RoundTripsEveryWireType) {
+    BinaryWriter writer;
+    writer.WriteInt(1, -1);
+    writer.WriteInt(2, std::numeric_limits<int64_t>::max());
+    writer.WriteInt(3, std::numeric_limits<int64_t>::min());
+    writer.WriteBool(4, true);
+    writer.WriteFloat(5, 1.5f);
+    writer.WriteDouble(6, -2.25);
+    writer.WriteString(7, StdString("a\0b\nc", 5));
+    StdString record = writer.Release();
+
+    ASSERT_TRUE(BinaryReader::IsBinaryRecord(record));
+    BinaryReader reader(record);
+    BinaryField field;
+    ASSERT_TRUE(reader.Next(field));
+    EXPECT_EQ(field.tag, 1u);
+    EXPECT_EQ(field.AsInt<int>(), -1);
+    ASSERT_TRUE(reader.Next(field));
+    EXPECT_EQ(field.AsInt<int64_t>(), std::numeric_limits<int64_t>::max());
+    ASSERT_TRUE(reader.Next(field));
+    EXPECT_EQ(field.AsInt<int64_t>(), std::numeric_limits<int64_t>::min());
+    ASSERT_TRUE(reader.Next(field));
+    EXPECT_TRUE(field.AsBool());
+    ASSERT_TRUE(reader.Next(field));
+    EXPECT_EQ(field.wireType, BINARY_WIRE_FIXED32);
+    EXPECT_EQ(field.AsFloat(), 1.5f);
+    ASSERT_TRUE(reader.Next(field));
+    EXPECT_EQ(field.wireType, BINARY_WIRE_FIXED64);
+    EXPECT_EQ(field.AsDouble(), -2.25);
+    ASSERT_TRUE(reader.Next(field));
+    EXPECT_EQ(field.tag, 7u);
+    EXPECT_EQ(field.AsString(), StdString("a\0b\nc", 5));
+    EXPECT_FALSE(reader.Next(field));
+    EXPECT_TRUE(reader.Ok());
+}
+
+TEST(BinaryCodecTest, SmallNegativeIntsStayShort) {
+    BinaryWriter writer;
+    writer.WriteInt(1, -3);
+    // magic, key, one zigzag byte
+    EXPECT_EQ(writer.Release().length(), 3u);
+}
+
+TEST(BinaryCodecTest, EmptyRecordHasNoFields) {
+    StdString record = BinaryWriter().Release();
+    BinaryReader reader(record);
+    BinaryField field;
+    EXPECT_FALSE(reader.Next(field));
+    EXPECT_TRUE(reader.Ok());
+}
+
+TEST(BinaryCodecTest, JsonIsNotABinaryRecord) {
+    StdString json = "{\"id\":1}";
+    EXPECT_FALSE(BinaryReader::IsBinaryRecord(json));
+    EXPECT_FALSE(BinaryReader::IsBinaryRecord(StdString()));
+
+    BinaryReader reader(json);
+    BinaryField field;
+    EXPECT_FALSE(reader.Next(field));
+    EXPECT_FALSE(reader.Ok());
+}
+
+TEST(BinaryCodecTest, TruncationInsideAFieldIsCorrupt) {
+    // Record lengths after the magic byte and after each field
+    Vector<size_t> boundaries;
+    BinaryWriter writer;
+    boundaries.push_back(1);
+    writer.WriteInt(1, 300);
+    StdString partial = BinaryWriter(writer).Release();
+    boundaries.push_back(partial.length());
+    writer.WriteDouble(2, 3.0);
+    partial = BinaryWriter(writer).Release();
+    boundaries.push_back(partial.length());
+    writer.WriteString(3, StdString("payload"));
+    StdString record = writer.Release();
+
+    for (size_t length = 1; length < record.length(); length++) {
+        StdString truncated = record.substr(0, length);
+        BinaryReader reader(truncated);
+        BinaryField field;
+        size_t fields = 0;
+        while (reader.Next(field)) {
+            fields++;
+        }
+        // A cut between fields just ends the record early; anywhere else it is corrupt
+        Bool onBoundary = std::find(boundaries.begin(), boundaries.end(), length) != boundaries.end();
+        EXPECT_EQ(reader.Ok(), onBoundary) << "length " << length;
+        EXPECT_LT(fields, 3u) << "length " << length;
+    }
+}
+
+TEST(BinaryCodecTest, OversizedBytesLengthIsCorrupt) {
+    BinaryWriter writer;
+    writer.WriteString(1, StdString("abc"));
+    StdString record = writer.Release();
+    // Claim more bytes than the record holds
+    record[2] = 100;
+
+    BinaryReader reader(record);
+    BinaryField field;
+    EXPECT_FALSE(reader.Next(field));
+    EXPECT_FALSE(reader.Ok());
+}
+
+TEST(BinaryCodecTest, UnknownWireTypeIsCorrupt) {
+    StdString record = BinaryWriter().Release();
+    record += static_cast<char>((1 << 3) | 7);
+    record += '\x01';
+
+    BinaryReader reader(record);
+    BinaryField field;
+    EXPECT_FALSE(reader.Next(field));
+    EXPECT_FALSE(reader.Ok());
+}
@@ -0,0 +1,56 @@
+// DesktopFileManager atomic writes: temp files never outlive a failed write or a crash
+
+#include "TestSupport.h"
+#include <fstream>
+
+class DesktopFileManagerTest : public StorageTest {
+    Protected StdString directory = StdString(DATABASE_PATH);
+
+    Protected Static Bool FileExists(CStdString& path) {
+        return std::filesystem::exists(path);
+    }
+
+    // Leave a file the way a crash between writing a temp file and renaming it would
+    Protected Static Void WriteRaw(CStdString& path, CStdString& contents) {
+        std::ofstream file(path, std::ios::binary);
+        file << contents;
+    }
+};
+
+TEST_F(DesktopFileManagerTest, FailedRenameRemovesTheTempFile) {
+    DesktopFileManager fileManager;
+    StdString target = directory + "record";
+    std::filesystem::create_directories(target + "/child");
+
+    EXPECT_FALSE(fileManager.Create(target, StdString("contents")));
+    EXPECT_FALSE(FileExists(target + ".tmp"));
+}
+
+TEST_F(DesktopFileManagerTest, FailedBatchRenameRemovesTheTempFile) {
+    DesktopFileManager fileManager;
+    fileManager.SetDurability(CPA_DURABILITY_BATCH);
+    StdString target = directory + "record";
+    std::filesystem::create_directories(target + "/child");
+
+    fileManager.BeginSession();
+    EXPECT_TRUE(fileManager.Create(target, StdString("contents")));
+    EXPECT_TRUE(FileExists(target + ".tmp"));
+    fileManager.EndSession();
+    EXPECT_FALSE(FileExists(target + ".tmp"));
+}
+
+TEST_F(DesktopFileManagerTest, StaleTempFilesAreSweptOnTheFirstWrite) {
+    WriteRaw(directory + "a.tmp", "torn");
+    WriteRaw(directory + "b.tmp", "torn");
+    WriteRaw(directory + "kept", "record");
+
+    DesktopFileManager fileManager;
+    EXPECT_TRUE(fileManager.Exists(directory + "kept"));
+    EXPECT_TRUE(FileExists(directory + "a.tmp"));
+
+    ASSERT_TRUE(fileManager.Create(directory + "c", StdString("new")));
+    EXPECT_FALSE(FileExists(directory + "a.tmp"));
+    EXPECT_FALSE(FileExists(directory + "b.tmp"));
+    EXPECT_EQ(fileManager.Read(directory + "kept"), "record");
+    EXPECT_EQ(fileManager.Read(directory + "c"), "new");
+}
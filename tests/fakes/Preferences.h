@@ -0,0 +1,142 @@
+#ifndef _FAKE_PREFERENCES_H_
+#define _FAKE_PREFERENCES_H_
+
+// In-memory stand-in for the ESP32 Preferences library (NVS), enough for ArduinoFileManager
+// Values are typed like NVS keys; every put is counted per key so tests can tell what was rewritten.
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+
+enum PreferenceType {
+    PT_I8, PT_U8, PT_I16, PT_U16, PT_I32, PT_U32, PT_I64, PT_U64, PT_STR, PT_BLOB, PT_INVALID
+};
+
+// Arduino String, only what the file manager reads from it
+class String {
+    std::string value;
+
+public:
+    String(const char* text) : value(text) {
+    }
+
+    String(std::string text) : value(std::move(text)) {
+    }
+
+    const char* c_str() const {
+        return value.c_str();
+    }
+
+    size_t length() const {
+        return value.length();
+    }
+};
+
+class Preferences {
+    bool open = false;
+
+public:
+    struct Entry {
+        PreferenceType type = PT_INVALID;
+        std::string bytes;
+    };
+
+    // Shared by every instance, like the flash partition
+    static std::map<std::string, Entry>& Storage() {
+        static std::map<std::string, Entry> storage;
+        return storage;
+    }
+
+    static std::map<std::string, int>& Puts() {
+        static std::map<std::string, int> puts;
+        return puts;
+    }
+
+    static void Clear() {
+        Storage().clear();
+        Puts().clear();
+    }
+
+    bool begin(const char*, bool) {
+        open = true;
+        return true;
+    }
+
+    void end() {
+        open = false;
+    }
+
+    PreferenceType getType(const char* key) {
+        auto it = Storage().find(key);
+        return it == Storage().end() ? PT_INVALID : it->second.type;
+    }
+
+    bool isKey(const char* key) {
+        return Storage().count(key) > 0;
+    }
+
+    bool remove(const char* key) {
+        return Storage().erase(key) > 0;
+    }
+
+    size_t getBytesLength(const char* key) {
+        auto it = Storage().find(key);
+        return it == Storage().end() || it->second.type != PT_BLOB ? 0 : it->second.bytes.length();
+    }
+
+    size_t getBytes(const char* key, void* buffer, size_t length) {
+        auto it = Storage().find(key);
+        if (it == Storage().end() || it->second.type != PT_BLOB || length < it->second.bytes.length()) {
+            return 0;
+        }
+        std::memcpy(buffer, it->second.bytes.data(), it->second.bytes.length());
+        return it->second.bytes.length();
+    }
+
+    String getString(const char* key, const char* defaultValue) {
+        auto it = Storage().find(key);
+        if (it == Storage().end() || it->second.type != PT_STR) {
+            return String(defaultValue);
+        }
+        return String(it->second.bytes);
+    }
+
+    uint16_t getUShort(const char* key, uint16_t defaultValue) {
+        auto it = Storage().find(key);
+        if (it == Storage().end() || it->second.type != PT_U16) {
+            return defaultValue;
+        }
+        uint16_t value;
+        std::memcpy(&value, it->second.bytes.data(), sizeof(value));
+        return value;
+    }
+
+    // NVS refuses to change the type of an existing key
+    size_t putBytes(const char* key, const void* data, size_t length) {
+        return Put(key, PT_BLOB, std::string(static_cast<const char*>(data), length));
+    }
+
+    size_t putString(const char* key, const char* value) {
+        size_t written = Put(key, PT_STR, std::string(value));
+        return written == 0 ? 0 : std::strlen(value) + 1;
+    }
+
+    size_t putUShort(const char* key, uint16_t value) {
+        return Put(key, PT_U16, std::string(reinterpret_cast<const char*>(&value), sizeof(value)));
+    }
+
+private:
+    size_t Put(const char* key, PreferenceType type, std::string bytes) {
+        auto it = Storage().find(key);
+        if (it != Storage().end() && it->second.type != type) {
+            return 0;
+        }
+        Puts()[key]++;
+        size_t length = bytes.length();
+        Storage()[key] = Entry{type, std::move(bytes)};
+        return length == 0 ? 1 : length;
+    }
+};
+
+#endif // _FAKE_PREFERENCES_H_
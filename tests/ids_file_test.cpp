@@ -0,0 +1,247 @@
+// Binary IDs files: the slot codec, and the files the default storage engine keeps with it
+
+#include "TestSupport.h"
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <utility>
+
+// Live IDs of a binary IDs file with their slots
+template<typename ID>
+static Vector<std::pair<ID, size_t>> LiveSlots(const StdString& contents) {
+    Vector<std::pair<ID, size_t>> live;
+    BinaryIdsCodec<ID>::ForEachLive(contents, [&live](ID id, size_t slot) {
+        live.emplace_back(id, slot);
+        return true;
+    });
+    return live;
+}
+
+TEST(BinaryIdsCodecTest, SlotsRoundTrip) {
+    StdString contents;
+    BinaryIdsCodec<int>::AppendHeader(contents);
+    BinaryIdsCodec<int>::AppendSlot(contents, 7);
+    BinaryIdsCodec<int>::AppendSlot(contents, -42);
+    BinaryIdsCodec<int>::AppendSlot(contents, std::numeric_limits<int>::max());
+
+    EXPECT_TRUE(BinaryIdsCodec<int>::IsBinary(contents));
+    EXPECT_TRUE(BinaryIdsCodec<int>::HasOwnWidth(contents));
+    EXPECT_EQ(contents.length(), BinaryIdsCodec<int>::SlotOffset(3));
+    EXPECT_EQ(BinaryIdsCodec<int>::SlotCount(contents.length()), 3u);
+
+    auto live = LiveSlots<int>(contents);
+    ASSERT_EQ(live.size(), 3u);
+    EXPECT_EQ(live[0], std::make_pair(7, size_t(0)));
+    EXPECT_EQ(live[1], std::make_pair(-42, size_t(1)));
+    EXPECT_EQ(live[2], std::make_pair(std::numeric_limits<int>::max(), size_t(2)));
+}
+
+TEST(BinaryIdsCodecTest, TombstonedSlotsAreSkipped) {
+    StdString contents;
+    BinaryIdsCodec<int>::AppendHeader(contents);
+    for (int id = 1; id <= 4; id++) {
+        BinaryIdsCodec<int>::AppendSlot(contents, id);
+    }
+    contents[BinaryIdsCodec<int>::SlotOffset(1)] = BINARY_IDS_TOMBSTONE;
+    contents[BinaryIdsCodec<int>::SlotOffset(3)] = BINARY_IDS_TOMBSTONE;
+
+    auto live = LiveSlots<int>(contents);
+    ASSERT_EQ(live.size(), 2u);
+    EXPECT_EQ(live[0], std::make_pair(1, size_t(0)));
+    EXPECT_EQ(live[1], std::make_pair(3, size_t(2)));
+
+    StdString slot = contents.substr(BinaryIdsCodec<int>::SlotOffset(2), BinaryIdsCodec<int>::SlotSize);
+    EXPECT_TRUE(BinaryIdsCodec<int>::IsLiveSlot(slot, 3));
+    EXPECT_FALSE(BinaryIdsCodec<int>::IsLiveSlot(slot, 4));
+    StdString dead = contents.substr(BinaryIdsCodec<int>::SlotOffset(1), BinaryIdsCodec<int>::SlotSize);
+    EXPECT_FALSE(BinaryIdsCodec<int>::IsLiveSlot(dead, 2));
+}
+
+TEST(BinaryIdsCodecTest, TornLastSlotIsIgnored) {
+    StdString contents;
+    BinaryIdsCodec<int>::AppendHeader(contents);
+    BinaryIdsCodec<int>::AppendSlot(contents, 1);
+    BinaryIdsCodec<int>::AppendSlot(contents, 2);
+    size_t complete = contents.length();
+
+    for (size_t torn = 1; torn < BinaryIdsCodec<int>::SlotSize; torn++) {
+        StdString withTail = contents;
+        withTail.append(StdString("\x01\x03\x00\x00", torn));
+        EXPECT_EQ(BinaryIdsCodec<int>::SlotCount(withTail.length()), 2u);
+        EXPECT_NE(BinaryIdsCodec<int>::SlotOffset(BinaryIdsCodec<int>::SlotCount(withTail.length())), withTail.length());
+        EXPECT_EQ(LiveSlots<int>(withTail).size(), 2u);
+    }
+    EXPECT_EQ(BinaryIdsCodec<int>::SlotOffset(BinaryIdsCodec<int>::SlotCount(complete)), complete);
+}
+
+TEST(BinaryIdsCodecTest, FilesOfAnotherWidthAreReadSignExtended) {
+    StdString contents;
+    BinaryIdsCodec<int16_t>::AppendHeader(contents);
+    BinaryIdsCodec<int16_t>::AppendSlot(contents, -5);
+    BinaryIdsCodec<int16_t>::AppendSlot(contents, 300);
+
+    EXPECT_TRUE(BinaryIdsCodec<int64_t>::IsBinary(contents));
+    EXPECT_FALSE(BinaryIdsCodec<int64_t>::HasOwnWidth(contents));
+    auto live = LiveSlots<int64_t>(contents);
+    ASSERT_EQ(live.size(), 2u);
+    EXPECT_EQ(live[0].first, -5);
+    EXPECT_EQ(live[1].first, 300);
+}
+
+TEST(BinaryIdsCodecTest, TextIdsFilesAreNotBinary) {
+    EXPECT_FALSE(BinaryIdsCodec<int>::IsBinary(StdString("1\n2\n")));
+    EXPECT_FALSE(BinaryIdsCodec<int>::IsBinary(StdString()));
+    EXPECT_TRUE(LiveSlots<int>(StdString("1\n2\n")).empty());
+}
+
+class IdsFileTest : public StorageTest {
+    Protected std::shared_ptr<DesktopFileManager> fileManager = std::make_shared<DesktopFileManager>();
+
+    Protected Void SaveUsers(TestRepository& repository, int first, int last) {
+        for (int key = first; key <= last; key++) {
+            TestUser user = TestUser::Make(key);
+            repository.Save(user);
+        }
+    }
+
+    // Append raw bytes to a file, as an append torn by a crash leaves them
+    Protected Static Void AppendRaw(CStdString& path, CStdString& bytes) {
+        std::ofstream file(path, std::ios::binary | std::ios::app);
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.length()));
+    }
+};
+
+TEST_F(IdsFileTest, IdsAreStoredInBinarySlots) {
+    TestRepository repository(fileManager);
+    SaveUsers(repository, 1, 3);
+
+    StdString contents = fileManager->Read(repository.GetIdsFilePath());
+    ASSERT_TRUE(BinaryIdsCodec<int>::HasOwnWidth(contents));
+    EXPECT_EQ(contents.length(), BinaryIdsCodec<int>::SlotOffset(3));
+}
+
+TEST_F(IdsFileTest, DeleteTombstonesItsSlotInPlace) {
+    {
+        TestRepository repository(fileManager);
+        SaveUsers(repository, 1, 3);
+        size_t size = fileManager->Size(repository.GetIdsFilePath());
+        repository.DeleteById(2);
+        EXPECT_EQ(fileManager->Size(repository.GetIdsFilePath()), size);
+
+        StdString slot = fileManager->ReadRange(repository.GetIdsFilePath(), BinaryIdsCodec<int>::SlotOffset(1),
+                                                BinaryIdsCodec<int>::SlotSize);
+        EXPECT_EQ(slot[0], BINARY_IDS_TOMBSTONE);
+    }
+
+    TestRepository reopened(fileManager);
+    EXPECT_EQ(SortedIds(reopened.FindAll()), (Vector<int>{1, 3}));
+    EXPECT_FALSE(reopened.ExistsById(2));
+}
+
+TEST_F(IdsFileTest, TombstonesAreCompactedOnceTheyOutnumberLiveIds) {
+    TestRepository repository(fileManager);
+    const int count = 2 * CPA_REPOSITORY_IDS_COMPACT_MIN;
+    SaveUsers(repository, 1, count);
+    for (int key = 1; key <= count - 2; key++) {
+        repository.DeleteById(key);
+    }
+
+    StdString contents = fileManager->Read(repository.GetIdsFilePath());
+    size_t slots = BinaryIdsCodec<int>::SlotCount(contents.length());
+    EXPECT_LT(slots, static_cast<size_t>(count));
+
+    TestRepository reopened(fileManager);
+    EXPECT_EQ(SortedIds(reopened.FindAll()), (Vector<int>{count - 1, count}));
+}
+
+TEST_F(IdsFileTest, TornSlotIsIgnoredAndRewrittenBeforeTheNextAppend) {
+    CStdString* idsPath = nullptr;
+    {
+        TestRepository repository(fileManager);
+        SaveUsers(repository, 1, 3);
+        idsPath = &repository.GetIdsFilePath();
+    }
+
+    // A crash in the middle of appending slot 4 leaves its first bytes
+    StdString slot;
+    BinaryIdsCodec<int>::AppendSlot(slot, 4);
+    AppendRaw(*idsPath, slot.substr(0, 2));
+
+    {
+        TestRepository repository(fileManager);
+        EXPECT_EQ(SortedIds(repository.FindAll()), (Vector<int>{1, 2, 3}));
+        EXPECT_FALSE(repository.ExistsById(4));
+
+        // The next append must not land behind the torn bytes
+        SaveUsers(repository, 5, 6);
+        EXPECT_EQ(fileManager->Size(*idsPath), BinaryIdsCodec<int>::SlotOffset(5));
+    }
+
+    TestRepository reopened(fileManager);
+    EXPECT_EQ(SortedIds(reopened.FindAll()), (Vector<int>{1, 2, 3, 5, 6}));
+    reopened.DeleteById(6);
+    TestRepository afterDelete(fileManager);
+    EXPECT_EQ(SortedIds(afterDelete.FindAll()), (Vector<int>{1, 2, 3, 5}));
+}
+
+TEST_F(IdsFileTest, TextIdsFilesAreConvertedOnTheFirstWrite) {
+    TestRepository repository(fileManager);
+    for (int key = 1; key <= 2; key++) {
+        TestUser user = TestUser::Make(key);
+        fileManager->Create(repository.GetFilePath(key), user.Serialize());
+    }
+    fileManager->Create(repository.GetIdsFilePath(), StdString("1\n2\n"));
+
+    EXPECT_EQ(SortedIds(repository.FindAll()), (Vector<int>{1, 2}));
+    SaveUsers(repository, 3, 3);
+    EXPECT_TRUE(BinaryIdsCodec<int>::HasOwnWidth(fileManager->Read(repository.GetIdsFilePath())));
+
+    TestRepository reopened(fileManager);
+    EXPECT_EQ(SortedIds(reopened.FindAll()), (Vector<int>{1, 2, 3}));
+}
+
+TEST_F(IdsFileTest, RecordsAreStoredBinaryAndJsonRecordsStayReadable) {
+    TestRepository repository(fileManager);
+    TestUser binary = TestUser::Make(1, "binary");
+    repository.Save(binary);
+    EXPECT_TRUE(BinaryReader::IsBinaryRecord(fileManager->Read(repository.GetFilePath(1))));
+
+    // A record written before the entity switched to /* @BinaryStorage */
+    TestUser json = TestUser::Make(2, "json");
+    fileManager->Create(repository.GetFilePath(2), json.Serialize());
+    StdString slot;
+    BinaryIdsCodec<int>::AppendSlot(slot, 2);
+    fileManager->Append(repository.GetIdsFilePath(), slot);
+
+    TestRepository reopened(fileManager);
+    EXPECT_EQ(reopened.FindById(1), binary);
+    EXPECT_EQ(reopened.FindById(2), json);
+    EXPECT_EQ(SortedIds(reopened.FindAll()), (Vector<int>{1, 2}));
+}
+
+TEST_F(StorageTest, PagesFollowTheIdsFileOrder) {
+    IFileManagerPtr fileManager = std::make_shared<DesktopFileManager>();
+    TestRepository repository(fileManager);
+    for (int key : {5, 3, 9, 1, 7, 2, 8}) {
+        TestUser user = TestUser::Make(key);
+        repository.Save(user);
+    }
+    repository.DeleteById(9);
+    TestUser four = TestUser::Make(4);
+    repository.Save(four);
+
+    // Pages of three, from the writing instance's ID index and from a fresh instance
+    auto pages = [](TestRepository& source) {
+        Vector<int> paged;
+        for (size_t offset = 0; offset < 9; offset += 3) {
+            for (const auto& user : source.FindAll(offset, 3)) {
+                paged.push_back(user.id.value());
+            }
+        }
+        return paged;
+    };
+    Vector<int> order{5, 3, 1, 7, 2, 8, 4};
+    EXPECT_EQ(pages(repository), order);
+    TestRepository reopened(fileManager);
+    EXPECT_EQ(pages(reopened), order);
+}
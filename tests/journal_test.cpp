@@ -0,0 +1,304 @@
+// Transaction journal: replay after a crash between the journal write and the apply, torn journals
+
+#include "TestSupport.h"
+
+// Thrown by CrashingFileManager where the process "dies"
+struct SimulatedCrash {};
+
+// File manager decorator that simulates a crash: the writesBeforeCrash-th mutating call from now
+// throws SimulatedCrash before it reaches storage, so the files hold exactly the earlier writes
+class CrashingFileManager final : public IFileManager {
+    Private DesktopFileManager inner;
+    Private int writesBeforeCrash = -1;
+
+    // Crash on the count-th mutating call from now (1 = the next one); -1 never crashes
+    Public Void CrashAfter(int count) {
+        writesBeforeCrash = count;
+    }
+
+    Public Bool Create(CStdString& filename, CStdString& contents) override {
+        MutatingCall();
+        return inner.Create(filename, contents);
+    }
+
+    Public StdString Read(CStdString& filename) override {
+        return inner.Read(filename);
+    }
+
+    Public Bool Read(CStdString& filename, StdString& contents) override {
+        return inner.Read(filename, contents);
+    }
+
+    Public Bool Read(const char* filename, StdString& contents) override {
+        return inner.Read(filename, contents);
+    }
+
+    Public Bool Update(CStdString& filename, CStdString& contents) override {
+        MutatingCall();
+        return inner.Update(filename, contents);
+    }
+
+    Public Bool Delete(CStdString& filename) override {
+        MutatingCall();
+        return inner.Delete(filename);
+    }
+
+    Public Bool Append(CStdString& filename, CStdString& contents) override {
+        MutatingCall();
+        return inner.Append(filename, contents);
+    }
+
+    Public StdString ReadRange(CStdString& filename, size_t offset, size_t length) override {
+        return inner.ReadRange(filename, offset, length);
+    }
+
+    Public Bool WriteRange(CStdString& filename, size_t offset, std::string_view contents) override {
+        MutatingCall();
+        return inner.WriteRange(filename, offset, contents);
+    }
+
+    Public Bool Exists(CStdString& filename) override {
+        return inner.Exists(filename);
+    }
+
+    Public size_t Size(CStdString& filename) override {
+        return inner.Size(filename);
+    }
+
+    Public Bool Write(const char* filename, std::string_view contents) override {
+        MutatingCall();
+        return inner.Write(filename, contents);
+    }
+
+    Public Bool Append(const char* filename, std::string_view contents) override {
+        MutatingCall();
+        return inner.Append(filename, contents);
+    }
+
+    Private Void MutatingCall() {
+        if (writesBeforeCrash > 0 && --writesBeforeCrash == 0) {
+            writesBeforeCrash = -1;
+            throw SimulatedCrash();
+        }
+    }
+};
+
+class JournalTest : public StorageTest {
+    Protected std::shared_ptr<CrashingFileManager> fileManager = std::make_shared<CrashingFileManager>();
+
+    // Committed state before the transaction: users 1..4
+    Protected Void SaveInitialUsers() {
+        TestRepository repository(fileManager);
+        for (int key = 1; key <= 4; key++) {
+            TestUser user = TestUser::Make(key);
+            repository.Save(user);
+        }
+    }
+
+    // Transaction run by every test: saves 5 and 6, renames 2, deletes 1 and 3
+    Protected Static Void RunTransaction(TestRepository& repository) {
+        repository.Begin();
+        TestUser five = TestUser::Make(5);
+        TestUser six = TestUser::Make(6);
+        TestUser renamed = TestUser::Make(2, "renamed");
+        repository.Save(five);
+        repository.Save(six);
+        repository.Update(renamed);
+        repository.DeleteById(1);
+        repository.DeleteById(3);
+    }
+
+    // Commit the transaction, crashing on the crashAt-th write; false if it didn't crash
+    Protected Bool CommitWithCrash(int crashAt) {
+        TestRepository repository(fileManager);
+        RunTransaction(repository);
+        fileManager->CrashAfter(crashAt);
+        try {
+            repository.Commit();
+        } catch (const SimulatedCrash&) {
+            fileManager->CrashAfter(-1);
+            return true;
+        }
+        fileManager->CrashAfter(-1);
+        return false;
+    }
+
+    Protected Static Void ExpectBeforeTransaction(TestRepository& repository) {
+        EXPECT_EQ(SortedIds(repository.FindAll()), (Vector<int>{1, 2, 3, 4}));
+        EXPECT_EQ(repository.FindById(2), TestUser::Make(2));
+    }
+
+    Protected Static Void ExpectAfterTransaction(TestRepository& repository) {
+        EXPECT_EQ(SortedIds(repository.FindAll()), (Vector<int>{2, 4, 5, 6}));
+        EXPECT_EQ(repository.FindById(2), TestUser::Make(2, "renamed"));
+        EXPECT_FALSE(repository.ExistsById(1));
+        EXPECT_FALSE(repository.ExistsById(3));
+    }
+};
+
+TEST_F(JournalTest, CommitAppliesEverythingAndDropsTheJournal) {
+    SaveInitialUsers();
+    ASSERT_FALSE(CommitWithCrash(-1));
+
+    TestRepository repository(fileManager);
+    ExpectAfterTransaction(repository);
+    EXPECT_FALSE(fileManager->Exists(repository.GetJournalFilePath()));
+}
+
+TEST_F(JournalTest, CrashAfterTheJournalWriteIsReplayed) {
+    SaveInitialUsers();
+    // Write 1 is the journal, write 2 the first record of the apply
+    ASSERT_TRUE(CommitWithCrash(2));
+
+    TestRepository repository(fileManager);
+    ASSERT_TRUE(fileManager->Exists(repository.GetJournalFilePath()));
+    ExpectAfterTransaction(repository);
+    EXPECT_FALSE(fileManager->Exists(repository.GetJournalFilePath()));
+}
+
+TEST_F(JournalTest, CrashBeforeTheJournalWriteKeepsTheOldState) {
+    SaveInitialUsers();
+    ASSERT_TRUE(CommitWithCrash(1));
+
+    TestRepository repository(fileManager);
+    EXPECT_FALSE(fileManager->Exists(repository.GetJournalFilePath()));
+    ExpectBeforeTransaction(repository);
+}
+
+TEST_F(JournalTest, CrashAtAnyWriteLeavesAllOrNothing) {
+    for (int crashAt = 1;; crashAt++) {
+        SetUp();
+        SaveInitialUsers();
+        Bool crashed = CommitWithCrash(crashAt);
+
+        TestRepository repository(fileManager);
+        if (crashAt == 1) {
+            ExpectBeforeTransaction(repository);
+        } else {
+            ExpectAfterTransaction(repository);
+        }
+        EXPECT_FALSE(fileManager->Exists(repository.GetJournalFilePath())) << "crash at write " << crashAt;
+        if (!crashed) {
+            break;
+        }
+    }
+}
+
+TEST_F(JournalTest, TornJournalIsDiscarded) {
+    SaveInitialUsers();
+    ASSERT_TRUE(CommitWithCrash(2));
+
+    // Cut the journal before its commit record, as a crash while writing it in place would
+    StdString journalPath;
+    {
+        TestRepository repository(fileManager);
+        journalPath = repository.GetJournalFilePath();
+    }
+    StdString journal = fileManager->Read(journalPath);
+    ASSERT_FALSE(journal.empty());
+    for (size_t cut : {journal.length() - 1, journal.length() / 2, size_t(1)}) {
+        fileManager->Create(journalPath, journal.substr(0, cut));
+
+        TestRepository repository(fileManager);
+        ExpectBeforeTransaction(repository);
+        EXPECT_FALSE(fileManager->Exists(journalPath)) << "cut at " << cut;
+    }
+}
+
+// Storage that refuses writes (the journal, or the apply) instead of crashing
+class RefusedCommitTest : public StorageTest {
+    Protected std::shared_ptr<RefusingFileManager> fileManager = std::make_shared<RefusingFileManager>();
+};
+
+TEST_F(RefusedCommitTest, UnwritableJournalKeepsTheTransactionOpen) {
+    TestRepository repository(fileManager);
+    TestUser one = TestUser::Make(1);
+    repository.Save(one);
+
+    repository.Begin();
+    TestUser renamed = TestUser::Make(1, "renamed");
+    TestUser two = TestUser::Make(2);
+    repository.Update(renamed);
+    repository.Save(two);
+    fileManager->Refuse(true, repository.GetJournalFilePath());
+    EXPECT_FALSE(repository.Commit());
+    fileManager->Refuse(false);
+
+    // Still buffered: visible to FindById, not yet in storage
+    EXPECT_EQ(repository.FindById(1), renamed);
+    EXPECT_EQ(repository.FindById(2), two);
+    EXPECT_EQ(SortedIds(repository.FindAll()), (Vector<int>{1}));
+
+    EXPECT_TRUE(repository.Commit());
+    TestRepository reopened(fileManager);
+    EXPECT_EQ(reopened.FindById(1), renamed);
+    EXPECT_EQ(SortedIds(reopened.FindAll()), (Vector<int>{1, 2}));
+}
+
+TEST_F(RefusedCommitTest, RollbackAfterUnwritableJournalDiscardsTheWrites) {
+    TestRepository repository(fileManager);
+    repository.Begin();
+    TestUser one = TestUser::Make(1);
+    repository.Save(one);
+    fileManager->Refuse(true, repository.GetJournalFilePath());
+    EXPECT_FALSE(repository.Commit());
+    fileManager->Refuse(false);
+
+    repository.Rollback();
+    EXPECT_FALSE(repository.ExistsById(1));
+    EXPECT_TRUE(repository.FindAll().empty());
+}
+
+TEST_F(RefusedCommitTest, RefusedApplyKeepsTheJournalForTheNextOperation) {
+    TestRepository repository(fileManager);
+    TestUser one = TestUser::Make(1);
+    repository.Save(one);
+
+    repository.Begin();
+    TestUser renamed = TestUser::Make(1, "renamed");
+    TestUser two = TestUser::Make(2);
+    repository.Update(renamed);
+    repository.Save(two);
+    fileManager->Refuse(true, repository.GetFilePath(2));
+    EXPECT_TRUE(repository.Commit());
+    EXPECT_TRUE(fileManager->Exists(repository.GetJournalFilePath()));
+
+    // Replays fail while storage refuses, and a new commit can't replace the journal
+    EXPECT_FALSE(repository.ExistsById(2));
+    EXPECT_TRUE(fileManager->Exists(repository.GetJournalFilePath()));
+    repository.Begin();
+    TestUser three = TestUser::Make(3);
+    repository.Save(three);
+    EXPECT_FALSE(repository.Commit());
+    repository.Rollback();
+    fileManager->Refuse(false);
+
+    // The next operation replays it
+    EXPECT_EQ(repository.FindById(2), two);
+    EXPECT_EQ(repository.FindById(1), renamed);
+    EXPECT_FALSE(fileManager->Exists(repository.GetJournalFilePath()));
+    EXPECT_EQ(SortedIds(repository.FindAll()), (Vector<int>{1, 2}));
+}
+
+TEST_F(RefusedCommitTest, RefusedReplayKeepsTheJournal) {
+    StdString journalPath;
+    {
+        TestRepository repository(fileManager);
+        journalPath = repository.GetJournalFilePath();
+        repository.Begin();
+        TestUser one = TestUser::Make(1);
+        repository.Save(one);
+        fileManager->Refuse(true, repository.GetFilePath(1));
+        EXPECT_TRUE(repository.Commit());
+    }
+    {
+        TestRepository repository(fileManager);
+        EXPECT_TRUE(repository.FindAll().empty());
+        EXPECT_TRUE(fileManager->Exists(journalPath));
+    }
+    fileManager->Refuse(false);
+
+    TestRepository repository(fileManager);
+    EXPECT_EQ(SortedIds(repository.FindAll()), (Vector<int>{1}));
+    EXPECT_FALSE(fileManager->Exists(journalPath));
+}
@@ -0,0 +1,60 @@
+// Log records: the format of log segments, secondary index logs and transaction journals
+
+#include "repository/LogRecord.h"
+#include <gtest/gtest.h>
+
+TEST(LogRecordCodecTest, RecordsRoundTrip) {
+    StdString segment;
+    size_t payloadOffset = LogRecordCodec::AppendPut(segment, StdString("17"), StdString("line\nbreak"));
+    LogRecordCodec::AppendDelete(segment, StdString("18"));
+    LogRecordCodec::AppendDelete(segment, StdString("key"), StdString("19"));
+    LogRecordCodec::AppendCommit(segment);
+
+    size_t position = 0;
+    LogRecord record;
+    ASSERT_TRUE(LogRecordCodec::ParseNext(segment, position, record));
+    EXPECT_EQ(record.type, LOG_RECORD_PUT);
+    EXPECT_EQ(segment.substr(record.idOffset, record.idLength), "17");
+    EXPECT_EQ(segment.substr(record.payloadOffset, record.payloadLength), "line\nbreak");
+    EXPECT_EQ(record.payloadOffset, payloadOffset);
+    position += record.length;
+
+    ASSERT_TRUE(LogRecordCodec::ParseNext(segment, position, record));
+    EXPECT_EQ(record.type, LOG_RECORD_DELETE);
+    EXPECT_EQ(segment.substr(record.idOffset, record.idLength), "18");
+    EXPECT_EQ(record.payloadLength, 0u);
+    position += record.length;
+
+    ASSERT_TRUE(LogRecordCodec::ParseNext(segment, position, record));
+    EXPECT_EQ(record.type, LOG_RECORD_DELETE);
+    EXPECT_EQ(segment.substr(record.payloadOffset, record.payloadLength), "19");
+    position += record.length;
+
+    ASSERT_TRUE(LogRecordCodec::ParseNext(segment, position, record));
+    EXPECT_EQ(record.type, LOG_RECORD_COMMIT);
+    position += record.length;
+
+    EXPECT_EQ(position, segment.length());
+    EXPECT_FALSE(LogRecordCodec::ParseNext(segment, position, record));
+}
+
+TEST(LogRecordCodecTest, TornTailStopsParsing) {
+    StdString segment;
+    LogRecordCodec::AppendPut(segment, StdString("1"), StdString("first"));
+    size_t complete = segment.length();
+    LogRecordCodec::AppendPut(segment, StdString("2"), StdString("second"));
+
+    for (size_t length = complete + 1; length < segment.length(); length++) {
+        StdString torn = segment.substr(0, length);
+        LogRecord record;
+        ASSERT_TRUE(LogRecordCodec::ParseNext(torn, 0, record));
+        EXPECT_FALSE(LogRecordCodec::ParseNext(torn, record.length, record)) << "length " << length;
+    }
+}
+
+TEST(LogRecordCodecTest, GarbageIsNotARecord) {
+    LogRecord record;
+    EXPECT_FALSE(LogRecordCodec::ParseNext(StdString("X1:1\nab\n"), 0, record));
+    EXPECT_FALSE(LogRecordCodec::ParseNext(StdString("P1:1\nabX"), 0, record));
+    EXPECT_FALSE(LogRecordCodec::ParseNext(StdString("P1:99\nab\n"), 0, record));
+}
@@ -0,0 +1,70 @@
+// Several repository instances of one table: each drops its ID index, entity cache and engine caches
+// once another instance has written, so none of them acts on stale state
+
+#include "TestSupport.h"
+#include "repository/LogCpaRepositoryImpl.h"
+
+// Log-structured engine of TestUser
+class LogTestRepository : public LogCpaRepositoryImpl<TestUser, int> {
+    Public explicit LogTestRepository(IFileManagerPtr manager) {
+        fileManager = manager;
+    }
+};
+
+class MultiInstanceTest : public StorageTest {
+    Protected IFileManagerPtr fileManager = std::make_shared<DesktopFileManager>();
+
+    // Writes through second are seen by first, whose ID index and cache were loaded before them
+    template<typename Repository>
+    Static Void ExpectWritesSeen(Repository& first, Repository& second) {
+        first.SetCacheCapacity(8);
+        for (int key = 1; key <= 3; key++) {
+            TestUser user = TestUser::Make(key);
+            first.Save(user);
+        }
+        EXPECT_EQ(first.FindById(2), TestUser::Make(2));
+
+        second.DeleteById(1);
+        TestUser renamed = TestUser::Make(2, "renamed");
+        second.Update(renamed);
+        TestUser four = TestUser::Make(4);
+        second.Save(four);
+
+        EXPECT_FALSE(first.ExistsById(1));
+        EXPECT_EQ(first.FindById(2), renamed);
+        EXPECT_EQ(SortedIds(first.FindAll()), (Vector<int>{2, 3, 4}));
+
+        // Saving the deleted ID again lists it (a stale ID index would still hold it and skip the append)
+        TestUser one = TestUser::Make(1);
+        first.Save(one);
+        EXPECT_EQ(SortedIds(second.FindAll()), (Vector<int>{1, 2, 3, 4}));
+        EXPECT_EQ(second.FindById(1), one);
+    }
+};
+
+TEST_F(MultiInstanceTest, DefaultEngineSeesOtherInstancesWrites) {
+    TestRepository first(fileManager);
+    TestRepository second(fileManager);
+    ExpectWritesSeen(first, second);
+}
+
+TEST_F(MultiInstanceTest, LogEngineSeesOtherInstancesWrites) {
+    LogTestRepository first(fileManager);
+    LogTestRepository second(fileManager);
+    ExpectWritesSeen(first, second);
+}
+
+TEST_F(MultiInstanceTest, PagesSeeOtherInstancesWrites) {
+    TestRepository first(fileManager);
+    TestRepository second(fileManager);
+    for (int key = 1; key <= 4; key++) {
+        TestUser user = TestUser::Make(key);
+        first.Save(user);
+    }
+    EXPECT_EQ(SortedIds(first.FindAll(0, 10)), (Vector<int>{1, 2, 3, 4}));
+
+    second.DeleteById(2);
+    TestUser five = TestUser::Make(5);
+    second.Save(five);
+    EXPECT_EQ(SortedIds(first.FindAll(0, 10)), (Vector<int>{1, 3, 4, 5}));
+}
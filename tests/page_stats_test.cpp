@@ -0,0 +1,54 @@
+// Bytes a page of FindAll(offset, limit) reads, counted by GetStats() (built with CPA_REPOSITORY_STATS,
+// once with the default ID index and once without one)
+
+#include "TestSupport.h"
+
+class PageStatsTest : public StorageTest {
+    Protected IFileManagerPtr fileManager = std::make_shared<DesktopFileManager>();
+
+    // Users 1..count, with every tenth one deleted so the binary IDs file holds tombstones
+    Protected Static Void SaveUsers(TestRepository& repository, int count) {
+        Vector<TestUser> users;
+        for (int key = 1; key <= count; key++) {
+            users.push_back(TestUser::Make(key));
+        }
+        repository.SaveAll(users);
+        for (int key = 10; key <= count; key += 10) {
+            repository.DeleteById(key);
+        }
+    }
+
+    // Bytes of the record files of a page
+    Protected uint64_t RecordBytes(TestRepository& repository, const Vector<TestUser>& page) {
+        uint64_t bytes = 0;
+        for (const auto& user : page) {
+            bytes += fileManager->Size(repository.GetFilePath(user.id.value()));
+        }
+        return bytes;
+    }
+};
+
+TEST_F(PageStatsTest, PageReadsOnlyItsRecordsAndIds) {
+    const int count = 1000;
+    TestRepository repository(fileManager);
+    repository.SetCacheCapacity(0);
+    SaveUsers(repository, count);
+    repository.FindAll(0, 10);
+
+    for (size_t offset : {size_t(0), size_t(450), size_t(880)}) {
+        repository.ResetStats();
+        Vector<TestUser> page = repository.FindAll(offset, 10);
+        ASSERT_EQ(page.size(), 10u);
+        uint64_t bytesRead = repository.GetStats().Of(RepositoryOperation::FindPage).storage.bytesRead;
+        uint64_t idBytes = bytesRead - RecordBytes(repository, page);
+        #if CPA_REPOSITORY_ID_INDEX != CPA_ID_INDEX_NONE
+            // Served from the ID index
+            EXPECT_EQ(idBytes, 0u) << "offset " << offset;
+        #else
+            // The header and the slots up to the end of the page (a tenth of them tombstones)
+            size_t slots = (offset + 10) * 10 / 9 + 1;
+            EXPECT_LE(idBytes, BinaryIdsCodec<int>::SlotOffset(slots)) << "offset " << offset;
+            EXPECT_LT(idBytes, fileManager->Size(repository.GetIdsFilePath())) << "offset " << offset;
+        #endif
+    }
+}
@@ -0,0 +1,67 @@
+// Preload set: saved by Flush() (rate-limited) and on destruction, and read back by Preload()
+
+#include "TestSupport.h"
+
+class PreloadTest : public StorageTest {
+    Protected IFileManagerPtr fileManager = std::make_shared<DesktopFileManager>();
+
+    // Users 1..4 stored, then 2 and 3 read into a cache of eight
+    Protected Static Void SaveAndRead(TestRepository& repository) {
+        for (int key = 1; key <= 4; key++) {
+            TestUser user = TestUser::Make(key);
+            repository.Save(user);
+        }
+        repository.SetCacheCapacity(0);
+        repository.SetCacheCapacity(8);
+        repository.FindById(2);
+        repository.FindById(3);
+    }
+};
+
+TEST_F(PreloadTest, FlushSavesThePreloadSet) {
+    TestRepository repository(fileManager);
+    SaveAndRead(repository);
+    EXPECT_TRUE(repository.Flush());
+    EXPECT_EQ(fileManager->Read(repository.GetPreloadFilePath()), "3\n2\n");
+
+    TestRepository rebooted(fileManager);
+    rebooted.SetCacheCapacity(8);
+    rebooted.Preload(8);
+    EXPECT_EQ(rebooted.GetCacheStats().size, 2u);
+}
+
+TEST_F(PreloadTest, FlushSavesAtMostOncePerInterval) {
+    TestRepository repository(fileManager);
+    SaveAndRead(repository);
+    repository.Flush();
+    repository.FindById(4);
+    repository.Flush();
+    EXPECT_EQ(fileManager->Read(repository.GetPreloadFilePath()), "3\n2\n");
+}
+
+TEST_F(PreloadTest, DestructorSavesThePreloadSet) {
+    StdString preloadPath;
+    {
+        TestRepository repository(fileManager);
+        preloadPath = repository.GetPreloadFilePath();
+        SaveAndRead(repository);
+        repository.Flush();
+        repository.FindById(4);
+    }
+    EXPECT_EQ(fileManager->Read(preloadPath), "4\n3\n2\n");
+}
+
+TEST_F(PreloadTest, EmptyCacheKeepsTheSavedSet) {
+    StdString preloadPath;
+    {
+        TestRepository repository(fileManager);
+        preloadPath = repository.GetPreloadFilePath();
+        SaveAndRead(repository);
+    }
+    {
+        TestRepository rebooted(fileManager);
+        rebooted.SetCacheCapacity(8);
+        rebooted.Flush();
+    }
+    EXPECT_EQ(fileManager->Read(preloadPath), "3\n2\n");
+}
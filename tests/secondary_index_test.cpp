@@ -0,0 +1,113 @@
+// Persisted secondary index log: replay, torn tails and compaction
+
+#include "TestSupport.h"
+#include "repository/SecondaryIndex.h"
+#include <fstream>
+#include <set>
+
+class SecondaryIndexTest : public StorageTest {
+    Protected std::shared_ptr<DesktopFileManager> fileManager = std::make_shared<DesktopFileManager>();
+    Protected StdString indexPath = StdString(DATABASE_PATH) + "index";
+
+    // Index replayed from its file
+    Protected SecondaryIndex Reload() {
+        SecondaryIndex index(indexPath);
+        EXPECT_TRUE(index.Load(fileManager));
+        return index;
+    }
+};
+
+TEST_F(SecondaryIndexTest, MissingFileIsNotLoaded) {
+    SecondaryIndex index(indexPath);
+    EXPECT_FALSE(index.Load(fileManager));
+    EXPECT_FALSE(index.IsLoaded());
+}
+
+TEST_F(SecondaryIndexTest, AddsAndRemovesAreReplayed) {
+    {
+        SecondaryIndex index(indexPath);
+        index.Reset();
+        ASSERT_TRUE(index.Persist(fileManager));
+        index.Add(fileManager, "active", "1");
+        index.Add(fileManager, "active", "2");
+        index.Add(fileManager, "inactive", "3");
+        index.Remove(fileManager, "active", "1");
+        index.Add(fileManager, "active", "2");
+    }
+
+    SecondaryIndex index = Reload();
+    EXPECT_EQ(index.Find("active"), (std::set<StdString>{"2"}));
+    EXPECT_EQ(index.Find("inactive"), (std::set<StdString>{"3"}));
+    EXPECT_TRUE(index.Find("missing").empty());
+}
+
+TEST_F(SecondaryIndexTest, EmptyBuiltIndexIsLoaded) {
+    {
+        SecondaryIndex index(indexPath);
+        index.Reset();
+        ASSERT_TRUE(index.Persist(fileManager));
+    }
+    SecondaryIndex index = Reload();
+    EXPECT_TRUE(index.IsLoaded());
+    EXPECT_TRUE(index.Find("active").empty());
+}
+
+TEST_F(SecondaryIndexTest, TornTailIsDroppedSoLaterRecordsStayReadable) {
+    {
+        SecondaryIndex index(indexPath);
+        index.Reset();
+        index.Insert("active", "1");
+        ASSERT_TRUE(index.Persist(fileManager));
+        index.Add(fileManager, "active", "2");
+    }
+
+    // A crash in the middle of appending a record leaves its first bytes
+    StdString record;
+    LogRecordCodec::AppendPut(record, StdString("active"), StdString("3"));
+    {
+        std::ofstream file(indexPath, std::ios::binary | std::ios::app);
+        file.write(record.data(), static_cast<std::streamsize>(record.length() - 2));
+    }
+
+    {
+        SecondaryIndex index = Reload();
+        EXPECT_EQ(index.Find("active"), (std::set<StdString>{"1", "2"}));
+        index.Add(fileManager, "active", "4");
+    }
+
+    SecondaryIndex index = Reload();
+    EXPECT_EQ(index.Find("active"), (std::set<StdString>{"1", "2", "4"}));
+}
+
+TEST_F(SecondaryIndexTest, LogIsCompactedOnceItOutgrowsTheLiveEntries) {
+    SecondaryIndex index(indexPath);
+    index.Reset();
+    ASSERT_TRUE(index.Persist(fileManager));
+    index.Add(fileManager, "key", "live");
+    for (int i = 0; i < SECONDARY_INDEX_COMPACTION_MIN_RECORDS; i++) {
+        index.Add(fileManager, "key", "churn");
+        index.Remove(fileManager, "key", "churn");
+    }
+
+    // Every record left is the leading marker or a live entry
+    StdString contents = fileManager->Read(indexPath);
+    size_t records = 0;
+    size_t position = 0;
+    LogRecord record;
+    while (LogRecordCodec::ParseNext(contents, position, record)) {
+        records++;
+        position += record.length;
+    }
+    EXPECT_LT(records, static_cast<size_t>(SECONDARY_INDEX_COMPACTION_MIN_RECORDS));
+    EXPECT_EQ(Reload().Find("key"), (std::set<StdString>{"live"}));
+}
+
+TEST_F(SecondaryIndexTest, BulkInsertKeepsOneEntryPerId) {
+    SecondaryIndex index(indexPath);
+    index.Reset();
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_TRUE(index.Insert("false", std::to_string(i)));
+    }
+    EXPECT_FALSE(index.Insert("false", "10"));
+    EXPECT_EQ(index.Find("false").size(), 1000u);
+}
@@ -0,0 +1,74 @@
+// Transactions under CPA_REPOSITORY_THREAD_SAFE: the table's writer lock is held from Begin to
+// Commit/Rollback, so other threads' writes and reads wait instead of joining the transaction
+
+#include "TestSupport.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+class TransactionThreadTest : public StorageTest {
+    Protected IFileManagerPtr fileManager = std::make_shared<DesktopFileManager>();
+
+    // Long enough for a thread that isn't blocked to finish its operation
+    Protected Static Void Settle() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+};
+
+TEST_F(TransactionThreadTest, OtherThreadsWritesWaitAndSurviveRollback) {
+    TestRepository repository(fileManager);
+    repository.Begin();
+    TestUser one = TestUser::Make(1);
+    repository.Save(one);
+
+    std::atomic<Bool> saved{false};
+    std::thread writer([&repository, &saved]() {
+        TestUser two = TestUser::Make(2);
+        repository.Save(two);
+        saved.store(true);
+    });
+    Settle();
+    EXPECT_FALSE(saved.load());
+
+    repository.Rollback();
+    writer.join();
+    EXPECT_FALSE(repository.ExistsById(1));
+    EXPECT_TRUE(repository.ExistsById(2));
+    EXPECT_EQ(SortedIds(repository.FindAll()), (Vector<int>{2}));
+}
+
+TEST_F(TransactionThreadTest, OtherThreadsReadCommittedState) {
+    TestRepository repository(fileManager);
+    TestUser one = TestUser::Make(1);
+    repository.Save(one);
+    repository.Begin();
+    TestUser renamed = TestUser::Make(1, "renamed");
+    repository.Update(renamed);
+
+    optional<TestUser> seen;
+    std::thread reader([&repository, &seen]() {
+        seen = repository.FindById(1);
+    });
+    Settle();
+    repository.Rollback();
+    reader.join();
+    EXPECT_EQ(seen, one);
+}
+
+TEST_F(TransactionThreadTest, OtherThreadsTransactionsRunAfterward) {
+    TestRepository repository(fileManager);
+    repository.Begin();
+    TestUser one = TestUser::Make(1);
+    repository.Save(one);
+
+    std::thread other([&repository]() {
+        repository.Begin();
+        TestUser two = TestUser::Make(2);
+        repository.Save(two);
+        repository.Rollback();
+    });
+    Settle();
+    EXPECT_TRUE(repository.Commit());
+    other.join();
+    EXPECT_EQ(SortedIds(repository.FindAll()), (Vector<int>{1}));
+}
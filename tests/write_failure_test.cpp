@@ -0,0 +1,88 @@
+// Writes storage refuses: nothing is indexed or listed for them, they are counted, and queued
+// writes stay queued until a flush succeeds
+
+#include "TestSupport.h"
+
+class WriteFailureTest : public StorageTest {
+    Protected std::shared_ptr<RefusingFileManager> fileManager = std::make_shared<RefusingFileManager>();
+};
+
+TEST_F(WriteFailureTest, RefusedSaveIsNotListed) {
+    TestRepository repository(fileManager);
+    TestUser one = TestUser::Make(1);
+    repository.Save(one);
+
+    fileManager->Refuse(true);
+    TestUser two = TestUser::Make(2);
+    repository.Save(two);
+    fileManager->Refuse(false);
+
+    EXPECT_EQ(repository.GetWriteFailures(), 1u);
+    EXPECT_EQ(SortedIds(repository.FindAll()), (Vector<int>{1}));
+    EXPECT_FALSE(repository.ExistsById(2));
+}
+
+TEST_F(WriteFailureTest, RefusedIdsAppendLeavesTheIdUnindexed) {
+    TestRepository repository(fileManager);
+    fileManager->Refuse(true, repository.GetIdsFilePath());
+    TestUser one = TestUser::Make(1);
+    repository.Save(one);
+    fileManager->Refuse(false);
+
+    EXPECT_EQ(repository.GetWriteFailures(), 1u);
+    EXPECT_TRUE(repository.FindAll().empty());
+
+    // Storing it again lists it
+    repository.Save(one);
+    EXPECT_EQ(SortedIds(repository.FindAll()), (Vector<int>{1}));
+    TestRepository reopened(fileManager);
+    EXPECT_EQ(SortedIds(reopened.FindAll()), (Vector<int>{1}));
+}
+
+TEST_F(WriteFailureTest, RefusedDeleteKeepsTheEntity) {
+    TestRepository repository(fileManager);
+    TestUser one = TestUser::Make(1);
+    repository.Save(one);
+
+    fileManager->Refuse(true);
+    repository.DeleteById(1);
+    fileManager->Refuse(false);
+
+    EXPECT_EQ(repository.GetWriteFailures(), 1u);
+    EXPECT_EQ(repository.FindById(1), one);
+    EXPECT_EQ(SortedIds(repository.FindAll()), (Vector<int>{1}));
+}
+
+TEST_F(WriteFailureTest, RefusedSaveAllSkipsOnlyTheRefusedEntities) {
+    TestRepository repository(fileManager);
+    TestRepository probe(fileManager);
+    fileManager->Refuse(true, probe.GetFilePath(2));
+    Vector<TestUser> users{TestUser::Make(1), TestUser::Make(2), TestUser::Make(3)};
+    repository.SaveAll(users);
+    fileManager->Refuse(false);
+
+    EXPECT_EQ(repository.GetWriteFailures(), 1u);
+    EXPECT_EQ(SortedIds(repository.FindAll()), (Vector<int>{1, 3}));
+}
+
+TEST_F(WriteFailureTest, RefusedQueuedWritesStayQueued) {
+    TestRepository repository(fileManager);
+    TestUser one = TestUser::Make(1);
+    repository.Save(one);
+    repository.SetWriteBehind(16);
+
+    fileManager->Refuse(true);
+    TestUser renamed = TestUser::Make(1, "renamed");
+    TestUser two = TestUser::Make(2);
+    repository.Update(renamed);
+    repository.Save(two);
+    EXPECT_FALSE(repository.Flush());
+    EXPECT_EQ(repository.FindById(1), renamed);
+    EXPECT_EQ(repository.FindById(2), two);
+    fileManager->Refuse(false);
+
+    EXPECT_TRUE(repository.Flush());
+    TestRepository reopened(fileManager);
+    EXPECT_EQ(reopened.FindById(1), renamed);
+    EXPECT_EQ(SortedIds(reopened.FindAll()), (Vector<int>{1, 2}));
+}